@@ -5,7 +5,24 @@
 #include "nvs_flash.h"
 #include "esp_netif.h"
 #include "driver/gpio.h"
-#include "driver/ledc.h"
+#include "agenda.h"
+#include "barrido.h"
+#include "captura.h"
+#include "dds.h"
+#include "generador_gpio.h"
+#include "generador_rmt.h"
+#include "grupo_pwm.h"
+#include "motor_pasos.h"
+#include "onda_dac.h"
+#include "placa.h"
+#include "planificador.h"
+#include "puente.h"
+#include "pwm.h"
+#include "reproductor.h"
+#include "secuenciador.h"
+#include "servo.h"
+#include "sigma_delta.h"
+#include "zumbador.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <string.h>
@@ -15,6 +32,14 @@
 #define TAG "APP"
 #define WIFI_SSID "Edward_555"
 #define WIFI_PASS "12345678"
+#define SECUENCIA_MAX_JSON 4096
+#define ZUMBADOR_MAX_RTTTL 2048
+// La tarea de fundido reprograma el LEDC cada medio periodo del tono
+#define TONO_MIN_HZ 0.1
+#define TONO_MAX_HZ 2000
+#define CAMPOS_AGENDA \
+"<label>Arranque (µs del reloj, vacío = ya):<input type=\"number\" name=\"arranque_us\"></label><br>" \
+"<label>Paro (µs del reloj, vacío = nunca):<input type=\"number\" name=\"paro_us\"></label><br>"
 
 const char html_index[] =
 "<!DOCTYPE html><html lang=\"es\"><head><meta charset=\"UTF-8\">"
@@ -24,103 +49,1235 @@ const char html_index[] =
 ".form-container{display:none;margin-top:20px;padding:20px;background:#fff;"
 "border-radius:10px;box-shadow:0 0 10px rgba(0,0,0,0.1)}input,select{margin:5px}"
 "</style></head><body><h1>Simulación de Señal GPIO</h1>"
+"<p>Reloj del ESP32: <span id=\"reloj\">-</span> µs, <span id=\"pendientes\">0</span> órdenes programadas "
+"<button onclick=\"leerReloj()\">Leer reloj</button>"
+"<button onclick=\"fetch('/agenda',{method:'POST',body:'accion=cancelar'}).then(leerReloj)\">Cancelar programadas</button></p>"
 "<button onclick=\"toggleForm('astable')\">Modo Astable</button>"
 "<button onclick=\"toggleForm('pwm')\">Modo PWM</button>"
+"<button onclick=\"toggleForm('captura')\">Analizador Lógico</button>"
+"<button onclick=\"toggleForm('onda')\">Modo Onda DAC</button>"
+"<button onclick=\"toggleForm('barrido')\">Modo Barrido</button>"
+"<button onclick=\"toggleForm('duty')\">Duty y Fundidos</button>"
+"<button onclick=\"toggleForm('puente')\">Puente H (MCPWM)</button>"
+"<button onclick=\"toggleForm('grupo')\">Grupo PWM</button>"
+"<button onclick=\"toggleForm('sigma')\">Sigma-Delta</button>"
+"<button onclick=\"toggleForm('secuencia')\">Secuenciador</button>"
+"<button onclick=\"toggleForm('reproducir')\">Reproducir archivo</button>"
+"<button onclick=\"toggleForm('servo')\">Servos</button>"
+"<button onclick=\"toggleForm('pasos')\">Motor paso a paso</button>"
+"<button onclick=\"toggleForm('zumbador')\">Zumbador</button>"
 "<div id=\"astable-form\" class=\"form-container\"><h2>Modo Astable</h2>"
 "<form id=\"astableForm\"><label>R1 (ohm):<input type=\"number\" name=\"r1\" required></label><br>"
 "<label>R2 (ohm):<input type=\"number\" name=\"r2\" required></label><br>"
-"<label>C1 (faradios):<input type=\"number\" name=\"c1\" required></label><br>"
+"<label>C1 (faradios):<input type=\"number\" name=\"c1\" step=\"any\" required></label><br>"
+"<label>Error máximo (ppm):<input type=\"number\" name=\"error_ppm\" value=\"1000\"></label><br>"
+"<label>Jitter máximo (ns):<input type=\"number\" name=\"jitter_ns\" value=\"1000000\"></label><br>"
+CAMPOS_AGENDA
 "<label>GPIO de salida:<select name=\"gpio\">"
 "<option value=\"0\">GPIO0</option><option value=\"2\">GPIO2</option>"
 "</select></label><br><button type=\"submit\">Enviar al ESP32</button></form>"
 "<p id=\"astable-result\"></p></div>"
 "<div id=\"pwm-form\" class=\"form-container\"><h2>Modo PWM</h2>"
-"<form id=\"pwmForm\"><label>Frecuencia deseada (Hz):<input type=\"number\" name=\"freq\" required></label><br>"
+"<form id=\"pwmForm\"><label>Frecuencia deseada (Hz):<input type=\"number\" name=\"freq\" step=\"0.001\" required></label><br>"
+"<label>Error máximo (ppm):<input type=\"number\" name=\"error_ppm\" value=\"1000\"></label><br>"
+"<label>Jitter máximo (ns):<input type=\"number\" name=\"jitter_ns\" value=\"1000000\"></label><br>"
+CAMPOS_AGENDA
 "<label>GPIO de salida:<select name=\"gpio\">"
 "<option value=\"0\">GPIO0</option><option value=\"2\">GPIO2</option>"
 "</select></label><br><button type=\"submit\">Enviar al ESP32</button></form>"
 "<p id=\"pwm-result\"></p></div>"
+"<div id=\"captura-form\" class=\"form-container\"><h2>Analizador Lógico</h2>"
+"<form id=\"capturaForm\"><label>Pines (ej. 0,2,4):<input name=\"pines\" value=\"0,2\" required></label><br>"
+"<label>Frecuencia de muestreo (Hz):<input type=\"number\" name=\"freq\" value=\"10000\" required></label><br>"
+"<label>Duración (ms):<input type=\"number\" name=\"duracion\" value=\"1000\" required></label><br>"
+"<label>Disparo:<select name=\"disparo\">"
+"<option value=\"inmediato\">Inmediato</option><option value=\"subida\">Flanco de subida</option>"
+"<option value=\"bajada\">Flanco de bajada</option><option value=\"patron\">Patrón</option>"
+"</select></label><br>"
+"<label>Canal de disparo:<input type=\"number\" name=\"canal\" value=\"0\"></label><br>"
+"<label>Patrón (1/0/x por pin):<input name=\"patron\"></label><br>"
+"<label>Pre-disparo (%):<input type=\"number\" name=\"pre\" value=\"10\" min=\"0\" max=\"90\"></label><br>"
+"<button type=\"submit\">Iniciar captura</button></form>"
+"<button onclick=\"leerCaptura()\">Descargar captura</button>"
+"<button onclick=\"fetch('/captura',{method:'POST',body:'accion=detener'})\">Detener</button>"
+"<p id=\"captura-result\"></p><canvas id=\"captura-canvas\" width=\"800\" height=\"200\"></canvas></div>"
+"<div id=\"onda-form\" class=\"form-container\"><h2>Modo Onda DAC</h2>"
+"<form id=\"ondaForm\"><label>Forma:<select name=\"forma\">"
+"<option value=\"seno\">Senoidal</option><option value=\"triangular\">Triangular</option>"
+"<option value=\"sierra\">Diente de sierra</option></select></label><br>"
+"<label>Frecuencia (Hz):<input type=\"number\" name=\"freq\" step=\"0.001\" required></label><br>"
+"<label>Amplitud (0-127):<input type=\"number\" name=\"amplitud\" value=\"100\" min=\"0\" max=\"127\"></label><br>"
+"<label>Offset (0-255):<input type=\"number\" name=\"offset\" value=\"128\" min=\"0\" max=\"255\"></label><br>"
+CAMPOS_AGENDA
+"<label>DAC de salida:<select name=\"canal\">"
+"<option value=\"0\">GPIO25</option><option value=\"1\">GPIO26</option>"
+"</select></label><br><button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"onda-result\"></p></div>"
+"<div id=\"barrido-form\" class=\"form-container\"><h2>Modo Barrido</h2>"
+"<form id=\"barridoForm\"><label>Frecuencia inicial (Hz):<input type=\"number\" name=\"inicio\" step=\"0.001\" required></label><br>"
+"<label>Frecuencia final (Hz):<input type=\"number\" name=\"fin\" step=\"0.001\" required></label><br>"
+"<label>Duración (ms):<input type=\"number\" name=\"duracion\" value=\"1000\" required></label><br>"
+"<label>Perfil:<select name=\"perfil\"><option value=\"lineal\">Lineal</option>"
+"<option value=\"log\">Logarítmico</option></select></label><br>"
+"<label>GPIO de salida:<select name=\"gpio\">"
+"<option value=\"0\">GPIO0</option><option value=\"2\">GPIO2</option>"
+"</select></label><br>"
+"<label>Marcador de sincronía:<select name=\"sync\"><option value=\"-1\">Ninguno</option>"
+"<option value=\"4\">GPIO4</option><option value=\"5\">GPIO5</option></select></label><br>"
+"<label>Repetir:<input type=\"checkbox\" name=\"repetir\"></label><br>"
+CAMPOS_AGENDA
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"barrido-result\"></p></div>"
+"<div id=\"duty-form\" class=\"form-container\"><h2>Duty y Fundidos (sobre la salida PWM)</h2>"
+"<form id=\"dutyForm\"><label>Modo:<select name=\"modo\">"
+"<option value=\"fijar\">Fijar duty</option><option value=\"rampa\">Rampa</option>"
+"<option value=\"respiracion\">Respiración</option><option value=\"tono\">Tono</option>"
+"</select></label><br>"
+"<label>Duty / máximo (%):<input type=\"number\" name=\"duty\" step=\"any\" value=\"50\"></label><br>"
+"<label>Duty mínimo (%):<input type=\"number\" name=\"duty2\" step=\"any\" value=\"0\"></label><br>"
+"<label>Tiempo / periodo (ms):<input type=\"number\" name=\"tiempo\" value=\"1000\"></label><br>"
+"<label>Frecuencia del tono (Hz):<input type=\"number\" name=\"freq\" step=\"any\" min=\"0.1\" max=\"2000\" value=\"440\"></label><br>"
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"duty-result\"></p></div>"
+"<div id=\"puente-form\" class=\"form-container\"><h2>Puente H (MCPWM)</h2>"
+"<form id=\"puenteForm\"><label>Acción:<select name=\"accion\">"
+"<option value=\"iniciar\">Iniciar</option><option value=\"duty\">Solo duty</option>"
+"<option value=\"rearmar\">Rearmar tras falla</option><option value=\"detener\">Detener</option>"
+"</select></label><br>"
+"<label>Frecuencia (Hz):<input type=\"number\" name=\"freq\" step=\"0.001\" value=\"20000\"></label><br>"
+"<label>Duty rama A (%):<input type=\"number\" name=\"duty_a\" step=\"0.1\" value=\"50\"></label><br>"
+"<label>Duty rama B (%):<input type=\"number\" name=\"duty_b\" step=\"0.1\" value=\"50\"></label><br>"
+"<label>Tiempo muerto (ns):<input type=\"number\" name=\"muerto\" value=\"500\"></label><br>"
+"<label>Desfase B (grados):<input type=\"number\" name=\"desfase\" value=\"0\"></label><br>"
+CAMPOS_AGENDA
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"puente-result\"></p></div>"
+"<div id=\"grupo-form\" class=\"form-container\"><h2>Grupo PWM sincronizado</h2>"
+"<form id=\"grupoForm\"><label>Acción:<select name=\"accion\">"
+"<option value=\"iniciar\">Iniciar</option><option value=\"resintonizar\">Cambiar frecuencia</option>"
+"<option value=\"detener\">Detener</option></select></label><br>"
+"<label>Frecuencia (Hz):<input type=\"number\" name=\"freq\" step=\"0.001\" value=\"1000\"></label><br>"
+"<label>GPIO (ej. 16,17,18):<input name=\"gpios\" value=\"16,17,18\"></label><br>"
+"<label>Duty por canal (%):<input name=\"duties\" value=\"33.3,33.3,33.3\"></label><br>"
+"<label>Fase por canal (grados):<input name=\"fases\" value=\"0,120,240\"></label><br>"
+CAMPOS_AGENDA
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"grupo-result\"></p></div>"
+"<div id=\"sigma-form\" class=\"form-container\"><h2>Sigma-Delta (filtrar con RC)</h2>"
+"<form id=\"sigmaForm\"><label>Acción:<select name=\"accion\">"
+"<option value=\"aplicar\">Aplicar</option><option value=\"quitar\">Quitar este GPIO</option>"
+"<option value=\"detener\">Detener todos</option></select></label><br>"
+"<label>GPIO de salida:<input type=\"number\" name=\"gpio\" value=\"4\" required></label><br>"
+"<label>Nivel medio (%):<input type=\"number\" name=\"nivel\" step=\"0.1\" value=\"50\"></label><br>"
+"<label>Amplitud del seno (%, 0 = nivel fijo):<input type=\"number\" name=\"amplitud\" step=\"0.1\" value=\"0\"></label><br>"
+"<label>Frecuencia del seno (Hz):<input type=\"number\" name=\"freq\" step=\"0.001\" value=\"10\"></label><br>"
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"sigma-result\"></p></div>"
+"<div id=\"secuencia-form\" class=\"form-container\"><h2>Secuenciador</h2>"
+"<textarea id=\"secuencia-json\" rows=\"10\" cols=\"70\">{\"gpio\":2,\"pasos\":[{\"tipo\":\"bucle\",\"veces\":10,\"pasos\":["
+"{\"tipo\":\"tono\",\"hz\":1000,\"ms\":200},{\"tipo\":\"pausa\",\"ms\":50},"
+"{\"tipo\":\"rafaga\",\"hz\":2000,\"pulsos\":30}]}]}</textarea><br>"
+"<button onclick=\"secuencia('ejecutar')\">Ejecutar</button>"
+"<button onclick=\"secuencia('compilar')\">Solo compilar</button>"
+"<button onclick=\"secuencia('detener')\">Detener</button>"
+"<p id=\"secuencia-result\"></p></div>"
+"<div id=\"reproducir-form\" class=\"form-container\"><h2>Reproducir muestras por el DAC</h2>"
+"<label>Archivo (muestras de 8 bits sin signo):<input type=\"file\" id=\"reproducir-archivo\"></label><br>"
+"<label>Frecuencia de muestreo (Hz):<input type=\"number\" id=\"reproducir-freq\" value=\"8000\" min=\"100\" max=\"199999\"></label><br>"
+"<label>DAC de salida:<select id=\"reproducir-canal\">"
+"<option value=\"0\">GPIO25</option><option value=\"1\">GPIO26</option></select></label><br>"
+"<button onclick=\"reproducir()\">Enviar y reproducir</button>"
+"<button onclick=\"fetch('/reproducir?accion=detener',{method:'POST'})\">Detener</button>"
+"<p id=\"reproducir-result\"></p></div>"
+"<div id=\"servo-form\" class=\"form-container\"><h2>Servos</h2>"
+"<form id=\"servoForm\"><label>Acción:<select name=\"accion\">"
+"<option value=\"mover\">Mover</option><option value=\"conectar\">Conectar</option>"
+"<option value=\"estado\">Estado</option><option value=\"quitar\">Quitar este GPIO</option>"
+"<option value=\"detener\">Quitar todos</option></select></label><br>"
+"<label>GPIO:<input type=\"number\" name=\"gpio\" value=\"32\" required></label><br>"
+"<label>Ángulo (grados):<input type=\"number\" name=\"angulo\" step=\"0.1\" value=\"90\"></label><br>"
+"<label>Velocidad (grados/s):<input type=\"number\" name=\"velocidad\" value=\"90\" min=\"1\" max=\"10000\"></label><br>"
+"<label>Aceleración (grados/s²):<input type=\"number\" name=\"aceleracion\" value=\"360\" min=\"1\" max=\"1000000\"></label><br>"
+"<label>Perfil:<select name=\"forma\"><option value=\"trapecio\">Trapecio</option>"
+"<option value=\"s\">Curva S</option></select></label><br>"
+"<label>Frecuencia al conectar (Hz):<input type=\"number\" name=\"freq\" value=\"50\"></label><br>"
+"<label>Pulso en 0 grados (µs):<input type=\"number\" name=\"min_us\" value=\"500\"></label><br>"
+"<label>Pulso en el extremo (µs, hasta 3000 sobre el de 0 grados):<input type=\"number\" name=\"max_us\" value=\"2500\"></label><br>"
+"<label>Recorrido (grados):<input type=\"number\" name=\"rango\" value=\"180\"></label><br>"
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"servo-result\"></p></div>"
+"<div id=\"pasos-form\" class=\"form-container\"><h2>Motor paso a paso</h2>"
+"<form id=\"pasosForm\"><label>Acción:<select name=\"accion\">"
+"<option value=\"mover\">Mover a posición</option><option value=\"conectar\">Conectar</option>"
+"<option value=\"estado\">Estado</option><option value=\"frenar\">Frenar con rampa</option>"
+"<option value=\"cero\">Fijar posición</option><option value=\"detener\">Parada inmediata</option>"
+"</select></label><br>"
+"<label>Posición (pasos):<input type=\"number\" name=\"posicion\" value=\"1000\"></label><br>"
+"<label>Velocidad (pasos/s):<input type=\"number\" name=\"velocidad\" value=\"2000\" max=\"50000\"></label><br>"
+"<label>Aceleración (pasos/s²):<input type=\"number\" name=\"aceleracion\" value=\"4000\"></label><br>"
+"<label>GPIO de paso al conectar:<input type=\"number\" name=\"gpio_paso\" value=\"27\"></label><br>"
+"<label>GPIO de dirección al conectar:<input type=\"number\" name=\"gpio_dir\" value=\"14\"></label><br>"
+"<button type=\"submit\">Enviar al ESP32</button></form>"
+"<p id=\"pasos-result\"></p></div>"
+"<div id=\"zumbador-form\" class=\"form-container\"><h2>Zumbador</h2>"
+"<label>Melodía (RTTTL):<br><textarea id=\"zumbador-rtttl\" rows=\"4\" cols=\"70\">"
+"escala:d=8,o=5,b=160:c,d,e,f,g,a,b,4c6</textarea></label><br>"
+"<button onclick=\"zumbador('tocar')\">Añadir a la cola</button>"
+"<button onclick=\"zumbador('alarma')\">Tocar ya</button>"
+"<button onclick=\"zumbador('callar')\">Callar</button>"
+"<p id=\"zumbador-result\"></p></div>"
 "<script>"
-"function toggleForm(m){document.getElementById('astable-form').style.display=m==='astable'?'block':'none';"
-"document.getElementById('pwm-form').style.display=m==='pwm'?'block':'none'}"
-"document.getElementById('astableForm').addEventListener('submit',function(e){"
-"e.preventDefault();const f=new FormData(this);fetch('/submit',{method:'POST',body:new URLSearchParams(f)})"
-".then(r=>r.text()).then(d=>{document.getElementById('astable-result').innerText='Respuesta: '+d;})"
-".catch(e=>console.error('Error:',e));});"
-"document.getElementById('pwmForm').addEventListener('submit',function(e){"
-"e.preventDefault();const f=new FormData(this);fetch('/pwm',{method:'POST',body:new URLSearchParams(f)})"
-".then(r=>r.text()).then(d=>{document.getElementById('pwm-result').innerText='Respuesta: '+d;})"
-".catch(e=>console.error('Error:',e));});"
+"function toggleForm(m){['astable','pwm','captura','onda','barrido','duty','puente','grupo','sigma','secuencia','reproducir','servo','pasos','zumbador'].forEach(function(k){"
+"document.getElementById(k+'-form').style.display=m===k?'block':'none'})}"
+"function enviar(f,u,r){document.getElementById(f).addEventListener('submit',function(e){"
+"e.preventDefault();fetch(u,{method:'POST',body:new URLSearchParams(new FormData(this))})"
+".then(x=>x.text()).then(d=>{document.getElementById(r).innerText='Respuesta: '+d;})"
+".catch(e=>console.error('Error:',e));});}"
+"enviar('astableForm','/submit','astable-result');"
+"enviar('pwmForm','/pwm','pwm-result');"
+"enviar('capturaForm','/captura','captura-result');"
+"enviar('ondaForm','/onda','onda-result');"
+"enviar('barridoForm','/barrido','barrido-result');"
+"enviar('dutyForm','/duty','duty-result');"
+"enviar('puenteForm','/puente','puente-result');"
+"enviar('grupoForm','/grupo','grupo-result');"
+"enviar('sigmaForm','/sigma','sigma-result');"
+"enviar('servoForm','/servo','servo-result');"
+"enviar('pasosForm','/pasos','pasos-result');"
+"function leerReloj(){fetch('/agenda').then(x=>x.json()).then(d=>{"
+"document.getElementById('reloj').innerText=d.reloj_us;document.getElementById('pendientes').innerText=d.pendientes;})"
+".catch(e=>console.error('Error:',e));}"
+"function secuencia(a){fetch('/secuencia?accion='+a,{method:'POST',"
+"body:document.getElementById('secuencia-json').value}).then(x=>x.text()).then(d=>{"
+"document.getElementById('secuencia-result').innerText='Respuesta: '+d;}).catch(e=>console.error('Error:',e));}"
+"function zumbador(a){fetch('/zumbador?accion='+a,{method:'POST',"
+"body:document.getElementById('zumbador-rtttl').value}).then(x=>x.text()).then(d=>{"
+"document.getElementById('zumbador-result').innerText='Respuesta: '+d;}).catch(e=>console.error('Error:',e));}"
+"function reproducir(){const a=document.getElementById('reproducir-archivo').files[0];if(!a)return;"
+"const r=document.getElementById('reproducir-result');r.innerText='Enviando...';"
+"fetch('/reproducir?freq='+document.getElementById('reproducir-freq').value+'&canal='+"
+"document.getElementById('reproducir-canal').value,{method:'POST',body:a})"
+".then(x=>x.text()).then(d=>{r.innerText='Respuesta: '+d;}).catch(e=>console.error('Error:',e));}"
+"function leerCaptura(){fetch('/captura').then(r=>{if(r.status!==200)"
+"return r.text().then(t=>{document.getElementById('captura-result').innerText=t;});"
+"return r.arrayBuffer().then(dibujarCaptura);}).catch(e=>console.error('Error:',e));}"
+"function dibujarCaptura(b){const d=new DataView(b);let p=4;const fs=d.getUint32(p,true);p+=4;"
+"const n=d.getUint8(p++);const pines=[];for(let i=0;i<n;i++)pines.push(d.getUint8(p++));"
+"const nr=d.getUint32(p,true);p+=4;const td=d.getUint32(p,true);p+=4;const regs=[];let total=0;"
+"for(let i=0;i<nr;i++){const e=d.getUint8(p++);let l=0,s=0,c;"
+"do{c=d.getUint8(p++);l|=(c&127)<<s;s+=7;}while(c&128);regs.push([e,l]);total+=l;}"
+"const cv=document.getElementById('captura-canvas'),g=cv.getContext('2d');"
+"g.clearRect(0,0,cv.width,cv.height);const h=cv.height/n;let t=0;"
+"regs.forEach(function(r,k){const x0=t*cv.width/total,w=Math.max(1,r[1]*cv.width/total);"
+"if(k===td){g.fillStyle='red';g.fillRect(x0,0,1,cv.height);}g.fillStyle='#000';"
+"for(let i=0;i<n;i++)g.fillRect(x0,h*i+((r[0]>>i)&1?4:h-6),w,2);t+=r[1];});"
+"document.getElementById('captura-result').innerText=nr+' registros, '+(total/fs).toFixed(3)+' s en GPIO '+pines.join(',');}"
 "</script></body></html>";
 
-float calcular_frecuencia(float r1, float r2, float c1) {
-    return 1.44f / ((r1 + 2 * r2) * c1);
+static void decodificar_url(char *texto) {
+    char *out = texto;
+    for (char *in = texto; *in; in++, out++) {
+        if (*in == '+') {
+            *out = ' ';
+        } else if (*in == '%' && in[1] && in[2]) {
+            char hex[3] = { in[1], in[2], '\0' };
+            *out = (char)strtol(hex, NULL, 16);
+            in += 2;
+        } else {
+            *out = *in;
+        }
+    }
+    *out = '\0';
+}
+
+// Avisos del propio firmware; van a la cola del zumbador sin esperar
+static const melodia_nota_t aviso_arranque[] = { { 72, 80 }, { 76, 80 }, { 79, 160 } };
+static const melodia_nota_t alarma_falla[] = {
+    { 81, 150 }, { MELODIA_SILENCIO, 80 }, { 81, 150 }, { MELODIA_SILENCIO, 80 }, { 81, 400 },
+};
+
+static bool obtener_campo(const char *content, const char *clave, char *valor, size_t len) {
+    if (httpd_query_key_value(content, clave, valor, len) != ESP_OK) {
+        return false;
+    }
+    decodificar_url(valor);
+    return true;
+}
+
+uint64_t calcular_frecuencia_mhz(float r1, float r2, float c1) {
+    float denominador = (r1 + 2 * r2) * c1;
+    return denominador > 0 ? dds_mhz_desde_hz(1.44 / denominador) : 0;
+}
+
+// Presupuesto de precisión del formulario; sin campos vale cualquier salida
+// razonable y gana la más barata.
+static void leer_presupuesto(const char *content, plan_peticion_t *peticion) {
+    char valor[32];
+    peticion->error_ppm_max = 1000;
+    peticion->jitter_ns_max = 1000000;
+    if (obtener_campo(content, "error_ppm", valor, sizeof(valor))) peticion->error_ppm_max = atoi(valor);
+    if (obtener_campo(content, "jitter_ns", valor, sizeof(valor))) peticion->jitter_ns_max = atoi(valor);
+}
+
+// Arranque y paro opcionales, en µs del reloj de esp_timer (GET /agenda);
+// -1 si el campo falta o está vacío.
+static void leer_agenda(const char *content, int64_t *arranque, int64_t *paro) {
+    char valor[32];
+    *arranque = -1;
+    *paro = -1;
+    if (obtener_campo(content, "arranque_us", valor, sizeof(valor)) && valor[0]) *arranque = strtoll(valor, NULL, 10);
+    if (obtener_campo(content, "paro_us", valor, sizeof(valor)) && valor[0]) *paro = strtoll(valor, NULL, 10);
+}
+
+// Sustituye las órdenes pendientes de la salida por las nuevas; si alguna no
+// cabe o ya pasó, la salida se detiene para no quedar a medias.
+static esp_err_t programar_agenda(int64_t arranque, int64_t paro, agenda_accion_t disparo, void *arg,
+                                  agenda_accion_t parada) {
+    agenda_cancelar(disparo);
+    agenda_cancelar(parada);
+    esp_err_t err = ESP_OK;
+    if (paro >= 0 && paro <= arranque) {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    if (err == ESP_OK && arranque >= 0) {
+        err = agenda_programar(arranque, disparo, arg);
+    }
+    if (err == ESP_OK && paro >= 0) {
+        err = agenda_programar(paro, parada, arg);
+    }
+    if (err != ESP_OK) {
+        agenda_cancelar(disparo);
+        parada(arg);
+    }
+    return err;
+}
+
+static void describir_agenda(char *nota, size_t len, int64_t arranque, int64_t paro) {
+    int n = snprintf(nota, len, "%s", arranque >= 0 ? "; arranque programado" : "");
+    if (paro >= 0 && n >= 0 && (size_t)n < len) {
+        snprintf(nota + n, len - n, "; paro en t=%lld us", (long long)paro);
+    }
+}
+
+static plan_backend_t plan_armado = PLAN_NUM_BACKENDS;
+
+// Detiene los generadores de onda cuadrada y arma el elegido; el reset
+// devuelve el pin a GPIO simple si antes lo tenía el LEDC o el RMT.
+static esp_err_t armar_segun_plan(int gpio, const plan_peticion_t *peticion, const plan_resultado_t *plan,
+                                  uint64_t *real_mhz) {
+    generador_gpio_detener();
+    generador_rmt_detener();
+    pwm_detener();
+    gpio_reset_pin(gpio);
+    plan_armado = plan->backend;
+    switch (plan->backend) {
+    case PLAN_LEDC:
+        return pwm_armar_bits(gpio, peticion->frecuencia_mhz, plan->bits_ledc, real_mhz);
+    case PLAN_RMT:
+        return generador_rmt_armar(gpio, peticion->frecuencia_mhz, real_mhz);
+    case PLAN_TEMPORIZADOR:
+        *real_mhz = peticion->frecuencia_mhz;
+        return generador_gpio_armar(gpio, peticion->frecuencia_mhz);
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+static esp_err_t disparar_plan(void) {
+    switch (plan_armado) {
+    case PLAN_LEDC:
+        return pwm_disparar();
+    case PLAN_RMT:
+        return generador_rmt_disparar();
+    case PLAN_TEMPORIZADOR:
+        return generador_gpio_disparar();
+    default:
+        return ESP_ERR_INVALID_STATE;
+    }
+}
+
+// Acciones de la agenda. Las salidas armadas solo arrancan contadores; el
+// barrido y la onda se configuran al dispararse, con su copia de la orden.
+static barrido_config_t barrido_programado;
+static onda_config_t onda_programada;
+
+static void disparo_plan(void *arg) {
+    esp_err_t err = disparar_plan();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Disparo programado: %s", esp_err_to_name(err));
+    }
+}
+
+static void paro_generadores(void *arg) {
+    generador_gpio_detener();
+    generador_rmt_detener();
+    pwm_detener();
 }
 
-void signal_task(void *param) {
-    int gpio = (int)(intptr_t)param;
-    gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
+static void disparo_grupo(void *arg) {
+    grupo_disparar();
+}
+
+static void paro_grupo(void *arg) {
+    grupo_detener();
+}
+
+static void disparo_puente(void *arg) {
+    puente_disparar();
+}
+
+static void paro_puente(void *arg) {
+    puente_detener();
+}
+
+static void arranque_barrido(void *arg) {
+    esp_err_t err = barrido_iniciar(arg, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Barrido programado: %s", esp_err_to_name(err));
+    }
+}
+
+static void paro_barrido(void *arg) {
+    barrido_detener();
+}
+
+static void arranque_onda(void *arg) {
+    esp_err_t err = onda_dac_aplicar(arg);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Onda programada: %s", esp_err_to_name(err));
+    }
+}
 
-    float r1 = 1000, r2 = 1000, c1 = 0.000001;
-    float freq = calcular_frecuencia(r1, r2, c1);
-    int delay_ms = (int)(500.0 / freq);
+static void paro_onda(void *arg) {
+    onda_dac_detener();
+}
 
-    while (1) {
-        gpio_set_level(gpio, 1);
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
-        gpio_set_level(gpio, 0);
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+static void describir_plan(char *resp, size_t len, bool cumple, const plan_resultado_t *plan, esp_err_t err) {
+    if (!cumple && plan->backend == PLAN_NUM_BACKENDS) {
+        snprintf(resp, len, "Frecuencia fuera del alcance de todas las salidas");
+    } else if (!cumple) {
+        snprintf(resp, len, "Ninguna salida cumple; la mejor es %s con error %lu ppm y jitter %lu ns",
+                 plan_nombre(plan->backend), (unsigned long)plan->error_ppm, (unsigned long)plan->jitter_ns);
+    } else if (err != ESP_OK) {
+        snprintf(resp, len, "Error al generar señal por %s: %s", plan_nombre(plan->backend), esp_err_to_name(err));
+    } else {
+        snprintf(resp, len, " por %s (error %lu ppm, jitter %lu ns)", plan_nombre(plan->backend),
+                 (unsigned long)plan->error_ppm, (unsigned long)plan->jitter_ns);
     }
 }
 
 esp_err_t submit_post_handler(httpd_req_t *req) {
-    char content[100];
-    httpd_req_recv(req, content, sizeof(content));
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
 
-    float r1 = atof(strstr(content, "r1=") + 3);
-    float r2 = atof(strstr(content, "r2=") + 3);
-    float c1 = atof(strstr(content, "c1=") + 3);
-    int gpio = atoi(strstr(content, "gpio=") + 5);
+    char valor[32];
+    float r1 = 0, r2 = 0, c1 = 0;
+    int gpio = 0;
+    if (obtener_campo(content, "r1", valor, sizeof(valor))) r1 = atof(valor);
+    if (obtener_campo(content, "r2", valor, sizeof(valor))) r2 = atof(valor);
+    if (obtener_campo(content, "c1", valor, sizeof(valor))) c1 = atof(valor);
+    if (obtener_campo(content, "gpio", valor, sizeof(valor))) gpio = atoi(valor);
 
-    float freq = calcular_frecuencia(r1, r2, c1);
-    float periodo_ms = 1000.0 / freq;
+    plan_peticion_t peticion = { .frecuencia_mhz = calcular_frecuencia_mhz(r1, r2, c1) };
+    leer_presupuesto(content, &peticion);
+    int64_t arranque, paro;
+    leer_agenda(content, &arranque, &paro);
+    plan_resultado_t plan;
+    uint64_t real_mhz = 0;
+    bool cumple = planificar(&peticion, &plan);
+    if (cumple) {
+        // Las órdenes del generador anterior se quitan antes de rearmar, para
+        // que ninguna dispare o pare el nuevo
+        agenda_cancelar(disparo_plan);
+        agenda_cancelar(paro_generadores);
+    }
+    esp_err_t err = cumple ? armar_segun_plan(gpio, &peticion, &plan, &real_mhz) : ESP_ERR_NOT_SUPPORTED;
+    if (err == ESP_OK && arranque < 0) {
+        err = disparar_plan();
+    }
+    if (err == ESP_OK) {
+        err = programar_agenda(arranque, paro, disparo_plan, NULL, paro_generadores);
+    }
 
-    xTaskCreatePinnedToCore(signal_task, "signal_task", 2048, (void*)(intptr_t)gpio, 1, NULL, 1);
+    char resp[250], detalle[120], nota[64];
+    describir_plan(detalle, sizeof(detalle), cumple, &plan, err);
+    describir_agenda(nota, sizeof(nota), arranque, paro);
+    if (cumple && err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "Frecuencia: %.3f Hz, Periodo: %.3f ms en GPIO %d%s%s",
+                 real_mhz / 1000.0, 1e6 / real_mhz, gpio, detalle, nota);
+    } else {
+        snprintf(resp, sizeof(resp), "%s", detalle);
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t pwm_post_handler(httpd_req_t *req) {
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char valor[32];
+    plan_peticion_t peticion = { 0 };
+    int gpio = 0;
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) peticion.frecuencia_mhz = dds_mhz_desde_hz(atof(valor));
+    if (obtener_campo(content, "gpio", valor, sizeof(valor))) gpio = atoi(valor);
+    leer_presupuesto(content, &peticion);
+    int64_t arranque, paro;
+    leer_agenda(content, &arranque, &paro);
+
+    plan_resultado_t plan;
+    uint64_t real_mhz = 0;
+    bool cumple = planificar(&peticion, &plan);
+    if (cumple) {
+        // Las órdenes del generador anterior se quitan antes de rearmar, para
+        // que ninguna dispare o pare el nuevo
+        agenda_cancelar(disparo_plan);
+        agenda_cancelar(paro_generadores);
+    }
+    esp_err_t err = cumple ? armar_segun_plan(gpio, &peticion, &plan, &real_mhz) : ESP_ERR_NOT_SUPPORTED;
+    if (err == ESP_OK && arranque < 0) {
+        err = disparar_plan();
+    }
+    if (err == ESP_OK) {
+        err = programar_agenda(arranque, paro, disparo_plan, NULL, paro_generadores);
+    }
+
+    char resp[250], detalle[120], nota[64];
+    describir_plan(detalle, sizeof(detalle), cumple, &plan, err);
+    describir_agenda(nota, sizeof(nota), arranque, paro);
+    if (cumple && err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "PWM aplicado: %.3f Hz en GPIO %d%s%s", real_mhz / 1000.0, gpio, detalle, nota);
+    } else {
+        snprintf(resp, sizeof(resp), "%s", detalle);
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t duty_post_handler(httpd_req_t *req) {
+    char content[150];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char modo[16] = "fijar", valor[32];
+    double duty = 50, duty2 = 0, tono_hz = 440;
+    uint32_t tiempo_ms = 1000;
+    obtener_campo(content, "modo", modo, sizeof(modo));
+    if (obtener_campo(content, "duty", valor, sizeof(valor))) duty = atof(valor);
+    if (obtener_campo(content, "duty2", valor, sizeof(valor))) duty2 = atof(valor);
+    if (obtener_campo(content, "tiempo", valor, sizeof(valor))) tiempo_ms = atoi(valor);
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) tono_hz = atof(valor);
+    bool tono = strcmp(modo, "tono") == 0;
+    if (tono && !(tono_hz >= TONO_MIN_HZ && tono_hz <= TONO_MAX_HZ)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Frecuencia del tono fuera de 0,1 a 2000 Hz");
+        return ESP_OK;
+    }
+
+    uint32_t maximo = pwm_duty_maximo();
+    uint32_t alto = (uint32_t)(duty / 100.0 * maximo + 0.5);
+    uint32_t bajo = (uint32_t)(duty2 / 100.0 * maximo + 0.5);
+    esp_err_t err;
+    if (maximo == 0 || duty < 0 || duty > 100 || duty2 < 0 || duty2 > 100) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (strcmp(modo, "rampa") == 0) {
+        pwm_segmento_t seg = { alto, tiempo_ms * 1000 };
+        err = pwm_fundido(&seg, 1, false);
+    } else if (strcmp(modo, "respiracion") == 0 || tono) {
+        uint32_t medio_us = tono ? (uint32_t)(500000.0 / tono_hz) : tiempo_ms * 500;
+        pwm_segmento_t segs[2] = { { alto, medio_us }, { bajo, medio_us } };
+        err = pwm_fundido(segs, 2, true);
+    } else {
+        err = pwm_fijar_duty(alto);
+    }
 
     char resp[100];
-    snprintf(resp, sizeof(resp), "Frecuencia: %.2f Hz, Periodo: %.2f ms en GPIO %d", freq, periodo_ms, gpio);
+    if (err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "Duty %s: %lu/%lu", modo, (unsigned long)alto, (unsigned long)maximo);
+    } else {
+        snprintf(resp, sizeof(resp), "Error (configure primero el modo PWM): %s", esp_err_to_name(err));
+    }
     httpd_resp_sendstr(req, resp);
     return ESP_OK;
 }
 
-esp_err_t pwm_post_handler(httpd_req_t *req) {
-    char content[100];
-    httpd_req_recv(req, content, sizeof(content));
+// Recibe el cuerpo por bloques y los pasa al reproductor mientras suena; si
+// el buffer está lleno, reproductor_escribir espera y TCP frena al navegador.
+esp_err_t reproducir_post_handler(httpd_req_t *req) {
+    char consulta[64], valor[16];
+    uint32_t freq = 8000;
+    int canal = 0;
+    if (httpd_req_get_url_query_str(req, consulta, sizeof(consulta)) == ESP_OK) {
+        if (obtener_campo(consulta, "accion", valor, sizeof(valor)) && strcmp(valor, "detener") == 0) {
+            reproductor_detener();
+            httpd_resp_sendstr(req, "Reproducción detenida");
+            return ESP_OK;
+        }
+        if (obtener_campo(consulta, "freq", valor, sizeof(valor))) freq = atoi(valor);
+        if (obtener_campo(consulta, "canal", valor, sizeof(valor))) canal = atoi(valor);
+    }
+
+    char resp[120];
+    esp_err_t err = reproductor_iniciar(freq, canal);
+    uint8_t *bloque = err == ESP_OK ? malloc(REPRODUCTOR_BLOQUE) : NULL;
+    if (err == ESP_OK && bloque == NULL) {
+        err = ESP_ERR_NO_MEM;
+    }
+    size_t restantes = req->content_len;
+    while (err == ESP_OK && restantes > 0) {
+        int len = httpd_req_recv(req, (char *)bloque, restantes < REPRODUCTOR_BLOQUE ? restantes : REPRODUCTOR_BLOQUE);
+        if (len == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
+        if (len <= 0) {
+            err = ESP_FAIL;
+            break;
+        }
+        // Con el buffer lleno, hacer sitio al bloque tarda lo que dura
+        // reproducirlo: a 100 Hz son más de 10 s, la espera sale de freq
+        err = reproductor_escribir(bloque, len, (uint32_t)len * 1000 / freq + 1000);
+        restantes -= len;
+    }
+    free(bloque);
+    if (err == ESP_OK) {
+        // Lo que quede en el buffer dura como mucho su tamaño entre la frecuencia
+        err = reproductor_terminar(REPRODUCTOR_BUFFER_BYTES * 1000 / freq + 1000);
+    }
 
-    float freq = atof(strstr(content, "freq=") + 5);
-    int gpio = atoi(strstr(content, "gpio=") + 5);
+    reproductor_estadisticas_t e;
+    reproductor_estadisticas(&e);
+    reproductor_detener();
+    if (err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "Reproducidas %lu muestras a %lu Hz, %lu huecos por falta de datos",
+                 (unsigned long)e.recibidos, (unsigned long)freq, (unsigned long)e.subdesbordes);
+    } else {
+        snprintf(resp, sizeof(resp), "Error al reproducir tras %lu muestras: %s", (unsigned long)e.recibidos,
+                 esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
 
-    ledc_timer_config_t ledc_timer = {
-        .speed_mode = LEDC_HIGH_SPEED_MODE,
-        .timer_num = LEDC_TIMER_0,
-        .duty_resolution = LEDC_TIMER_10_BIT,
-        .freq_hz = (uint32_t)freq,
-        .clk_cfg = LEDC_AUTO_CLK
-    };
-    ledc_timer_config(&ledc_timer);
+esp_err_t secuencia_post_handler(httpd_req_t *req) {
+    char consulta[32], accion[16] = "ejecutar";
+    if (httpd_req_get_url_query_str(req, consulta, sizeof(consulta)) == ESP_OK) {
+        obtener_campo(consulta, "accion", accion, sizeof(accion));
+    }
+    if (strcmp(accion, "detener") == 0) {
+        esp_err_t err = secuenciador_detener();
+        httpd_resp_sendstr(req, err == ESP_OK ? "Secuencia detenida" : "No hay secuencia activa");
+        return ESP_OK;
+    }
+    if (req->content_len == 0 || req->content_len > SECUENCIA_MAX_JSON) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "JSON vacío o demasiado grande");
+        return ESP_OK;
+    }
 
-    ledc_channel_config_t ledc_channel = {
-        .gpio_num = gpio,
-        .speed_mode = LEDC_HIGH_SPEED_MODE,
-        .channel = LEDC_CHANNEL_0,
-        .timer_sel = LEDC_TIMER_0,
-        .duty = 512,
-        .hpoint = 0
-    };
-    ledc_channel_config(&ledc_channel);
+    // El JSON puede llegar en varios segmentos TCP
+    char *json = malloc(req->content_len + 1);
+    uint32_t *codigo = malloc(SEC_MAX_PALABRAS * sizeof(uint32_t));
+    if (json == NULL || codigo == NULL) {
+        free(json);
+        free(codigo);
+        return ESP_ERR_NO_MEM;
+    }
+    size_t recibidos = 0;
+    while (recibidos < req->content_len) {
+        int len = httpd_req_recv(req, json + recibidos, req->content_len - recibidos);
+        if (len <= 0) {
+            free(json);
+            free(codigo);
+            return ESP_FAIL;
+        }
+        recibidos += len;
+    }
+    json[recibidos] = '\0';
+
+    sec_programa_t programa;
+    int gpio = 2;
+    sec_programa_iniciar(&programa, codigo, SEC_MAX_PALABRAS);
+    esp_err_t err = secuenciador_compilar(json, &programa, &gpio);
+    free(json);
+    if (err == ESP_OK && strcmp(accion, "compilar") != 0) {
+        err = secuenciador_iniciar(gpio, codigo, programa.longitud);
+    }
 
     char resp[100];
-    snprintf(resp, sizeof(resp), "PWM aplicado: %.2f Hz en GPIO %d", freq, gpio);
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en la secuencia: %s", esp_err_to_name(err));
+        httpd_resp_sendstr(req, resp);
+    } else if (strcmp(accion, "compilar") == 0) {
+        snprintf(resp, sizeof(resp), "%lu palabras:", (unsigned long)programa.longitud);
+        httpd_resp_send_chunk(req, resp, HTTPD_RESP_USE_STRLEN);
+        for (uint32_t i = 0; i < programa.longitud; i++) {
+            snprintf(resp, sizeof(resp), " %08lx", (unsigned long)codigo[i]);
+            httpd_resp_send_chunk(req, resp, HTTPD_RESP_USE_STRLEN);
+        }
+        httpd_resp_send_chunk(req, NULL, 0);
+    } else {
+        snprintf(resp, sizeof(resp), "Secuencia en GPIO %d: %lu palabras", gpio, (unsigned long)programa.longitud);
+        httpd_resp_sendstr(req, resp);
+    }
+    free(codigo);
+    return ESP_OK;
+}
+
+esp_err_t sigma_post_handler(httpd_req_t *req) {
+    char content[150];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char accion[16] = "aplicar", valor[32];
+    sigma_canal_t canal = { .gpio = -1, .nivel_permil = 500 };
+    obtener_campo(content, "accion", accion, sizeof(accion));
+    if (obtener_campo(content, "gpio", valor, sizeof(valor))) canal.gpio = atoi(valor);
+    if (obtener_campo(content, "nivel", valor, sizeof(valor))) canal.nivel_permil = (uint16_t)(atof(valor) * 10 + 0.5);
+    if (obtener_campo(content, "amplitud", valor, sizeof(valor))) canal.amplitud_permil = (uint16_t)(atof(valor) * 10 + 0.5);
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) canal.frecuencia_mhz = dds_mhz_desde_hz(atof(valor));
+    if (canal.amplitud_permil == 0) {
+        canal.frecuencia_mhz = 0;
+    }
+
+    esp_err_t err;
+    if (strcmp(accion, "detener") == 0) {
+        err = sigma_delta_detener();
+    } else if (strcmp(accion, "quitar") == 0) {
+        err = sigma_delta_quitar(canal.gpio);
+    } else {
+        err = sigma_delta_aplicar(&canal);
+    }
+
+    char resp[100];
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en sigma-delta: %s", esp_err_to_name(err));
+    } else if (strcmp(accion, "aplicar") == 0) {
+        snprintf(resp, sizeof(resp), "Sigma-delta en GPIO %d: nivel %.1f %%, seno %.1f %% a %.3f Hz", canal.gpio,
+                 canal.nivel_permil / 10.0, canal.amplitud_permil / 10.0, canal.frecuencia_mhz / 1000.0);
+    } else {
+        snprintf(resp, sizeof(resp), "Sigma-delta: %s", accion);
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t servo_post_handler(httpd_req_t *req) {
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char accion[16] = "mover", valor[32];
+    servo_config_t cfg = { .gpio = -1, .frecuencia_hz = 50, .min_us = 500, .max_us = 2500, .rango_grados = 180,
+                           .angulo_mgrados = 90000 };
+    servo_movimiento_t mov = { .velocidad_gps = 90, .aceleracion_gps2 = 360, .forma = SERVO_TRAPECIO };
+    obtener_campo(content, "accion", accion, sizeof(accion));
+    if (obtener_campo(content, "gpio", valor, sizeof(valor))) cfg.gpio = atoi(valor);
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) cfg.frecuencia_hz = atoi(valor);
+    if (obtener_campo(content, "min_us", valor, sizeof(valor))) cfg.min_us = atoi(valor);
+    if (obtener_campo(content, "max_us", valor, sizeof(valor))) cfg.max_us = atoi(valor);
+    if (obtener_campo(content, "rango", valor, sizeof(valor))) cfg.rango_grados = atoi(valor);
+    if (obtener_campo(content, "angulo", valor, sizeof(valor)) && atof(valor) >= 0) {
+        cfg.angulo_mgrados = (uint32_t)(atof(valor) * 1000 + 0.5);
+    }
+    if (obtener_campo(content, "velocidad", valor, sizeof(valor))) mov.velocidad_gps = atoi(valor);
+    if (obtener_campo(content, "aceleracion", valor, sizeof(valor))) mov.aceleracion_gps2 = atoi(valor);
+    if (obtener_campo(content, "forma", valor, sizeof(valor)) && strcmp(valor, "s") == 0) mov.forma = SERVO_CURVA_S;
+    mov.angulo_mgrados = cfg.angulo_mgrados;
+
+    char resp[100];
+    esp_err_t err;
+    if (strcmp(accion, "detener") == 0) {
+        err = servo_detener();
+        snprintf(resp, sizeof(resp), "Servos desconectados");
+    } else if (strcmp(accion, "quitar") == 0) {
+        err = servo_quitar(cfg.gpio);
+        snprintf(resp, sizeof(resp), "Servo en GPIO %d desconectado", cfg.gpio);
+    } else if (strcmp(accion, "conectar") == 0) {
+        err = servo_conectar(&cfg);
+        snprintf(resp, sizeof(resp), "Servo en GPIO %d a %lu Hz, en %.1f grados", cfg.gpio,
+                 (unsigned long)cfg.frecuencia_hz, cfg.angulo_mgrados / 1000.0);
+    } else if (strcmp(accion, "estado") == 0) {
+        uint32_t angulo = 0;
+        bool moviendo = false;
+        err = servo_posicion(cfg.gpio, &angulo, &moviendo);
+        snprintf(resp, sizeof(resp), "Servo en GPIO %d: %.1f grados%s", cfg.gpio, angulo / 1000.0,
+                 moviendo ? ", en movimiento" : "");
+    } else {
+        err = servo_mover(cfg.gpio, &mov);
+        snprintf(resp, sizeof(resp), "Servo en GPIO %d hacia %.1f grados", cfg.gpio, mov.angulo_mgrados / 1000.0);
+    }
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en el servo: %s", esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t pasos_post_handler(httpd_req_t *req) {
+    char content[200];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char accion[16] = "mover", valor[32];
+    int gpio_paso = -1, gpio_dir = -1;
+    int32_t posicion = 0;
+    uint32_t velocidad = 2000, aceleracion = 4000;
+    obtener_campo(content, "accion", accion, sizeof(accion));
+    if (obtener_campo(content, "posicion", valor, sizeof(valor))) posicion = atol(valor);
+    if (obtener_campo(content, "velocidad", valor, sizeof(valor))) velocidad = atoi(valor);
+    if (obtener_campo(content, "aceleracion", valor, sizeof(valor))) aceleracion = atoi(valor);
+    if (obtener_campo(content, "gpio_paso", valor, sizeof(valor))) gpio_paso = atoi(valor);
+    if (obtener_campo(content, "gpio_dir", valor, sizeof(valor))) gpio_dir = atoi(valor);
+
+    char resp[100];
+    esp_err_t err;
+    if (strcmp(accion, "conectar") == 0) {
+        err = motor_pasos_conectar(gpio_paso, gpio_dir);
+        snprintf(resp, sizeof(resp), "Motor con paso en GPIO %d y dirección en GPIO %d, en 0", gpio_paso, gpio_dir);
+    } else if (strcmp(accion, "frenar") == 0) {
+        err = motor_pasos_frenar();
+        snprintf(resp, sizeof(resp), "Frenando");
+    } else if (strcmp(accion, "cero") == 0) {
+        err = motor_pasos_fijar_posicion(posicion);
+        snprintf(resp, sizeof(resp), "Posición fijada en %ld", (long)posicion);
+    } else if (strcmp(accion, "detener") == 0) {
+        err = motor_pasos_detener();
+        snprintf(resp, sizeof(resp), "Motor desconectado");
+    } else if (strcmp(accion, "estado") == 0) {
+        int32_t actual = 0, destino = 0;
+        bool moviendo = false;
+        err = motor_pasos_estado(&actual, &destino, &moviendo);
+        snprintf(resp, sizeof(resp), "Posición %ld%s, destino %ld", (long)actual, moviendo ? " en movimiento" : "",
+                 (long)destino);
+    } else {
+        err = motor_pasos_mover_a(posicion, velocidad, aceleracion);
+        snprintf(resp, sizeof(resp), "Hacia %ld a %lu pasos/s", (long)posicion, (unsigned long)velocidad);
+    }
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en el motor: %s", esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t grupo_post_handler(httpd_req_t *req) {
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char accion[16] = "iniciar", valor[64];
+    grupo_config_t cfg = { 0 };
+    obtener_campo(content, "accion", accion, sizeof(accion));
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) cfg.frecuencia_mhz = dds_mhz_desde_hz(atof(valor));
+    if (obtener_campo(content, "gpios", valor, sizeof(valor))) {
+        for (char *tok = strtok(valor, ", "); tok && cfg.num_canales < GRUPO_MAX_CANALES; tok = strtok(NULL, ", ")) {
+            cfg.canales[cfg.num_canales].duty_permil = 500;
+            cfg.canales[cfg.num_canales++].gpio = atoi(tok);
+        }
+    }
+    if (obtener_campo(content, "duties", valor, sizeof(valor))) {
+        int i = 0;
+        for (char *tok = strtok(valor, ", "); tok && i < cfg.num_canales; tok = strtok(NULL, ", ")) {
+            cfg.canales[i++].duty_permil = (uint16_t)(atof(tok) * 10 + 0.5);
+        }
+    }
+    if (obtener_campo(content, "fases", valor, sizeof(valor))) {
+        int i = 0;
+        for (char *tok = strtok(valor, ", "); tok && i < cfg.num_canales; tok = strtok(NULL, ", ")) {
+            cfg.canales[i++].fase_grados = atoi(tok) % 360;
+        }
+    }
+
+    int64_t arranque, paro;
+    leer_agenda(content, &arranque, &paro);
+
+    uint64_t real_mhz = 0;
+    esp_err_t err;
+    if (strcmp(accion, "detener") == 0) {
+        agenda_cancelar(disparo_grupo);
+        agenda_cancelar(paro_grupo);
+        err = grupo_detener();
+    } else if (strcmp(accion, "resintonizar") == 0) {
+        err = grupo_resintonizar(cfg.frecuencia_mhz, &real_mhz);
+    } else {
+        err = grupo_armar(&cfg, &real_mhz);
+        if (err == ESP_OK && arranque < 0) {
+            err = grupo_disparar();
+        }
+        if (err == ESP_OK) {
+            err = programar_agenda(arranque, paro, disparo_grupo, NULL, paro_grupo);
+        }
+    }
+
+    char resp[150], nota[64];
+    describir_agenda(nota, sizeof(nota), arranque, paro);
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en el grupo PWM: %s", esp_err_to_name(err));
+    } else if (strcmp(accion, "detener") == 0) {
+        snprintf(resp, sizeof(resp), "Grupo detenido");
+    } else if (strcmp(accion, "resintonizar") == 0) {
+        snprintf(resp, sizeof(resp), "Grupo a %.3f Hz", real_mhz / 1000.0);
+    } else {
+        snprintf(resp, sizeof(resp), "Grupo a %.3f Hz%s", real_mhz / 1000.0, nota);
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t puente_post_handler(httpd_req_t *req) {
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char accion[16] = "iniciar", valor[32];
+    puente_config_t cfg = { .duty_permil = { 500, 500 }, .muerto_ns = 500 };
+    obtener_campo(content, "accion", accion, sizeof(accion));
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) cfg.frecuencia_mhz = dds_mhz_desde_hz(atof(valor));
+    if (obtener_campo(content, "duty_a", valor, sizeof(valor))) cfg.duty_permil[0] = (uint16_t)(atof(valor) * 10 + 0.5);
+    if (obtener_campo(content, "duty_b", valor, sizeof(valor))) cfg.duty_permil[1] = (uint16_t)(atof(valor) * 10 + 0.5);
+    if (obtener_campo(content, "muerto", valor, sizeof(valor))) cfg.muerto_ns = atoi(valor);
+    if (obtener_campo(content, "desfase", valor, sizeof(valor))) cfg.desfase_grados = atoi(valor);
+    int64_t arranque, paro;
+    leer_agenda(content, &arranque, &paro);
+
+    char resp[200], nota[64];
+    esp_err_t err;
+    if (strcmp(accion, "detener") == 0) {
+        agenda_cancelar(disparo_puente);
+        agenda_cancelar(paro_puente);
+        err = puente_detener();
+        snprintf(resp, sizeof(resp), "Puente detenido");
+    } else if (strcmp(accion, "rearmar") == 0) {
+        err = puente_rearmar();
+        snprintf(resp, sizeof(resp), "Puente rearmado");
+    } else if (strcmp(accion, "duty") == 0) {
+        err = puente_fijar_duty(0, cfg.duty_permil[0]);
+        if (err == ESP_OK) {
+            err = puente_fijar_duty(1, cfg.duty_permil[1]);
+        }
+        snprintf(resp, sizeof(resp), "Duty A %.1f %%, B %.1f %%", cfg.duty_permil[0] / 10.0, cfg.duty_permil[1] / 10.0);
+    } else {
+        puente_tiempos_t t;
+        err = puente_armar(&cfg, &t);
+        if (err == ESP_OK && arranque < 0) {
+            err = puente_disparar();
+        }
+        if (err == ESP_OK) {
+            err = programar_agenda(arranque, paro, disparo_puente, NULL, paro_puente);
+        }
+        describir_agenda(nota, sizeof(nota), arranque, paro);
+        snprintf(resp, sizeof(resp), "Puente a %.3f Hz: periodo %lu ticks de %lu ns, muerto %lu ticks, desfase %lu ticks%s",
+                 puente_frecuencia_real(&t) / 1000.0, (unsigned long)t.periodo_ticks,
+                 (unsigned long)(1000000000UL / t.resolucion_hz), (unsigned long)t.muerto_ticks,
+                 (unsigned long)t.desfase_ticks, nota);
+    }
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en el puente%s: %s", puente_en_falla() ? " (falla activa)" : "",
+                 esp_err_to_name(err));
+        if (puente_en_falla()) {
+            zumbador_encolar(alarma_falla, sizeof(alarma_falla) / sizeof(alarma_falla[0]), true);
+        }
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t zumbador_post_handler(httpd_req_t *req) {
+    char consulta[32], accion[16] = "tocar";
+    if (httpd_req_get_url_query_str(req, consulta, sizeof(consulta)) == ESP_OK) {
+        obtener_campo(consulta, "accion", accion, sizeof(accion));
+    }
+    char resp[100];
+    esp_err_t err = ESP_OK;
+    if (strcmp(accion, "callar") == 0) {
+        err = zumbador_callar();
+        snprintf(resp, sizeof(resp), "Zumbador en silencio");
+    } else if (req->content_len == 0 || req->content_len > ZUMBADOR_MAX_RTTTL) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Melodía vacía o demasiado larga");
+        return ESP_OK;
+    } else {
+        char *texto = malloc(req->content_len + 1);
+        melodia_nota_t *notas = malloc(ZUMBADOR_COLA * sizeof(melodia_nota_t));
+        if (texto == NULL || notas == NULL) {
+            free(texto);
+            free(notas);
+            return ESP_ERR_NO_MEM;
+        }
+        size_t recibidos = 0;
+        while (recibidos < req->content_len) {
+            int len = httpd_req_recv(req, texto + recibidos, req->content_len - recibidos);
+            if (len <= 0) {
+                free(texto);
+                free(notas);
+                return ESP_FAIL;
+            }
+            recibidos += len;
+        }
+        texto[recibidos] = '\0';
+        int n = melodia_rtttl(texto, notas, ZUMBADOR_COLA);
+        err = n <= 0 ? ESP_ERR_INVALID_ARG : zumbador_encolar(notas, n, strcmp(accion, "alarma") == 0);
+        snprintf(resp, sizeof(resp), "%d notas en cola, %d pendientes", n, zumbador_pendientes());
+        free(texto);
+        free(notas);
+    }
+    if (err != ESP_OK) {
+        snprintf(resp, sizeof(resp), "Error en el zumbador: %s", esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t captura_post_handler(httpd_req_t *req) {
+    char content[200];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char valor[64];
+    if (obtener_campo(content, "accion", valor, sizeof(valor)) && strcmp(valor, "detener") == 0) {
+        captura_detener();
+        httpd_resp_sendstr(req, "Captura detenida");
+        return ESP_OK;
+    }
+
+    captura_config_t cfg = { .pre_disparo_pct = 10 };
+    if (obtener_campo(content, "pines", valor, sizeof(valor))) {
+        for (char *tok = strtok(valor, ", "); tok && cfg.num_pines < CAPTURA_MAX_PINES; tok = strtok(NULL, ", ")) {
+            cfg.pines[cfg.num_pines++] = atoi(tok);
+        }
+    }
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) cfg.frecuencia_hz = atoi(valor);
+    if (obtener_campo(content, "duracion", valor, sizeof(valor))) cfg.duracion_ms = atoi(valor);
+    if (obtener_campo(content, "canal", valor, sizeof(valor))) cfg.canal_disparo = atoi(valor);
+    if (obtener_campo(content, "pre", valor, sizeof(valor))) {
+        // Se comprueba antes de estrechar a uint8_t, que daría la vuelta
+        int pre = atoi(valor);
+        if (pre < 0 || pre > CAPTURA_MAX_PRE_DISPARO_PCT) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Pre-disparo fuera de 0 a 90 %");
+            return ESP_OK;
+        }
+        cfg.pre_disparo_pct = (uint8_t)pre;
+    }
+    if (obtener_campo(content, "disparo", valor, sizeof(valor))) {
+        if (strcmp(valor, "subida") == 0) cfg.disparo = CAPTURA_DISPARO_SUBIDA;
+        else if (strcmp(valor, "bajada") == 0) cfg.disparo = CAPTURA_DISPARO_BAJADA;
+        else if (strcmp(valor, "patron") == 0) cfg.disparo = CAPTURA_DISPARO_PATRON;
+    }
+    if (obtener_campo(content, "patron", valor, sizeof(valor))) {
+        for (int i = 0; valor[i] && i < CAPTURA_MAX_PINES; i++) {
+            if (valor[i] == '0' || valor[i] == '1') {
+                cfg.patron_mascara |= 1u << i;
+                cfg.patron_valor |= (valor[i] == '1') << i;
+            }
+        }
+    }
+
+    esp_err_t err = captura_iniciar(&cfg);
+    char resp[100];
+    if (err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "Captura iniciada: %d pines a %lu Hz", cfg.num_pines, (unsigned long)cfg.frecuencia_hz);
+    } else {
+        snprintf(resp, sizeof(resp), "Error al iniciar captura: %s", esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+static esp_err_t enviar_bloque(void *ctx, const char *datos, size_t len) {
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, datos, len);
+}
+
+esp_err_t captura_get_handler(httpd_req_t *req) {
+    if (captura_en_curso()) {
+        httpd_resp_set_status(req, "202 Accepted");
+        httpd_resp_sendstr(req, "Captura en curso");
+        return ESP_OK;
+    }
+    captura_detener();
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    esp_err_t err = captura_transmitir(enviar_bloque, req);
+    if (err == ESP_ERR_INVALID_STATE) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No hay captura disponible");
+        return ESP_OK;
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+esp_err_t onda_post_handler(httpd_req_t *req) {
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char valor[32];
+    onda_config_t cfg = { .forma = ONDA_SENO, .amplitud = 100, .offset = 128 };
+    if (obtener_campo(content, "forma", valor, sizeof(valor))) {
+        if (strcmp(valor, "triangular") == 0) cfg.forma = ONDA_TRIANGULAR;
+        else if (strcmp(valor, "sierra") == 0) cfg.forma = ONDA_SIERRA;
+    }
+    if (obtener_campo(content, "freq", valor, sizeof(valor))) {
+        // Lo que no quepa en 32 bits queda saturado y onda_dac lo rechaza
+        uint64_t mhz = dds_mhz_desde_hz(atof(valor));
+        cfg.frecuencia_mhz = mhz > UINT32_MAX ? UINT32_MAX : (uint32_t)mhz;
+    }
+    // Amplitud y nivel central se comprueban antes de estrechar a uint8_t
+    int amplitud = cfg.amplitud, offset = cfg.offset;
+    if (obtener_campo(content, "amplitud", valor, sizeof(valor))) amplitud = atoi(valor);
+    if (obtener_campo(content, "offset", valor, sizeof(valor))) offset = atoi(valor);
+    if (amplitud < 0 || amplitud > ONDA_DAC_AMPLITUD_MAX || offset < 0 || offset > 255) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Amplitud fuera de 0 a 127 u offset fuera de 0 a 255");
+        return ESP_OK;
+    }
+    cfg.amplitud = (uint8_t)amplitud;
+    cfg.offset = (uint8_t)offset;
+    if (obtener_campo(content, "canal", valor, sizeof(valor))) cfg.canal = atoi(valor);
+    int64_t arranque, paro;
+    leer_agenda(content, &arranque, &paro);
+
+    esp_err_t err = onda_dac_validar(&cfg);
+    if (err != ESP_OK) {
+        char error[80];
+        snprintf(error, sizeof(error), "Frecuencia fuera de 0 a %d Hz o canal distinto de 0 y 1",
+                 ONDA_DAC_FRECUENCIA_MUESTREO / 4);
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+        return ESP_OK;
+    }
+    // Sin órdenes pendientes ni en curso, onda_programada ya se puede reescribir
+    agenda_cancelar(arranque_onda);
+    agenda_cancelar(paro_onda);
+    if (arranque < 0) {
+        err = onda_dac_aplicar(&cfg);
+    } else {
+        onda_programada = cfg;
+    }
+    if (err == ESP_OK) {
+        err = programar_agenda(arranque, paro, arranque_onda, &onda_programada, paro_onda);
+    }
+    char resp[150], nota[64];
+    describir_agenda(nota, sizeof(nota), arranque, paro);
+    if (err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "Onda aplicada: %.3f Hz en GPIO %d%s", cfg.frecuencia_mhz / 1000.0,
+                 cfg.canal ? 26 : 25, nota);
+    } else {
+        snprintf(resp, sizeof(resp), "Error al aplicar onda: %s", esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t barrido_post_handler(httpd_req_t *req) {
+    char content[250];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char valor[32];
+    barrido_config_t cfg = { .gpio_sync = -1, .perfil = BARRIDO_LINEAL };
+    if (obtener_campo(content, "inicio", valor, sizeof(valor))) cfg.inicio_mhz = dds_mhz_desde_hz(atof(valor));
+    if (obtener_campo(content, "fin", valor, sizeof(valor))) cfg.fin_mhz = dds_mhz_desde_hz(atof(valor));
+    if (obtener_campo(content, "duracion", valor, sizeof(valor))) cfg.duracion_ms = atoi(valor);
+    if (obtener_campo(content, "perfil", valor, sizeof(valor)) && strcmp(valor, "log") == 0) cfg.perfil = BARRIDO_LOGARITMICO;
+    if (obtener_campo(content, "gpio", valor, sizeof(valor))) cfg.gpio = atoi(valor);
+    if (obtener_campo(content, "sync", valor, sizeof(valor))) cfg.gpio_sync = atoi(valor);
+    cfg.repetir = obtener_campo(content, "repetir", valor, sizeof(valor));
+    int64_t arranque, paro;
+    leer_agenda(content, &arranque, &paro);
+
+    barrido_backend_t backend;
+    esp_err_t err = barrido_validar(&cfg);
+    if (err == ESP_ERR_NOT_SUPPORTED) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Rango fuera del alcance del LEDC y del temporizador");
+        return ESP_OK;
+    }
+    if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "GPIO, frecuencias de al menos 1 Hz o duración no válidos");
+        return ESP_OK;
+    }
+    // Sin órdenes pendientes ni en curso, barrido_programado ya se puede reescribir
+    agenda_cancelar(arranque_barrido);
+    agenda_cancelar(paro_barrido);
+    if (arranque < 0) {
+        err = barrido_iniciar(&cfg, &backend);
+    } else {
+        barrido_programado = cfg;
+    }
+    if (err == ESP_OK) {
+        err = programar_agenda(arranque, paro, arranque_barrido, &barrido_programado, paro_barrido);
+    }
+    char resp[150], nota[64];
+    describir_agenda(nota, sizeof(nota), arranque, paro);
+    if (err == ESP_OK && arranque >= 0) {
+        snprintf(resp, sizeof(resp), "Barrido %.3f-%.3f Hz en GPIO %d%s", cfg.inicio_mhz / 1000.0,
+                 cfg.fin_mhz / 1000.0, cfg.gpio, nota);
+    } else if (err == ESP_OK) {
+        snprintf(resp, sizeof(resp), "Barrido %.3f-%.3f Hz en GPIO %d por %s%s", cfg.inicio_mhz / 1000.0,
+                 cfg.fin_mhz / 1000.0, cfg.gpio, backend == BARRIDO_POR_LEDC ? "LEDC" : "temporizador", nota);
+    } else {
+        snprintf(resp, sizeof(resp), "Error al iniciar barrido: %s", esp_err_to_name(err));
+    }
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t agenda_get_handler(httpd_req_t *req) {
+    char resp[80];
+    snprintf(resp, sizeof(resp), "{\"reloj_us\":%lld,\"pendientes\":%d}", (long long)agenda_ahora_us(),
+             agenda_pendientes());
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, resp);
+    return ESP_OK;
+}
+
+esp_err_t agenda_post_handler(httpd_req_t *req) {
+    char content[64];
+    int len = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (len <= 0) {
+        return ESP_FAIL;
+    }
+    content[len] = '\0';
+
+    char accion[16] = "";
+    obtener_campo(content, "accion", accion, sizeof(accion));
+    if (strcmp(accion, "cancelar") != 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Acción desconocida");
+        return ESP_OK;
+    }
+    char resp[60];
+    snprintf(resp, sizeof(resp), "%d órdenes canceladas", agenda_cancelar(NULL));
     httpd_resp_sendstr(req, resp);
     return ESP_OK;
 }
@@ -133,6 +1290,8 @@ esp_err_t root_get_handler(httpd_req_t *req) {
 
 void app_main(void) {
     ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(agenda_iniciar());
+    ESP_ERROR_CHECK(zumbador_iniciar(PLACA_ZUMBADOR));
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
 
@@ -152,6 +1311,7 @@ void app_main(void) {
 
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_uri_handlers = 20;
     httpd_start(&server, &config);
 
     httpd_uri_t root_uri = {
@@ -174,4 +1334,111 @@ void app_main(void) {
         .handler = pwm_post_handler
     };
     httpd_register_uri_handler(server, &pwm_uri);
+
+    httpd_uri_t captura_post_uri = {
+        .uri = "/captura",
+        .method = HTTP_POST,
+        .handler = captura_post_handler
+    };
+    httpd_register_uri_handler(server, &captura_post_uri);
+
+    httpd_uri_t captura_get_uri = {
+        .uri = "/captura",
+        .method = HTTP_GET,
+        .handler = captura_get_handler
+    };
+    httpd_register_uri_handler(server, &captura_get_uri);
+
+    httpd_uri_t onda_uri = {
+        .uri = "/onda",
+        .method = HTTP_POST,
+        .handler = onda_post_handler
+    };
+    httpd_register_uri_handler(server, &onda_uri);
+
+    httpd_uri_t barrido_uri = {
+        .uri = "/barrido",
+        .method = HTTP_POST,
+        .handler = barrido_post_handler
+    };
+    httpd_register_uri_handler(server, &barrido_uri);
+
+    httpd_uri_t duty_uri = {
+        .uri = "/duty",
+        .method = HTTP_POST,
+        .handler = duty_post_handler
+    };
+    httpd_register_uri_handler(server, &duty_uri);
+
+    httpd_uri_t puente_uri = {
+        .uri = "/puente",
+        .method = HTTP_POST,
+        .handler = puente_post_handler
+    };
+    httpd_register_uri_handler(server, &puente_uri);
+
+    httpd_uri_t grupo_uri = {
+        .uri = "/grupo",
+        .method = HTTP_POST,
+        .handler = grupo_post_handler
+    };
+    httpd_register_uri_handler(server, &grupo_uri);
+
+    httpd_uri_t sigma_uri = {
+        .uri = "/sigma",
+        .method = HTTP_POST,
+        .handler = sigma_post_handler
+    };
+    httpd_register_uri_handler(server, &sigma_uri);
+
+    httpd_uri_t secuencia_uri = {
+        .uri = "/secuencia",
+        .method = HTTP_POST,
+        .handler = secuencia_post_handler
+    };
+    httpd_register_uri_handler(server, &secuencia_uri);
+
+    httpd_uri_t reproducir_uri = {
+        .uri = "/reproducir",
+        .method = HTTP_POST,
+        .handler = reproducir_post_handler
+    };
+    httpd_register_uri_handler(server, &reproducir_uri);
+
+    httpd_uri_t agenda_get_uri = {
+        .uri = "/agenda",
+        .method = HTTP_GET,
+        .handler = agenda_get_handler
+    };
+    httpd_register_uri_handler(server, &agenda_get_uri);
+
+    httpd_uri_t agenda_post_uri = {
+        .uri = "/agenda",
+        .method = HTTP_POST,
+        .handler = agenda_post_handler
+    };
+    httpd_register_uri_handler(server, &agenda_post_uri);
+
+    httpd_uri_t servo_uri = {
+        .uri = "/servo",
+        .method = HTTP_POST,
+        .handler = servo_post_handler
+    };
+    httpd_register_uri_handler(server, &servo_uri);
+
+    httpd_uri_t pasos_uri = {
+        .uri = "/pasos",
+        .method = HTTP_POST,
+        .handler = pasos_post_handler
+    };
+    httpd_register_uri_handler(server, &pasos_uri);
+
+    httpd_uri_t zumbador_uri = {
+        .uri = "/zumbador",
+        .method = HTTP_POST,
+        .handler = zumbador_post_handler
+    };
+    httpd_register_uri_handler(server, &zumbador_uri);
+
+    zumbador_encolar(aviso_arranque, sizeof(aviso_arranque) / sizeof(aviso_arranque[0]), false);
 }
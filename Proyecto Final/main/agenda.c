@@ -0,0 +1,241 @@
+#include "agenda.h"
+#include <stdbool.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define TAG "AGENDA"
+#define AGENDA_VACIA -1
+// Lo que cae antes de ahora + AGENDA_HORIZONTE_US ya está en la lista fina
+#define AGENDA_HORIZONTE_US (2 * AGENDA_RANURA_US)
+
+typedef struct {
+    int64_t instante;
+    agenda_accion_t accion;
+    void *arg;
+    int8_t siguiente;
+} agenda_orden_t;
+
+static agenda_orden_t ordenes[AGENDA_MAX_ORDENES];
+static int8_t libres = AGENDA_VACIA;
+static int8_t ranuras[AGENDA_RANURAS];
+static int8_t proximas = AGENDA_VACIA;
+static int en_rueda;
+static int64_t limite;
+static esp_timer_handle_t tic;
+static esp_timer_handle_t alarma;
+static SemaphoreHandle_t mutex;
+// Tomado mientras corren las acciones sacadas de la lista; recursivo para
+// que una acción pueda cancelar órdenes
+static SemaphoreHandle_t en_curso;
+
+static int ranura_de(int64_t instante) {
+    return (int)((instante / AGENDA_RANURA_US) % AGENDA_RANURAS);
+}
+
+// Inserta detrás de las de igual instante: se respeta el orden de llegada
+static void insertar_ordenada(int8_t *lista, int8_t i) {
+    while (*lista != AGENDA_VACIA && ordenes[*lista].instante <= ordenes[i].instante) {
+        lista = &ordenes[*lista].siguiente;
+    }
+    ordenes[i].siguiente = *lista;
+    *lista = i;
+}
+
+static void liberar(int8_t i) {
+    ordenes[i].siguiente = libres;
+    libres = i;
+}
+
+static void rearmar_alarma(void) {
+    esp_timer_stop(alarma);
+    if (proximas == AGENDA_VACIA) {
+        return;
+    }
+    int64_t espera = ordenes[proximas].instante - AGENDA_ADELANTO_US - esp_timer_get_time();
+    esp_timer_start_once(alarma, espera > 0 ? espera : 0);
+}
+
+// Cada ranura mezcla vueltas distintas de la rueda: solo se sacan las
+// órdenes que ya entran en el nuevo horizonte.
+static void avanzar_rueda(int64_t ahora) {
+    int64_t nuevo = ahora + AGENDA_HORIZONTE_US;
+    int64_t vueltas = nuevo / AGENDA_RANURA_US - limite / AGENDA_RANURA_US + 1;
+    int64_t desde = limite / AGENDA_RANURA_US;
+    for (int64_t k = 0; k < vueltas && k < AGENDA_RANURAS; k++) {
+        int8_t *p = &ranuras[(desde + k) % AGENDA_RANURAS];
+        while (*p != AGENDA_VACIA) {
+            int8_t i = *p;
+            if (ordenes[i].instante < nuevo) {
+                *p = ordenes[i].siguiente;
+                insertar_ordenada(&proximas, i);
+                en_rueda--;
+            } else {
+                p = &ordenes[i].siguiente;
+            }
+        }
+    }
+    limite = nuevo;
+}
+
+static void tic_cb(void *arg) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    avanzar_rueda(esp_timer_get_time());
+    if (en_rueda == 0) {
+        esp_timer_stop(tic);
+    }
+    rearmar_alarma();
+    xSemaphoreGive(mutex);
+}
+
+// Se sacan de golpe todas las órdenes vencidas y se ejecutan fuera del
+// mutex, una tras otra: los disparos quedan a pocos µs entre sí.
+static void alarma_cb(void *arg) {
+    agenda_orden_t vencidas[AGENDA_MAX_ORDENES];
+    int n = 0;
+
+    // Si la orden que armó la alarma se canceló, la siguiente puede estar lejos
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool hay = proximas != AGENDA_VACIA;
+    int64_t objetivo = hay ? ordenes[proximas].instante : 0;
+    if (hay && objetivo - esp_timer_get_time() > AGENDA_ADELANTO_US) {
+        rearmar_alarma();
+        hay = false;
+    }
+    xSemaphoreGive(mutex);
+    if (!hay) {
+        return;
+    }
+    while (esp_timer_get_time() < objetivo) {
+    }
+
+    xSemaphoreTakeRecursive(en_curso, portMAX_DELAY);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int64_t ahora = esp_timer_get_time();
+    while (proximas != AGENDA_VACIA && ordenes[proximas].instante <= ahora) {
+        int8_t i = proximas;
+        proximas = ordenes[i].siguiente;
+        vencidas[n++] = ordenes[i];
+        liberar(i);
+    }
+    rearmar_alarma();
+    xSemaphoreGive(mutex);
+
+    for (int i = 0; i < n; i++) {
+        vencidas[i].accion(vencidas[i].arg);
+    }
+    xSemaphoreGiveRecursive(en_curso);
+}
+
+esp_err_t agenda_iniciar(void) {
+    mutex = xSemaphoreCreateMutex();
+    en_curso = xSemaphoreCreateRecursiveMutex();
+    if (mutex == NULL || en_curso == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < AGENDA_RANURAS; i++) {
+        ranuras[i] = AGENDA_VACIA;
+    }
+    for (int i = AGENDA_MAX_ORDENES - 1; i >= 0; i--) {
+        liberar(i);
+    }
+
+    esp_timer_create_args_t tic_args = {
+        .callback = tic_cb,
+        .name = "agenda_tic",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&tic_args, &tic), TAG, "temporizador de la rueda");
+    esp_timer_create_args_t alarma_args = {
+        .callback = alarma_cb,
+        .name = "agenda_alarma",
+    };
+    return esp_timer_create(&alarma_args, &alarma);
+}
+
+int64_t agenda_ahora_us(void) {
+    return esp_timer_get_time();
+}
+
+esp_err_t agenda_programar(int64_t instante_us, agenda_accion_t accion, void *arg) {
+    if (accion == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int64_t ahora = esp_timer_get_time();
+    if (instante_us < ahora) {
+        xSemaphoreGive(mutex);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (libres == AGENDA_VACIA) {
+        xSemaphoreGive(mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    int8_t i = libres;
+    libres = ordenes[i].siguiente;
+    ordenes[i] = (agenda_orden_t){ .instante = instante_us, .accion = accion, .arg = arg };
+
+    // Con la rueda vacía el tic está parado y el horizonte se quedó atrás
+    if (en_rueda == 0) {
+        esp_timer_stop(tic);
+        limite = ahora + AGENDA_HORIZONTE_US;
+    }
+    if (instante_us < limite) {
+        insertar_ordenada(&proximas, i);
+        rearmar_alarma();
+    } else {
+        ordenes[i].siguiente = ranuras[ranura_de(instante_us)];
+        ranuras[ranura_de(instante_us)] = i;
+        if (en_rueda++ == 0) {
+            esp_timer_start_periodic(tic, AGENDA_RANURA_US);
+        }
+    }
+    xSemaphoreGive(mutex);
+    return ESP_OK;
+}
+
+static int quitar_de(int8_t *lista, agenda_accion_t accion) {
+    int n = 0;
+    while (*lista != AGENDA_VACIA) {
+        int8_t i = *lista;
+        if (accion == NULL || ordenes[i].accion == accion) {
+            *lista = ordenes[i].siguiente;
+            liberar(i);
+            n++;
+        } else {
+            lista = &ordenes[i].siguiente;
+        }
+    }
+    return n;
+}
+
+int agenda_cancelar(agenda_accion_t accion) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int n = quitar_de(&proximas, accion);
+    for (int k = 0; k < AGENDA_RANURAS; k++) {
+        int quitadas = quitar_de(&ranuras[k], accion);
+        en_rueda -= quitadas;
+        n += quitadas;
+    }
+    rearmar_alarma();
+    xSemaphoreGive(mutex);
+    // Una orden ya sacada de la lista puede estar ejecutándose: se espera a
+    // que acabe para que quien cancela pueda reutilizar su argumento
+    xSemaphoreTakeRecursive(en_curso, portMAX_DELAY);
+    xSemaphoreGiveRecursive(en_curso);
+    if (n > 0) {
+        ESP_LOGI(TAG, "%d órdenes canceladas", n);
+    }
+    return n;
+}
+
+int agenda_pendientes(void) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    int n = en_rueda;
+    for (int8_t i = proximas; i != AGENDA_VACIA; i = ordenes[i].siguiente) {
+        n++;
+    }
+    xSemaphoreGive(mutex);
+    return n;
+}
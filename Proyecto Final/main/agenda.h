@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Órdenes programadas sobre el reloj monótono de esp_timer (µs desde el
+// arranque). Una rueda de ranuras guarda las lejanas; las que entran en el
+// horizonte pasan a una lista ordenada que dispara una alarma fina.
+#define AGENDA_MAX_ORDENES 32
+#define AGENDA_RANURAS 64
+#define AGENDA_RANURA_US 10000
+// La alarma fina despierta antes y espera activamente el microsegundo exacto
+#define AGENDA_ADELANTO_US 200
+
+typedef void (*agenda_accion_t)(void *arg);
+
+esp_err_t agenda_iniciar(void);
+int64_t agenda_ahora_us(void);
+
+// Las órdenes con el mismo instante se ejecutan seguidas, en el orden en que
+// se programaron, sin volver a la rueda entre una y otra. Para que salgan
+// en la misma ventana la acción solo debe disparar hardware ya armado.
+esp_err_t agenda_programar(int64_t instante_us, agenda_accion_t accion, void *arg);
+// Quita las órdenes pendientes con esa acción (todas si es NULL). Al volver
+// ya no corre ninguna acción de la agenda, así que su argumento se puede
+// reescribir.
+int agenda_cancelar(agenda_accion_t accion);
+int agenda_pendientes(void);
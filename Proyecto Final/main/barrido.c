@@ -0,0 +1,266 @@
+#include "barrido.h"
+#include <math.h>
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "dds.h"
+#include "generador_gpio.h"
+#include "recursos.h"
+
+#define TAG "BARRIDO"
+#define BARRIDO_TICKS_ACTUALIZACION (BARRIDO_RESOLUCION_HZ / 1000000 * BARRIDO_ACTUALIZACION_US)
+
+// Perfil precalculado en BARRIDO_PUNTOS segmentos: semiperiodo en ticks Q8
+// (temporizador) o divisor Q10.8 del LEDC. La ISR solo interpola con enteros.
+static uint32_t tabla[BARRIDO_PUNTOS + 1];
+static uint64_t escala;
+static uint64_t total_ticks;
+static uint64_t inicio_ciclo;
+static uint64_t transcurrido;
+static uint32_t residuo_q8;
+static uint32_t nivel;
+static uint32_t bits_ledc;
+static barrido_config_t config;
+static barrido_backend_t backend_actual;
+static gptimer_handle_t temporizador;
+static bool activo;
+
+// escala = 2^40 / total_ticks, así t * escala es la posición en segmentos
+// en Q32 sin divisiones en la ISR.
+static inline uint32_t IRAM_ATTR interpolar(uint64_t t) {
+    uint64_t pos = t * escala;
+    uint32_t i = pos >> 32;
+    if (i >= BARRIDO_PUNTOS) {
+        return tabla[BARRIDO_PUNTOS];
+    }
+    int64_t a = tabla[i];
+    int64_t b = tabla[i + 1];
+    int64_t frac = (pos >> 16) & 0xFFFF;
+    return a + (((b - a) * frac) >> 16);
+}
+
+static bool IRAM_ATTR flanco_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    uint64_t t = edata->alarm_value - inicio_ciclo;
+    if (t >= total_ticks) {
+        if (!config.repetir) {
+            gptimer_stop(timer);
+            return false;
+        }
+        inicio_ciclo = edata->alarm_value;
+        t = 0;
+    }
+
+    // El siguiente flanco se programa desde el anterior: la fase no salta
+    // al cambiar de frecuencia ni al reiniciar el barrido.
+    nivel = !nivel;
+    gpio_set_level(config.gpio, nivel);
+    if (config.gpio_sync >= 0) {
+        gpio_set_level(config.gpio_sync, t == 0);
+    }
+    uint32_t semiperiodo_q8 = interpolar(t) + residuo_q8;
+    residuo_q8 = semiperiodo_q8 & 0xFF;
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = edata->alarm_value + (semiperiodo_q8 >> 8),
+    };
+    gptimer_set_alarm_action(timer, &alarma);
+    return false;
+}
+
+// El LEDC aplica el nuevo divisor al desbordar su contador, así que el
+// cambio de frecuencia también es continuo en fase.
+static bool IRAM_ATTR actualizar_ledc_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    transcurrido += BARRIDO_TICKS_ACTUALIZACION;
+    if (transcurrido >= total_ticks) {
+        if (!config.repetir) {
+            gptimer_stop(timer);
+            return false;
+        }
+        transcurrido = 0;
+    }
+    if (config.gpio_sync >= 0) {
+        gpio_set_level(config.gpio_sync, transcurrido == 0);
+    }
+    ledc_timer_set(BARRIDO_LEDC_MODO, BARRIDO_LEDC_TIMER, interpolar(transcurrido), bits_ledc, LEDC_APB_CLK);
+    return false;
+}
+
+static uint64_t frecuencia_punto(int i) {
+    double x = (double)i / BARRIDO_PUNTOS;
+    double f0 = config.inicio_mhz;
+    double f1 = config.fin_mhz;
+    double f = config.perfil == BARRIDO_LINEAL ? f0 + (f1 - f0) * x : f0 * pow(f1 / f0, x);
+    return (uint64_t)(f + 0.5);
+}
+
+// Con la máxima resolución que admite la frecuencia más alta queda el mayor
+// margen de divisor para la más baja; si no alcanza, no se puede usar LEDC.
+static bool cabe_en_ledc(const barrido_config_t *cfg, uint32_t *bits) {
+    uint64_t fmax = cfg->inicio_mhz > cfg->fin_mhz ? cfg->inicio_mhz : cfg->fin_mhz;
+    uint64_t fmin = cfg->inicio_mhz > cfg->fin_mhz ? cfg->fin_mhz : cfg->inicio_mhz;
+    dds_ledc_t ledc;
+    if (!dds_ledc_calcular(&ledc, fmax, LEDC_RELOJ_HZ, DDS_LEDC_BITS_MAX) ||
+        dds_ledc_divisor(fmin, LEDC_RELOJ_HZ, ledc.bits) > DDS_LEDC_DIVISOR_MAX) {
+        return false;
+    }
+    *bits = ledc.bits;
+    return true;
+}
+
+static bool cabe_en_temporizador(const barrido_config_t *cfg) {
+    return cfg->inicio_mhz <= GENERADOR_GPIO_MAX_MHZ && cfg->fin_mhz <= GENERADOR_GPIO_MAX_MHZ;
+}
+
+static bool preparar_ledc(void) {
+    if (!cabe_en_ledc(&config, &bits_ledc)) {
+        return false;
+    }
+    for (int i = 0; i <= BARRIDO_PUNTOS; i++) {
+        tabla[i] = dds_ledc_divisor(frecuencia_punto(i), LEDC_RELOJ_HZ, bits_ledc);
+    }
+    return true;
+}
+
+static bool preparar_temporizador(void) {
+    if (!cabe_en_temporizador(&config)) {
+        return false;
+    }
+    for (int i = 0; i <= BARRIDO_PUNTOS; i++) {
+        tabla[i] = dds_periodo_ticks(frecuencia_punto(i), BARRIDO_RESOLUCION_HZ * 128);
+    }
+    return true;
+}
+
+static esp_err_t crear_temporizador(gptimer_alarm_cb_t isr) {
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = BARRIDO_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+    return ESP_OK;
+}
+
+static esp_err_t arrancar_ledc(void) {
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = BARRIDO_LEDC_MODO,
+        .timer_num = BARRIDO_LEDC_TIMER,
+        .duty_resolution = bits_ledc,
+        .freq_hz = config.inicio_mhz < DDS_MHZ_POR_HZ ? 1 : config.inicio_mhz / DDS_MHZ_POR_HZ,
+        .clk_cfg = LEDC_USE_APB_CLK
+    };
+    ledc_timer_config(&ledc_timer);
+    ESP_RETURN_ON_ERROR(ledc_timer_set(BARRIDO_LEDC_MODO, BARRIDO_LEDC_TIMER, tabla[0], bits_ledc, LEDC_APB_CLK),
+                        TAG, "divisor LEDC fuera de rango");
+
+    ledc_channel_config_t ledc_channel = {
+        .gpio_num = config.gpio,
+        .speed_mode = BARRIDO_LEDC_MODO,
+        .channel = BARRIDO_LEDC_CANAL,
+        .timer_sel = BARRIDO_LEDC_TIMER,
+        .duty = 1u << (bits_ledc - 1),
+        .hpoint = 0
+    };
+    ESP_RETURN_ON_ERROR(ledc_channel_config(&ledc_channel), TAG, "canal LEDC");
+
+    gptimer_alarm_config_t alarma = {
+        .reload_count = 0,
+        .alarm_count = BARRIDO_TICKS_ACTUALIZACION,
+        .flags.auto_reload_on_alarm = true,
+    };
+    transcurrido = 0;
+    return gptimer_set_alarm_action(temporizador, &alarma);
+}
+
+static esp_err_t arrancar_temporizador(void) {
+    gpio_set_direction(config.gpio, GPIO_MODE_OUTPUT);
+    nivel = 1;
+    gpio_set_level(config.gpio, nivel);
+
+    uint32_t semiperiodo_q8 = tabla[0];
+    residuo_q8 = semiperiodo_q8 & 0xFF;
+    inicio_ciclo = 0;
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = semiperiodo_q8 >> 8,
+    };
+    return gptimer_set_alarm_action(temporizador, &alarma);
+}
+
+esp_err_t barrido_validar(const barrido_config_t *cfg) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(cfg->gpio) ||
+        (cfg->gpio_sync >= 0 && (!GPIO_IS_VALID_OUTPUT_GPIO(cfg->gpio_sync) || cfg->gpio_sync == cfg->gpio)) ||
+        cfg->inicio_mhz < BARRIDO_MIN_MHZ || cfg->fin_mhz < BARRIDO_MIN_MHZ || cfg->duracion_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t bits;
+    if (!cabe_en_ledc(cfg, &bits) && !cabe_en_temporizador(cfg)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return ESP_OK;
+}
+
+esp_err_t barrido_iniciar(const barrido_config_t *cfg, barrido_backend_t *backend) {
+    esp_err_t err = barrido_validar(cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    barrido_detener();
+    config = *cfg;
+    if (preparar_ledc()) {
+        backend_actual = BARRIDO_POR_LEDC;
+    } else if (preparar_temporizador()) {
+        backend_actual = BARRIDO_POR_TEMPORIZADOR;
+    } else {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    total_ticks = (uint64_t)config.duracion_ms * (BARRIDO_RESOLUCION_HZ / 1000);
+    escala = (1ULL << 40) / total_ticks;
+
+    ESP_RETURN_ON_ERROR(crear_temporizador(backend_actual == BARRIDO_POR_LEDC ? actualizar_ledc_isr : flanco_isr),
+                        TAG, "no se pudo crear el temporizador");
+    if (config.gpio_sync >= 0) {
+        gpio_set_direction(config.gpio_sync, GPIO_MODE_OUTPUT);
+        gpio_set_level(config.gpio_sync, 1);
+    }
+
+    activo = true;
+    err = backend_actual == BARRIDO_POR_LEDC ? arrancar_ledc() : arrancar_temporizador();
+    if (err != ESP_OK) {
+        barrido_detener();
+        return err;
+    }
+    if (backend != NULL) {
+        *backend = backend_actual;
+    }
+    ESP_LOGI(TAG, "Barrido en GPIO %d por %s", config.gpio, backend_actual == BARRIDO_POR_LEDC ? "LEDC" : "temporizador");
+    return gptimer_start(temporizador);
+}
+
+esp_err_t barrido_detener(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_stop(temporizador);
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+
+    if (backend_actual == BARRIDO_POR_LEDC) {
+        ledc_stop(BARRIDO_LEDC_MODO, BARRIDO_LEDC_CANAL, 0);
+    } else {
+        gpio_set_level(config.gpio, 0);
+    }
+    if (config.gpio_sync >= 0) {
+        gpio_set_level(config.gpio_sync, 0);
+    }
+    activo = false;
+    return ESP_OK;
+}
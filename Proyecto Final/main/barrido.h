@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Barrido de frecuencia (chirp) lineal o logarítmico
+#define BARRIDO_PUNTOS 256
+#define BARRIDO_RESOLUCION_HZ 10000000
+#define BARRIDO_ACTUALIZACION_US 1000
+#define BARRIDO_MIN_MHZ (1 * 1000ULL)
+
+typedef enum {
+    BARRIDO_LINEAL,
+    BARRIDO_LOGARITMICO
+} barrido_perfil_t;
+
+typedef struct {
+    int gpio;
+    int gpio_sync;              // marcador de inicio de barrido, -1 si no se usa
+    uint64_t inicio_mhz;
+    uint64_t fin_mhz;
+    uint32_t duracion_ms;
+    barrido_perfil_t perfil;
+    bool repetir;
+} barrido_config_t;
+
+typedef enum {
+    BARRIDO_POR_LEDC,
+    BARRIDO_POR_TEMPORIZADOR
+} barrido_backend_t;
+
+// ESP_ERR_INVALID_ARG o ESP_ERR_NOT_SUPPORTED si barrido_iniciar rechazaría
+// la configuración; no toca el hardware
+esp_err_t barrido_validar(const barrido_config_t *cfg);
+// Usa el LEDC (divisor actualizado cada BARRIDO_ACTUALIZACION_US) si el
+// rango cabe en una sola resolución; si no, conmuta el GPIO flanco a flanco.
+esp_err_t barrido_iniciar(const barrido_config_t *cfg, barrido_backend_t *backend);
+esp_err_t barrido_detener(void);
@@ -0,0 +1,248 @@
+#include "captura.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "dds.h"
+
+#define TAG "CAPTURA"
+#define CAPTURA_RESOLUCION_HZ 10000000
+#define CAPTURA_MAX_LONGITUD 0xFFFFFFu
+
+// Cada registro guarda el estado de los pines en los 8 bits bajos y la
+// cantidad de muestras consecutivas con ese estado en los 24 bits altos.
+static uint32_t *registros;
+static uint32_t escritos;
+static uint32_t indice_disparo;
+static uint32_t max_pre;
+static uint32_t muestras_post;
+static uint32_t limite_muestras;
+static uint32_t longitud_actual;
+static uint8_t estado_actual;
+static volatile bool disparado;
+static volatile bool en_curso;
+static captura_config_t config;
+static gptimer_handle_t temporizador;
+static portMUX_TYPE captura_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint8_t IRAM_ATTR leer_pines(void) {
+    uint64_t entrada = ((uint64_t)REG_READ(GPIO_IN1_REG) << 32) | REG_READ(GPIO_IN_REG);
+    uint8_t estado = 0;
+    for (int i = 0; i < config.num_pines; i++) {
+        estado |= ((entrada >> config.pines[i]) & 1) << i;
+    }
+    return estado;
+}
+
+static inline void IRAM_ATTR guardar_registro(void) {
+    if (longitud_actual == 0) {
+        return;
+    }
+    registros[escritos % CAPTURA_MAX_REGISTROS] = estado_actual | (longitud_actual << 8);
+    escritos++;
+}
+
+static inline bool IRAM_ATTR hay_disparo(uint8_t anterior, uint8_t estado) {
+    uint8_t bit = 1u << config.canal_disparo;
+    switch (config.disparo) {
+        case CAPTURA_DISPARO_SUBIDA:
+            return !(anterior & bit) && (estado & bit);
+        case CAPTURA_DISPARO_BAJADA:
+            return (anterior & bit) && !(estado & bit);
+        case CAPTURA_DISPARO_PATRON:
+            return (estado & config.patron_mascara) == config.patron_valor;
+        default:
+            return true;
+    }
+}
+
+static void IRAM_ATTR cerrar_captura(void) {
+    guardar_registro();
+    en_curso = false;
+}
+
+static bool IRAM_ATTR muestrear_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    portENTER_CRITICAL_ISR(&captura_lock);
+    if (!en_curso) {
+        portEXIT_CRITICAL_ISR(&captura_lock);
+        return false;
+    }
+
+    uint8_t estado = leer_pines();
+    if (estado == estado_actual && longitud_actual < CAPTURA_MAX_LONGITUD) {
+        longitud_actual++;
+    } else {
+        uint8_t anterior = estado_actual;
+        guardar_registro();
+        estado_actual = estado;
+        longitud_actual = 1;
+        if (!disparado && estado != anterior && hay_disparo(anterior, estado)) {
+            disparado = true;
+            indice_disparo = escritos;
+        }
+    }
+
+    // Tras el disparo se limita tanto la duración como el espacio del buffer,
+    // para no sobrescribir los registros previos al disparo que se conservan.
+    if (disparado && (++muestras_post >= limite_muestras ||
+                      escritos - indice_disparo >= CAPTURA_MAX_REGISTROS - max_pre - 1)) {
+        cerrar_captura();
+        gptimer_stop(timer);
+    }
+    portEXIT_CRITICAL_ISR(&captura_lock);
+    return false;
+}
+
+static esp_err_t crear_temporizador(void) {
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = CAPTURA_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = muestrear_isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+    return ESP_OK;
+}
+
+esp_err_t captura_iniciar(const captura_config_t *cfg) {
+    if (en_curso) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cfg->num_pines < 1 || cfg->num_pines > CAPTURA_MAX_PINES ||
+        cfg->frecuencia_hz == 0 || cfg->frecuencia_hz > CAPTURA_MAX_FRECUENCIA_HZ ||
+        cfg->canal_disparo < 0 || cfg->canal_disparo >= cfg->num_pines ||
+        cfg->pre_disparo_pct > CAPTURA_MAX_PRE_DISPARO_PCT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < cfg->num_pines; i++) {
+        if (!GPIO_IS_VALID_GPIO(cfg->pines[i])) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (registros == NULL) {
+        registros = heap_caps_malloc(CAPTURA_MAX_REGISTROS * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (registros == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (temporizador == NULL) {
+        ESP_RETURN_ON_ERROR(crear_temporizador(), TAG, "no se pudo crear el temporizador");
+    }
+
+    // gpio_input_enable no toca la salida, así se pueden observar los
+    // pines que generan las otras señales de este mismo programa.
+    config = *cfg;
+    for (int i = 0; i < config.num_pines; i++) {
+        gpio_input_enable(config.pines[i]);
+    }
+
+    escritos = 0;
+    muestras_post = 0;
+    indice_disparo = 0;
+    disparado = config.disparo == CAPTURA_DISPARO_INMEDIATO;
+    max_pre = disparado ? 0 : CAPTURA_MAX_REGISTROS * config.pre_disparo_pct / 100;
+    limite_muestras = (uint64_t)config.duracion_ms * config.frecuencia_hz / 1000;
+    if (limite_muestras == 0) {
+        limite_muestras = 1;
+    }
+    estado_actual = leer_pines();
+    longitud_actual = 0;
+
+    gptimer_alarm_config_t alarm_config = {
+        .reload_count = 0,
+        .alarm_count = dds_periodo_ticks(config.frecuencia_hz * DDS_MHZ_POR_HZ, CAPTURA_RESOLUCION_HZ),
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_raw_count(temporizador, 0));
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(temporizador, &alarm_config));
+
+    en_curso = true;
+    ESP_LOGI(TAG, "Captura de %d pines a %lu Hz", config.num_pines, (unsigned long)config.frecuencia_hz);
+    return gptimer_start(temporizador);
+}
+
+esp_err_t captura_detener(void) {
+    if (temporizador == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_stop(temporizador);
+    portENTER_CRITICAL(&captura_lock);
+    if (en_curso) {
+        cerrar_captura();
+    }
+    portEXIT_CRITICAL(&captura_lock);
+
+    // Libera el temporizador para los demás modos; la captura queda en RAM
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+    return ESP_OK;
+}
+
+bool captura_en_curso(void) {
+    return en_curso;
+}
+
+static size_t poner_u32(char *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return 4;
+}
+
+esp_err_t captura_transmitir(captura_escritor_t escribir, void *ctx) {
+    if (en_curso || registros == NULL || escritos == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t inicio = escritos > CAPTURA_MAX_REGISTROS ? escritos - CAPTURA_MAX_REGISTROS : 0;
+    if (disparado && indice_disparo - inicio > max_pre) {
+        inicio = indice_disparo - max_pre;
+    }
+    uint32_t total = escritos - inicio;
+    uint32_t disparo = disparado ? indice_disparo - inicio : total;
+
+    char bloque[256];
+    size_t n = 0;
+    memcpy(bloque, "LAC1", 4);
+    n += 4;
+    n += poner_u32(bloque + n, config.frecuencia_hz);
+    bloque[n++] = config.num_pines;
+    for (int i = 0; i < config.num_pines; i++) {
+        bloque[n++] = config.pines[i];
+    }
+    n += poner_u32(bloque + n, total);
+    n += poner_u32(bloque + n, disparo);
+
+    for (uint32_t i = inicio; i < escritos; i++) {
+        uint32_t registro = registros[i % CAPTURA_MAX_REGISTROS];
+        uint32_t longitud = registro >> 8;
+        bloque[n++] = registro & 0xFF;
+        do {
+            bloque[n++] = (longitud & 0x7F) | (longitud > 0x7F ? 0x80 : 0);
+            longitud >>= 7;
+        } while (longitud);
+
+        if (n > sizeof(bloque) - 5) {
+            esp_err_t err = escribir(ctx, bloque, n);
+            if (err != ESP_OK) {
+                return err;
+            }
+            n = 0;
+        }
+    }
+    return n ? escribir(ctx, bloque, n) : ESP_OK;
+}
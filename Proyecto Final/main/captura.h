@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Analizador lógico: muestreo periódico de hasta 8 pines con compresión RLE
+#define CAPTURA_MAX_PINES 8
+#define CAPTURA_MAX_REGISTROS 8192
+#define CAPTURA_MAX_FRECUENCIA_HZ 100000
+#define CAPTURA_MAX_PRE_DISPARO_PCT 90
+
+typedef enum {
+    CAPTURA_DISPARO_INMEDIATO,
+    CAPTURA_DISPARO_SUBIDA,
+    CAPTURA_DISPARO_BAJADA,
+    CAPTURA_DISPARO_PATRON
+} captura_disparo_t;
+
+typedef struct {
+    int pines[CAPTURA_MAX_PINES];
+    int num_pines;
+    uint32_t frecuencia_hz;
+    uint32_t duracion_ms;       // tiempo capturado después del disparo
+    captura_disparo_t disparo;
+    int canal_disparo;          // índice en pines[] para disparo por flanco
+    uint8_t patron_mascara;     // bits sobre pines[] para disparo por patrón
+    uint8_t patron_valor;
+    uint8_t pre_disparo_pct;    // parte del buffer reservada antes del disparo
+} captura_config_t;
+
+typedef esp_err_t (*captura_escritor_t)(void *ctx, const char *datos, size_t len);
+
+esp_err_t captura_iniciar(const captura_config_t *cfg);
+esp_err_t captura_detener(void);
+bool captura_en_curso(void);
+
+// Envía la captura terminada en el formato binario "LAC1":
+//   "LAC1", u32 frecuencia_hz, u8 num_pines, u8 pines[num_pines],
+//   u32 num_registros, u32 registro_disparo,
+//   y por cada registro: u8 estado de los pines + longitud en muestras (LEB128)
+esp_err_t captura_transmitir(captura_escritor_t escribir, void *ctx);
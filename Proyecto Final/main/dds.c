@@ -0,0 +1,105 @@
+#include "dds.h"
+#include <math.h>
+
+#define DDS_PI 3.14159265358979323846
+
+static uint64_t dividir_redondeando(uint64_t a, uint64_t b) {
+    return (a + b / 2) / b;
+}
+
+// Negativos, NaN y lo que no cabe en 64 bits se saturan antes del cast,
+// que con ellos no estaría definido
+uint64_t dds_mhz_desde_hz(double hz) {
+    if (!(hz > 0)) {
+        return 0;
+    }
+    double mhz = hz * DDS_MHZ_POR_HZ + 0.5;
+    return mhz < 18446744073709551616.0 ? (uint64_t)mhz : UINT64_MAX;
+}
+
+// incremento = f * 2^32 / fs, por división larga en dos pasos de 16 bits
+// para no desbordar 64 bits con frecuencias en milihercios.
+uint32_t dds_incremento(uint64_t frecuencia_mhz, uint32_t muestreo_hz) {
+    uint64_t den = (uint64_t)muestreo_hz * DDS_MHZ_POR_HZ;
+    if (den == 0 || frecuencia_mhz >= den) {
+        return 0;
+    }
+    uint64_t resto = frecuencia_mhz;
+    uint64_t resultado = 0;
+    for (int i = 0; i < 2; i++) {
+        resto <<= 16;
+        resultado = (resultado << 16) | (resto / den);
+        resto %= den;
+    }
+    if (2 * resto >= den) {
+        resultado++;
+    }
+    return resultado > UINT32_MAX ? UINT32_MAX : (uint32_t)resultado;
+}
+
+uint64_t dds_frecuencia_incremento(uint32_t incremento, uint32_t muestreo_hz) {
+    uint64_t producto = (uint64_t)incremento * muestreo_hz;
+    return (producto >> 32) * DDS_MHZ_POR_HZ + (((producto & UINT32_MAX) * DDS_MHZ_POR_HZ + (1ULL << 31)) >> 32);
+}
+
+uint64_t dds_periodo_ticks(uint64_t frecuencia_mhz, uint32_t resolucion_hz) {
+    if (frecuencia_mhz == 0) {
+        return 0;
+    }
+    return dividir_redondeando((uint64_t)resolucion_hz * DDS_MHZ_POR_HZ, frecuencia_mhz);
+}
+
+uint64_t dds_frecuencia_ticks(uint64_t ticks, uint32_t resolucion_hz) {
+    if (ticks == 0) {
+        return 0;
+    }
+    return dividir_redondeando((uint64_t)resolucion_hz * DDS_MHZ_POR_HZ, ticks);
+}
+
+bool dds_flancos_iniciar(dds_flancos_t *f, uint64_t frecuencia_mhz, uint32_t resolucion_hz, uint32_t flancos_por_periodo) {
+    uint64_t num = (uint64_t)resolucion_hz * DDS_MHZ_POR_HZ;
+    f->divisor = frecuencia_mhz * flancos_por_periodo;
+    if (f->divisor == 0 || num / f->divisor == 0 || num / f->divisor > UINT32_MAX) {
+        return false;
+    }
+    f->ticks = num / f->divisor;
+    f->resto = num % f->divisor;
+    f->acumulado = 0;
+    return true;
+}
+
+uint32_t dds_ledc_divisor(uint64_t frecuencia_mhz, uint32_t reloj_hz, uint32_t bits) {
+    if (frecuencia_mhz > (UINT64_MAX >> bits)) {
+        return 0;
+    }
+    uint64_t div = dividir_redondeando((uint64_t)reloj_hz * 256 * DDS_MHZ_POR_HZ, frecuencia_mhz << bits);
+    return div > UINT32_MAX ? UINT32_MAX : (uint32_t)div;
+}
+
+// Parte de la resolución preferida y la ajusta hasta que el divisor
+// fraccionario del LEDC quede dentro de su rango.
+bool dds_ledc_calcular(dds_ledc_t *l, uint64_t frecuencia_mhz, uint32_t reloj_hz, uint32_t bits_preferidos) {
+    if (frecuencia_mhz == 0) {
+        return false;
+    }
+    l->bits = bits_preferidos;
+    l->divisor_q8 = dds_ledc_divisor(frecuencia_mhz, reloj_hz, l->bits);
+    while (l->divisor_q8 < DDS_LEDC_DIVISOR_MIN && l->bits > 1) {
+        l->divisor_q8 = dds_ledc_divisor(frecuencia_mhz, reloj_hz, --l->bits);
+    }
+    while (l->divisor_q8 > DDS_LEDC_DIVISOR_MAX && l->bits < DDS_LEDC_BITS_MAX) {
+        l->divisor_q8 = dds_ledc_divisor(frecuencia_mhz, reloj_hz, ++l->bits);
+    }
+    return l->divisor_q8 >= DDS_LEDC_DIVISOR_MIN && l->divisor_q8 <= DDS_LEDC_DIVISOR_MAX;
+}
+
+uint64_t dds_ledc_frecuencia(const dds_ledc_t *l, uint32_t reloj_hz) {
+    return dividir_redondeando((uint64_t)reloj_hz * 256 * DDS_MHZ_POR_HZ, (uint64_t)l->divisor_q8 << l->bits);
+}
+
+void dds_tabla_seno(int16_t *tabla, unsigned bits) {
+    uint32_t n = 1u << bits;
+    for (uint32_t i = 0; i < n; i++) {
+        tabla[i] = (int16_t)lround(32767.0 * sin(2.0 * DDS_PI * i / n));
+    }
+}
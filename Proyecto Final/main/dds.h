@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Núcleo de síntesis digital directa (DDS) y aritmética de ticks común a
+// todos los generadores. Las frecuencias van en milihercios y los tiempos en
+// ticks enteros del periférico; no depende de ESP-IDF, compila en el host.
+
+#define DDS_MHZ_POR_HZ 1000ULL
+
+// Acumulador de fase de 32 bits: una vuelta completa son 2^32
+typedef struct {
+    uint32_t fase;
+    uint32_t incremento;
+} dds_t;
+
+// Generador de flancos: reparte el residuo de la división entre los
+// flancos (Bresenham) para que el periodo medio sea exacto.
+typedef struct {
+    uint32_t ticks;
+    uint64_t resto;
+    uint64_t divisor;
+    uint64_t acumulado;
+} dds_flancos_t;
+
+// Configuración de un temporizador LEDC: divisor en Q10.8 y bits de duty
+typedef struct {
+    uint32_t divisor_q8;
+    uint32_t bits;
+} dds_ledc_t;
+
+#define DDS_LEDC_DIVISOR_MIN 0x100u
+#define DDS_LEDC_DIVISOR_MAX 0x3FFFFu
+#define DDS_LEDC_BITS_MAX 20
+
+uint64_t dds_mhz_desde_hz(double hz);
+uint32_t dds_incremento(uint64_t frecuencia_mhz, uint32_t muestreo_hz);
+uint64_t dds_frecuencia_incremento(uint32_t incremento, uint32_t muestreo_hz);
+uint64_t dds_periodo_ticks(uint64_t frecuencia_mhz, uint32_t resolucion_hz);
+uint64_t dds_frecuencia_ticks(uint64_t ticks, uint32_t resolucion_hz);
+bool dds_flancos_iniciar(dds_flancos_t *f, uint64_t frecuencia_mhz, uint32_t resolucion_hz, uint32_t flancos_por_periodo);
+uint32_t dds_ledc_divisor(uint64_t frecuencia_mhz, uint32_t reloj_hz, uint32_t bits);
+bool dds_ledc_calcular(dds_ledc_t *l, uint64_t frecuencia_mhz, uint32_t reloj_hz, uint32_t bits_preferidos);
+uint64_t dds_ledc_frecuencia(const dds_ledc_t *l, uint32_t reloj_hz);
+
+// Tabla de seno en Q15 con 2^bits entradas, indexada con dds_indice
+void dds_tabla_seno(int16_t *tabla, unsigned bits);
+
+static inline void dds_iniciar(dds_t *d, uint64_t frecuencia_mhz, uint32_t muestreo_hz) {
+    d->fase = 0;
+    d->incremento = dds_incremento(frecuencia_mhz, muestreo_hz);
+}
+
+// Devuelve la fase actual y avanza una muestra; solo suma entera (apto ISR)
+static inline uint32_t dds_avanzar(dds_t *d) {
+    uint32_t fase = d->fase;
+    d->fase += d->incremento;
+    return fase;
+}
+
+static inline uint32_t dds_indice(uint32_t fase, unsigned bits) {
+    return fase >> (32 - bits);
+}
+
+// Ticks hasta el siguiente flanco; solo sumas y comparaciones (apto ISR)
+static inline uint32_t dds_flancos_siguiente(dds_flancos_t *f) {
+    uint32_t ticks = f->ticks;
+    f->acumulado += f->resto;
+    if (f->acumulado >= f->divisor) {
+        f->acumulado -= f->divisor;
+        ticks++;
+    }
+    return ticks;
+}
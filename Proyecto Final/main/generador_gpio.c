@@ -0,0 +1,102 @@
+#include "generador_gpio.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "dds.h"
+#include "planificador.h"
+
+#define TAG "GENERADOR_GPIO"
+
+_Static_assert(GENERADOR_GPIO_MAX_MHZ == PLAN_TEMPORIZADOR_MAX_MHZ &&
+               GENERADOR_GPIO_RESOLUCION_HZ == PLAN_TEMPORIZADOR_RESOLUCION_HZ,
+               "el planificador debe conocer los límites del generador");
+
+static gptimer_handle_t temporizador;
+static dds_flancos_t flancos;
+static int pin = -1;
+static uint32_t nivel;
+static bool activo;
+
+// Cada alarma se programa relativa a la anterior, sin recarga, para que el
+// residuo repartido por dds_flancos no se pierda y el periodo medio sea exacto.
+static bool IRAM_ATTR flanco_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    nivel = !nivel;
+    gpio_set_level(pin, nivel);
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = edata->alarm_value + dds_flancos_siguiente(&flancos),
+    };
+    gptimer_set_alarm_action(timer, &alarma);
+    return false;
+}
+
+static esp_err_t crear_temporizador(void) {
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = GENERADOR_GPIO_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = flanco_isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+    return ESP_OK;
+}
+
+esp_err_t generador_gpio_iniciar(int gpio, uint64_t frecuencia_mhz) {
+    ESP_RETURN_ON_ERROR(generador_gpio_armar(gpio, frecuencia_mhz), TAG, "armar");
+    return generador_gpio_disparar();
+}
+
+esp_err_t generador_gpio_armar(int gpio, uint64_t frecuencia_mhz) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio) || frecuencia_mhz > GENERADOR_GPIO_MAX_MHZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dds_flancos_t nuevos;
+    if (!dds_flancos_iniciar(&nuevos, frecuencia_mhz, GENERADOR_GPIO_RESOLUCION_HZ, 2)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    generador_gpio_detener();
+    ESP_RETURN_ON_ERROR(crear_temporizador(), TAG, "no se pudo crear el temporizador");
+
+    flancos = nuevos;
+    pin = gpio;
+    nivel = 1;
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+    gpio_set_level(pin, 0);
+
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = dds_flancos_siguiente(&flancos),
+    };
+    ESP_ERROR_CHECK(gptimer_set_raw_count(temporizador, 0));
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(temporizador, &alarma));
+    activo = true;
+    ESP_LOGI(TAG, "GPIO %d: semiperiodo %lu ticks", pin, (unsigned long)flancos.ticks);
+    return ESP_OK;
+}
+
+esp_err_t generador_gpio_disparar(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gpio_set_level(pin, nivel);
+    return gptimer_start(temporizador);
+}
+
+esp_err_t generador_gpio_detener(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_stop(temporizador);
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+    gpio_set_level(pin, 0);
+    activo = false;
+    return ESP_OK;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Onda cuadrada por GPIO conmutada desde la alarma de un GPTimer
+#define GENERADOR_GPIO_RESOLUCION_HZ 10000000
+#define GENERADOR_GPIO_MAX_MHZ (20000 * 1000ULL)
+
+esp_err_t generador_gpio_iniciar(int gpio, uint64_t frecuencia_mhz);
+// Armar deja el temporizador listo y el pin en bajo; disparar solo lo pone
+// en marcha, así el primer flanco sale cuando lo pide la agenda.
+esp_err_t generador_gpio_armar(int gpio, uint64_t frecuencia_mhz);
+esp_err_t generador_gpio_disparar(void);
+esp_err_t generador_gpio_detener(void);
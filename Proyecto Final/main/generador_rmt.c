@@ -0,0 +1,94 @@
+#include "generador_rmt.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+#include "dds.h"
+#include "planificador.h"
+
+#define TAG "GENERADOR_RMT"
+#define GENERADOR_RMT_SIMBOLOS 64
+
+static rmt_channel_handle_t canal;
+static rmt_encoder_handle_t codificador;
+// El RMT lee el símbolo mientras dura el bucle: no puede vivir en la pila
+static rmt_symbol_word_t simbolo;
+static int pin = -1;
+static bool transmitiendo;
+
+static esp_err_t crear_canal(int gpio, uint32_t resolucion_hz) {
+    rmt_tx_channel_config_t canal_config = {
+        .gpio_num = gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = resolucion_hz,
+        .mem_block_symbols = GENERADOR_RMT_SIMBOLOS,
+        .trans_queue_depth = 1,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&canal_config, &canal), TAG, "sin canal RMT libre");
+    rmt_copy_encoder_config_t codificador_config = {};
+    ESP_RETURN_ON_ERROR(rmt_new_copy_encoder(&codificador_config, &codificador), TAG, "codificador");
+    return rmt_enable(canal);
+}
+
+esp_err_t generador_rmt_iniciar(int gpio, uint64_t frecuencia_mhz, uint64_t *real_mhz) {
+    ESP_RETURN_ON_ERROR(generador_rmt_armar(gpio, frecuencia_mhz, real_mhz), TAG, "armar");
+    return generador_rmt_disparar();
+}
+
+esp_err_t generador_rmt_armar(int gpio, uint64_t frecuencia_mhz, uint64_t *real_mhz) {
+    uint32_t resolucion_hz, periodo;
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio) || !plan_rmt_calcular(frecuencia_mhz, &resolucion_hz, &periodo)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    generador_rmt_detener();
+
+    esp_err_t err = crear_canal(gpio, resolucion_hz);
+    if (err != ESP_OK) {
+        pin = gpio;
+        generador_rmt_detener();
+        return err;
+    }
+    pin = gpio;
+    simbolo = (rmt_symbol_word_t){
+        .level0 = 1,
+        .duration0 = periodo / 2,
+        .level1 = 0,
+        .duration1 = periodo - periodo / 2,
+    };
+    if (real_mhz != NULL) {
+        *real_mhz = dds_frecuencia_ticks(periodo, resolucion_hz);
+    }
+    ESP_LOGI(TAG, "GPIO %d: periodo %lu ticks de %lu Hz", gpio, (unsigned long)periodo, (unsigned long)resolucion_hz);
+    return ESP_OK;
+}
+
+esp_err_t generador_rmt_disparar(void) {
+    if (canal == NULL || transmitiendo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    rmt_transmit_config_t transmision = {
+        .loop_count = -1,
+    };
+    ESP_RETURN_ON_ERROR(rmt_transmit(canal, codificador, &simbolo, sizeof(simbolo), &transmision), TAG, "transmitir");
+    transmitiendo = true;
+    return ESP_OK;
+}
+
+esp_err_t generador_rmt_detener(void) {
+    if (pin < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (canal != NULL) {
+        rmt_disable(canal);
+        rmt_del_channel(canal);
+        canal = NULL;
+    }
+    if (codificador != NULL) {
+        rmt_del_encoder(codificador);
+        codificador = NULL;
+    }
+    gpio_set_level(pin, 0);
+    pin = -1;
+    transmitiendo = false;
+    return ESP_OK;
+}
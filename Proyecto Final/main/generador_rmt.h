@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Onda cuadrada por RMT: un solo símbolo repetido sin fin por hardware, con
+// flancos exactos al tick y sin interrupciones.
+esp_err_t generador_rmt_iniciar(int gpio, uint64_t frecuencia_mhz, uint64_t *real_mhz);
+esp_err_t generador_rmt_detener(void);
+// Armar crea y habilita el canal con el pin en reposo; disparar lanza el
+// bucle del símbolo.
+esp_err_t generador_rmt_armar(int gpio, uint64_t frecuencia_mhz, uint64_t *real_mhz);
+esp_err_t generador_rmt_disparar(void);
@@ -0,0 +1,137 @@
+#include "grupo_pwm.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "dds.h"
+#include "recursos.h"
+
+#define TAG "GRUPO"
+
+static grupo_config_t config;
+static dds_ledc_t ledc_actual;
+static bool activo;
+
+static uint32_t duty_cuentas(uint16_t permil, uint32_t bits) {
+    return (uint32_t)(((uint64_t)permil << bits) / 1000);
+}
+
+// El pulso empieza en hpoint y dura 'duty' cuentas, así que el desfase es
+// una fracción del periodo expresada en cuentas del contador.
+static uint32_t hpoint_cuentas(uint16_t grados, uint32_t bits) {
+    return (uint32_t)((((uint64_t)grados << bits) / 360) & ((1u << bits) - 1));
+}
+
+static esp_err_t programar_canales(void) {
+    for (int i = 0; i < config.num_canales; i++) {
+        ledc_channel_t canal = GRUPO_LEDC_PRIMER_CANAL + i;
+        ESP_RETURN_ON_ERROR(ledc_set_duty_with_hpoint(GRUPO_LEDC_MODO, canal,
+                            duty_cuentas(config.canales[i].duty_permil, ledc_actual.bits),
+                            hpoint_cuentas(config.canales[i].fase_grados, ledc_actual.bits)),
+                            TAG, "duty del canal %d", i);
+        ESP_RETURN_ON_ERROR(ledc_update_duty(GRUPO_LEDC_MODO, canal), TAG, "actualizar canal %d", i);
+    }
+    return ESP_OK;
+}
+
+// Con el contador detenido en cero, los nuevos valores quedan cargados antes
+// del primer ciclo y todos los canales arrancan en el mismo tick.
+static esp_err_t reanudar_alineado(void) {
+    ESP_RETURN_ON_ERROR(ledc_timer_rst(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER), TAG, "reiniciar contador");
+    return ledc_timer_resume(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER);
+}
+
+esp_err_t grupo_iniciar(const grupo_config_t *cfg, uint64_t *real_mhz) {
+    ESP_RETURN_ON_ERROR(grupo_armar(cfg, real_mhz), TAG, "armar");
+    return grupo_disparar();
+}
+
+esp_err_t grupo_armar(const grupo_config_t *cfg, uint64_t *real_mhz) {
+    dds_ledc_t ledc;
+    if (cfg->num_canales < 1 || cfg->num_canales > GRUPO_MAX_CANALES ||
+        !dds_ledc_calcular(&ledc, cfg->frecuencia_mhz, LEDC_RELOJ_HZ, DDS_LEDC_BITS_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < cfg->num_canales; i++) {
+        if (!GPIO_IS_VALID_OUTPUT_GPIO(cfg->canales[i].gpio) || cfg->canales[i].duty_permil > 1000) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    grupo_detener();
+
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = GRUPO_LEDC_MODO,
+        .timer_num = GRUPO_LEDC_TIMER,
+        .duty_resolution = ledc.bits,
+        .freq_hz = cfg->frecuencia_mhz < DDS_MHZ_POR_HZ ? 1 : (uint32_t)((cfg->frecuencia_mhz + DDS_MHZ_POR_HZ / 2) / DDS_MHZ_POR_HZ),
+        .clk_cfg = LEDC_USE_APB_CLK
+    };
+    ledc_timer_config(&ledc_timer);
+    ESP_RETURN_ON_ERROR(ledc_timer_pause(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER), TAG, "pausar");
+    ESP_RETURN_ON_ERROR(ledc_timer_set(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER, ledc.divisor_q8, ledc.bits, LEDC_APB_CLK),
+                        TAG, "divisor LEDC fuera de rango");
+
+    config = *cfg;
+    ledc_actual = ledc;
+    for (int i = 0; i < config.num_canales; i++) {
+        ledc_channel_config_t ledc_channel = {
+            .gpio_num = config.canales[i].gpio,
+            .speed_mode = GRUPO_LEDC_MODO,
+            .channel = GRUPO_LEDC_PRIMER_CANAL + i,
+            .timer_sel = GRUPO_LEDC_TIMER,
+            .duty = duty_cuentas(config.canales[i].duty_permil, ledc.bits),
+            .hpoint = hpoint_cuentas(config.canales[i].fase_grados, ledc.bits)
+        };
+        ESP_RETURN_ON_ERROR(ledc_channel_config(&ledc_channel), TAG, "canal %d", i);
+    }
+    ESP_RETURN_ON_ERROR(ledc_timer_rst(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER), TAG, "reiniciar contador");
+    activo = true;
+    if (real_mhz != NULL) {
+        *real_mhz = dds_ledc_frecuencia(&ledc, LEDC_RELOJ_HZ);
+    }
+    ESP_LOGI(TAG, "Grupo de %d canales con %lu bits", config.num_canales, (unsigned long)ledc.bits);
+    return ESP_OK;
+}
+
+esp_err_t grupo_disparar(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ledc_timer_resume(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER);
+}
+
+// Duty y fase se guardan como fracciones, así que sobreviven a un cambio en
+// los bits de resolución.
+esp_err_t grupo_resintonizar(uint64_t frecuencia_mhz, uint64_t *real_mhz) {
+    dds_ledc_t ledc;
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!dds_ledc_calcular(&ledc, frecuencia_mhz, LEDC_RELOJ_HZ, DDS_LEDC_BITS_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_RETURN_ON_ERROR(ledc_timer_pause(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER), TAG, "pausar");
+    ESP_RETURN_ON_ERROR(ledc_timer_set(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER, ledc.divisor_q8, ledc.bits, LEDC_APB_CLK),
+                        TAG, "divisor LEDC fuera de rango");
+    config.frecuencia_mhz = frecuencia_mhz;
+    ledc_actual = ledc;
+    ESP_RETURN_ON_ERROR(programar_canales(), TAG, "canales");
+    ESP_RETURN_ON_ERROR(reanudar_alineado(), TAG, "reanudar");
+    if (real_mhz != NULL) {
+        *real_mhz = dds_ledc_frecuencia(&ledc, LEDC_RELOJ_HZ);
+    }
+    return ESP_OK;
+}
+
+// Al pausar el contador ya no hay más flancos; después cada canal pasa a
+// su nivel de reposo.
+esp_err_t grupo_detener(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ledc_timer_pause(GRUPO_LEDC_MODO, GRUPO_LEDC_TIMER);
+    for (int i = 0; i < config.num_canales; i++) {
+        ledc_stop(GRUPO_LEDC_MODO, GRUPO_LEDC_PRIMER_CANAL + i, 0);
+    }
+    activo = false;
+    return ESP_OK;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Grupo de salidas PWM sobre un mismo temporizador LEDC: todas comparten
+// contador, así que el desfase entre canales lo fija solo su hpoint.
+#define GRUPO_MAX_CANALES 6
+
+typedef struct {
+    int gpio;
+    uint16_t duty_permil;
+    uint16_t fase_grados;
+} grupo_canal_t;
+
+typedef struct {
+    uint64_t frecuencia_mhz;
+    int num_canales;
+    grupo_canal_t canales[GRUPO_MAX_CANALES];
+} grupo_config_t;
+
+// Arranque, paro y cambio de frecuencia se hacen con el contador pausado y
+// puesto a cero: ningún canal corre antes que los demás.
+esp_err_t grupo_iniciar(const grupo_config_t *cfg, uint64_t *real_mhz);
+// Armar deja todos los canales cargados con el contador quieto en cero;
+// disparar solo lo reanuda.
+esp_err_t grupo_armar(const grupo_config_t *cfg, uint64_t *real_mhz);
+esp_err_t grupo_disparar(void);
+esp_err_t grupo_resintonizar(uint64_t frecuencia_mhz, uint64_t *real_mhz);
+esp_err_t grupo_detener(void);
@@ -0,0 +1,127 @@
+#include "melodia.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+static unsigned leer_numero(const char **p) {
+    unsigned n = 0;
+    while (isdigit((unsigned char)**p) && n < 1000) {
+        n = n * 10 + (unsigned)(*(*p)++ - '0');
+    }
+    return n;
+}
+
+static void saltar_espacios(const char **p) {
+    while (isspace((unsigned char)**p)) {
+        (*p)++;
+    }
+}
+
+// "d=4,o=5,b=120" hasta el segundo ':'
+static bool leer_cabecera(const char **p, unsigned *d, unsigned *o, unsigned *b) {
+    while (**p != ':') {
+        saltar_espacios(p);
+        char clave = (char)tolower((unsigned char)**p);
+        if (clave == ':') {
+            break;
+        }
+        (*p)++;
+        saltar_espacios(p);
+        if (*(*p)++ != '=') {
+            return false;
+        }
+        saltar_espacios(p);
+        unsigned valor = leer_numero(p);
+        if (clave == 'd') *d = valor;
+        else if (clave == 'o') *o = valor;
+        else if (clave == 'b') *b = valor;
+        else return false;
+        saltar_espacios(p);
+        if (**p == ',') {
+            (*p)++;
+        } else if (**p != ':') {
+            return false;
+        }
+    }
+    (*p)++;
+    return true;
+}
+
+int melodia_rtttl(const char *texto, melodia_nota_t *notas, int max_notas) {
+    // Semitonos desde Do de a, b, c, d, e, f, g
+    static const int8_t semitonos[] = { 9, 11, 0, 2, 4, 5, 7 };
+    unsigned d = 4, o = 6, b = 63;
+    const char *p = texto;
+
+    const char *primero = strchr(texto, ':');
+    if (primero != NULL) {
+        p = primero + 1;
+        if (strchr(p, ':') != NULL && !leer_cabecera(&p, &d, &o, &b)) {
+            return -1;
+        }
+    }
+    if (b == 0 || d == 0) {
+        return -1;
+    }
+
+    int n = 0;
+    for (;;) {
+        saltar_espacios(&p);
+        if (*p == '\0') {
+            return n;
+        }
+        unsigned duracion = leer_numero(&p);
+        if (duracion == 0) {
+            duracion = d;
+        }
+        char letra = (char)tolower((unsigned char)*p++);
+        int semitono;
+        if (letra == 'p') {
+            semitono = -1;
+        } else if (letra >= 'a' && letra <= 'g') {
+            semitono = semitonos[letra - 'a'];
+        } else if (letra == 'h') {
+            semitono = 11;
+        } else {
+            return -1;
+        }
+        if (*p == '#' || *p == '_') {
+            semitono++;
+            p++;
+        }
+        bool puntillo = false;
+        if (*p == '.') {
+            puntillo = true;
+            p++;
+        }
+        unsigned octava = isdigit((unsigned char)*p) ? (unsigned)(*p++ - '0') : o;
+        if (*p == '.') {
+            puntillo = true;
+            p++;
+        }
+        saltar_espacios(&p);
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0') {
+            return -1;
+        }
+
+        // Una redonda dura cuatro pulsos de 60000 / b ms
+        unsigned long ms = 240000ul / ((unsigned long)b * duracion);
+        if (puntillo) {
+            ms += ms / 2;
+        }
+        int midi = 12 * ((int)octava + 1) + semitono;
+        if (n >= max_notas || ms == 0 || ms > UINT16_MAX || (semitono >= 0 && midi >= MELODIA_NOTAS_MIDI)) {
+            return -1;
+        }
+        notas[n].nota = semitono < 0 ? MELODIA_SILENCIO : (uint8_t)midi;
+        notas[n].duracion_ms = (uint16_t)ms;
+        n++;
+    }
+}
+
+uint64_t melodia_frecuencia_mhz(uint8_t nota) {
+    return (uint64_t)llround(440000.0 * pow(2.0, (nota - 69) / 12.0));
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+// Melodías compactas: cada nota es un número MIDI (69 = La 440 Hz) y una
+// duración en ms, 4 bytes por nota. Se escriben en RTTTL, el formato de los
+// tonos de llamada: "nombre:d=4,o=5,b=120:8c6,8p,e,g.,2c7". No depende de
+// ESP-IDF.
+
+#define MELODIA_SILENCIO 0xFF
+#define MELODIA_NOTAS_MIDI 128
+
+typedef struct {
+    uint8_t nota;                   // MIDI 0-127 o MELODIA_SILENCIO
+    uint16_t duracion_ms;
+} melodia_nota_t;
+
+// Devuelve el número de notas, o -1 si el texto no es válido o no cabe en
+// max_notas. Sin cabecera se toman los valores por defecto d=4, o=6, b=63.
+int melodia_rtttl(const char *texto, melodia_nota_t *notas, int max_notas);
+// Afinación temperada sobre La 440 Hz
+uint64_t melodia_frecuencia_mhz(uint8_t nota);
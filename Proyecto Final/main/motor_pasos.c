@@ -0,0 +1,147 @@
+#include "motor_pasos.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "rampa_pasos.h"
+
+#define TAG "MOTOR_PASOS"
+
+static gptimer_handle_t temporizador;
+static rampa_t rampa;
+static int pin_paso = -1;
+static int pin_dir = -1;
+static volatile int32_t posicion_actual;
+static int32_t posicion_destino;
+static int32_t sentido;
+static volatile bool moviendo;
+static portMUX_TYPE pasos_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// El pulso sube al entrar y baja tras calcular el siguiente intervalo; la
+// espera solo completa el ancho mínimo. Las alarmas van relativas a la
+// anterior para que el residuo de la rampa no se pierda.
+static bool IRAM_ATTR paso_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    gpio_set_level(pin_paso, 1);
+    posicion_actual += sentido;
+    portENTER_CRITICAL_ISR(&pasos_lock);
+    uint32_t intervalo = rampa_siguiente(&rampa);
+    portEXIT_CRITICAL_ISR(&pasos_lock);
+    if (intervalo == 0) {
+        gptimer_stop(timer);
+        moviendo = false;
+    } else {
+        gptimer_alarm_config_t alarma = {
+            .alarm_count = edata->alarm_value + intervalo,
+        };
+        gptimer_set_alarm_action(timer, &alarma);
+    }
+    esp_rom_delay_us(MOTOR_PASOS_ANCHO_US);
+    gpio_set_level(pin_paso, 0);
+    return false;
+}
+
+esp_err_t motor_pasos_conectar(int gpio_paso, int gpio_dir) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio_paso) || !GPIO_IS_VALID_OUTPUT_GPIO(gpio_dir) || gpio_paso == gpio_dir) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    motor_pasos_detener();
+
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = MOTOR_PASOS_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = paso_isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+
+    pin_paso = gpio_paso;
+    pin_dir = gpio_dir;
+    gpio_set_direction(pin_paso, GPIO_MODE_OUTPUT);
+    gpio_set_direction(pin_dir, GPIO_MODE_OUTPUT);
+    gpio_set_level(pin_paso, 0);
+    gpio_set_level(pin_dir, 0);
+    posicion_actual = 0;
+    posicion_destino = 0;
+    ESP_LOGI(TAG, "Paso en GPIO %d, dirección en GPIO %d", pin_paso, pin_dir);
+    return ESP_OK;
+}
+
+esp_err_t motor_pasos_mover_a(int32_t posicion, uint32_t vel_pps, uint32_t acel_pps2) {
+    if (temporizador == NULL || moviendo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (vel_pps > MOTOR_PASOS_MAX_PPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t distancia = (int64_t)posicion - posicion_actual;
+    if (distancia == 0) {
+        return ESP_OK;
+    }
+    uint32_t pasos = (uint32_t)(distancia > 0 ? distancia : -distancia);
+    if (!rampa_planificar(&rampa, pasos, vel_pps, acel_pps2, MOTOR_PASOS_RESOLUCION_HZ)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // La dirección se fija antes del primer paso; el primer intervalo de la
+    // rampa cubre de sobra el tiempo de preparación del driver.
+    sentido = distancia > 0 ? 1 : -1;
+    gpio_set_level(pin_dir, distancia > 0);
+    posicion_destino = posicion;
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = rampa_siguiente(&rampa),
+    };
+    ESP_ERROR_CHECK(gptimer_set_raw_count(temporizador, 0));
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(temporizador, &alarma));
+    moviendo = true;
+    ESP_LOGI(TAG, "%lu pasos hacia %ld", (unsigned long)pasos, (long)posicion);
+    return gptimer_start(temporizador);
+}
+
+esp_err_t motor_pasos_frenar(void) {
+    if (!moviendo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&pasos_lock);
+    rampa_frenar(&rampa);
+    portEXIT_CRITICAL(&pasos_lock);
+    return ESP_OK;
+}
+
+esp_err_t motor_pasos_estado(int32_t *posicion, int32_t *destino, bool *en_marcha) {
+    if (temporizador == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *posicion = posicion_actual;
+    *destino = posicion_destino;
+    *en_marcha = moviendo;
+    return ESP_OK;
+}
+
+esp_err_t motor_pasos_fijar_posicion(int32_t posicion) {
+    if (temporizador == NULL || moviendo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    posicion_actual = posicion;
+    posicion_destino = posicion;
+    return ESP_OK;
+}
+
+esp_err_t motor_pasos_detener(void) {
+    if (temporizador == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_stop(temporizador);
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+    moviendo = false;
+    gpio_set_level(pin_paso, 0);
+    return ESP_OK;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Motor paso a paso con driver de paso y dirección (A4988, DRV8825...).
+// Cada alarma del temporizador da un pulso en PASO y calcula el intervalo
+// hasta el siguiente con la rampa precalculada en rampa_pasos.
+#define MOTOR_PASOS_RESOLUCION_HZ 10000000
+#define MOTOR_PASOS_MAX_PPS 50000
+// Ancho mínimo del pulso de paso que piden los drivers habituales
+#define MOTOR_PASOS_ANCHO_US 2
+
+esp_err_t motor_pasos_conectar(int gpio_paso, int gpio_dir);
+// Falla con ESP_ERR_INVALID_STATE si el motor sigue en marcha
+esp_err_t motor_pasos_mover_a(int32_t posicion, uint32_t vel_pps, uint32_t acel_pps2);
+// Frena con la misma aceleración; la posición final queda antes del destino
+esp_err_t motor_pasos_frenar(void);
+esp_err_t motor_pasos_estado(int32_t *posicion, int32_t *destino, bool *en_marcha);
+// Solo con el motor parado, p. ej. tras llegar al final de carrera
+esp_err_t motor_pasos_fijar_posicion(int32_t posicion);
+// Parada inmediata sin rampa; libera el temporizador
+esp_err_t motor_pasos_detener(void);
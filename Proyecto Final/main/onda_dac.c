@@ -0,0 +1,119 @@
+#include "onda_dac.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/dac_continuous.h"
+#include "dds.h"
+
+#define TAG "ONDA_DAC"
+#define ONDA_DAC_TAMANO_TABLA (1 << ONDA_DAC_BITS_TABLA)
+
+// Tablas en Q15 con signo; la amplitud y el offset se aplican al sacar
+// cada muestra, así cambiarlos no obliga a recalcular nada.
+static int16_t tablas[ONDA_NUM_FORMAS][ONDA_DAC_TAMANO_TABLA];
+static bool tablas_listas;
+
+static dac_continuous_handle_t dac;
+static int canal_actual = -1;
+static uint8_t muestras[ONDA_DAC_TAMANO_BUFFER];
+
+// Los 8 bits altos de la fase del oscilador indexan la tabla
+static dds_t oscilador;
+static const int16_t *volatile tabla_actual;
+static volatile int32_t amplitud;
+static volatile int32_t offset;
+
+static void generar_tablas(void) {
+    dds_tabla_seno(tablas[ONDA_SENO], ONDA_DAC_BITS_TABLA);
+    for (int i = 0; i < ONDA_DAC_TAMANO_TABLA; i++) {
+        int32_t q = (int32_t)i * 65536 / ONDA_DAC_TAMANO_TABLA;
+        tablas[ONDA_SIERRA][i] = q == 0 ? -32767 : q - 32768;
+        tablas[ONDA_TRIANGULAR][i] = q < 32768 ? 2 * q - 32767 : 32767 - 2 * (q - 32768);
+    }
+    tablas_listas = true;
+}
+
+static void IRAM_ATTR llenar_muestras(size_t n) {
+    const int16_t *tabla = tabla_actual;
+    int32_t amp = amplitud;
+    int32_t off = offset;
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = off + ((tabla[dds_indice(dds_avanzar(&oscilador), ONDA_DAC_BITS_TABLA)] * amp) >> 15);
+        muestras[i] = v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+}
+
+static bool IRAM_ATTR dac_convertido_isr(dac_continuous_handle_t handle, const dac_event_data_t *event, void *user_data) {
+    size_t n = event->buf_size < sizeof(muestras) ? event->buf_size : sizeof(muestras);
+    size_t cargados;
+    llenar_muestras(n);
+    dac_continuous_write_asynchronously(handle, event->buf, event->buf_size, muestras, n, &cargados);
+    return false;
+}
+
+static esp_err_t crear_dac(int canal) {
+    dac_continuous_config_t cfg = {
+        .chan_mask = canal == 0 ? DAC_CHANNEL_MASK_CH0 : DAC_CHANNEL_MASK_CH1,
+        .desc_num = ONDA_DAC_DESCRIPTORES,
+        .buf_size = ONDA_DAC_TAMANO_BUFFER,
+        .freq_hz = ONDA_DAC_FRECUENCIA_MUESTREO,
+        .offset = 0,
+        .clk_src = DAC_DIGI_CLK_SRC_DEFAULT,
+        .chan_mode = DAC_CHANNEL_MODE_SIMUL,
+    };
+    ESP_RETURN_ON_ERROR(dac_continuous_new_channels(&cfg, &dac), TAG, "DAC ocupado");
+
+    dac_event_callbacks_t cbs = {
+        .on_convert_done = dac_convertido_isr,
+        .on_stop = NULL,
+    };
+    ESP_ERROR_CHECK(dac_continuous_register_event_callback(dac, &cbs, NULL));
+    ESP_ERROR_CHECK(dac_continuous_enable(dac));
+    canal_actual = canal;
+    return dac_continuous_start_async_writing(dac);
+}
+
+esp_err_t onda_dac_validar(const onda_config_t *cfg) {
+    if (cfg->forma >= ONDA_NUM_FORMAS || cfg->amplitud > ONDA_DAC_AMPLITUD_MAX ||
+        (cfg->canal != 0 && cfg->canal != 1) ||
+        cfg->frecuencia_mhz == 0 || cfg->frecuencia_mhz > ONDA_DAC_FRECUENCIA_MUESTREO / 4 * DDS_MHZ_POR_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t onda_dac_aplicar(const onda_config_t *cfg) {
+    esp_err_t err = onda_dac_validar(cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (!tablas_listas) {
+        generar_tablas();
+    }
+
+    oscilador.incremento = dds_incremento(cfg->frecuencia_mhz, ONDA_DAC_FRECUENCIA_MUESTREO);
+    tabla_actual = tablas[cfg->forma];
+    amplitud = cfg->amplitud;
+    offset = cfg->offset;
+
+    if (dac != NULL && canal_actual != cfg->canal) {
+        onda_dac_detener();
+    }
+    if (dac == NULL) {
+        ESP_LOGI(TAG, "DAC continuo en canal %d a %d Hz", cfg->canal, ONDA_DAC_FRECUENCIA_MUESTREO);
+        return crear_dac(cfg->canal);
+    }
+    return ESP_OK;
+}
+
+esp_err_t onda_dac_detener(void) {
+    if (dac == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    dac_continuous_stop_async_writing(dac);
+    dac_continuous_disable(dac);
+    dac_continuous_del_channels(dac);
+    dac = NULL;
+    canal_actual = -1;
+    return ESP_OK;
+}
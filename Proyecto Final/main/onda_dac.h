@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Salida analógica por los DAC (canal 0 = GPIO25, canal 1 = GPIO26)
+#define ONDA_DAC_FRECUENCIA_MUESTREO 200000
+#define ONDA_DAC_BITS_TABLA 8
+#define ONDA_DAC_TAMANO_BUFFER 1024
+#define ONDA_DAC_DESCRIPTORES 4
+#define ONDA_DAC_AMPLITUD_MAX 127
+
+typedef enum {
+    ONDA_SENO,
+    ONDA_TRIANGULAR,
+    ONDA_SIERRA,
+    ONDA_NUM_FORMAS
+} onda_forma_t;
+
+typedef struct {
+    onda_forma_t forma;
+    uint32_t frecuencia_mhz;    // milihercios, para pasos finos
+    uint8_t amplitud;           // pico, 0..ONDA_DAC_AMPLITUD_MAX cuentas del DAC
+    uint8_t offset;             // nivel central, 0..255 cuentas del DAC
+    int canal;
+} onda_config_t;
+
+// ESP_ERR_INVALID_ARG si onda_dac_aplicar rechazaría la configuración; no
+// toca el hardware, para comprobar una orden antes de programarla
+esp_err_t onda_dac_validar(const onda_config_t *cfg);
+// Arranca la salida o, si ya corre en el mismo canal, solo cambia los
+// parámetros sin detener el DMA ni regenerar las tablas.
+esp_err_t onda_dac_aplicar(const onda_config_t *cfg);
+esp_err_t onda_dac_detener(void);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "sdkconfig.h"
+
+// Pines de la PCB de la Tarea 3 (ESP32-S3-WROOM-1). En el ESP32 clásico del
+// devkit esos GPIO no existen o son solo de entrada (34-39), así que se usan
+// equivalentes libres con el mismo papel.
+#if CONFIG_IDF_TARGET_ESP32S3
+#define PLACA_PWMA GPIO_NUM_35
+#define PLACA_AIN1 GPIO_NUM_37
+#define PLACA_AIN2 GPIO_NUM_36
+#define PLACA_PWMB GPIO_NUM_17
+#define PLACA_BIN1 GPIO_NUM_21
+#define PLACA_BIN2 GPIO_NUM_18
+#define PLACA_STBY GPIO_NUM_38
+#define PLACA_FALLA GPIO_NUM_4      // libre en la PCB, entrada de paro por hardware
+#define PLACA_SERVO1 GPIO_NUM_5
+#define PLACA_SERVO2 GPIO_NUM_6
+#define PLACA_ZUMBADOR GPIO_NUM_7   // red BZ
+#else
+#define PLACA_PWMA GPIO_NUM_16
+#define PLACA_AIN1 GPIO_NUM_17
+#define PLACA_AIN2 GPIO_NUM_18
+#define PLACA_PWMB GPIO_NUM_19
+#define PLACA_BIN1 GPIO_NUM_21
+#define PLACA_BIN2 GPIO_NUM_22
+#define PLACA_STBY GPIO_NUM_23
+#define PLACA_FALLA GPIO_NUM_34
+#define PLACA_SERVO1 GPIO_NUM_32
+#define PLACA_SERVO2 GPIO_NUM_33
+#define PLACA_ZUMBADOR GPIO_NUM_13
+#endif
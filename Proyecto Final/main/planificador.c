@@ -0,0 +1,129 @@
+#include "planificador.h"
+#include "dds.h"
+
+// Error relativo redondeado hacia arriba cuando real / deseada = a / b.
+// Se calcula con los ticks o el divisor exactos y no con real_mhz, que al
+// redondear a milihercios ocultaría miles de ppm por debajo de 1 Hz.
+static uint32_t error_ppm(uint64_t a, uint64_t b) {
+    uint64_t diferencia = a > b ? a - b : b - a;
+    uint64_t ppm = (diferencia * 1000000 + b - 1) / b;
+    return ppm > UINT32_MAX ? UINT32_MAX : (uint32_t)ppm;
+}
+
+bool plan_rmt_calcular(uint64_t frecuencia_mhz, uint32_t *resolucion_hz, uint32_t *periodo_ticks) {
+    for (uint32_t divisor = 1; divisor <= PLAN_RMT_DIVISOR_MAX; divisor++) {
+        uint64_t periodo = dds_periodo_ticks(frecuencia_mhz, PLAN_RELOJ_APB_HZ / divisor);
+        if (periodo < PLAN_RMT_MIN_TICKS) {
+            return false;
+        }
+        if (periodo <= PLAN_RMT_MAX_TICKS) {
+            *resolucion_hz = PLAN_RELOJ_APB_HZ / divisor;
+            *periodo_ticks = (uint32_t)periodo;
+            return true;
+        }
+    }
+    return false;
+}
+
+// El divisor fraccionario del LEDC alterna entre dos enteros: los flancos
+// se desvían como mucho un ciclo de APB del instante ideal. Con menos bits
+// de duty el divisor es mayor y su paso de 1/256 pesa menos en el periodo.
+static bool evaluar_ledc(const plan_peticion_t *p, plan_resultado_t *r) {
+    bool posible = false;
+    for (uint32_t bits = DDS_LEDC_BITS_MAX; bits >= 1; bits--) {
+        dds_ledc_t ledc;
+        if (!dds_ledc_calcular(&ledc, p->frecuencia_mhz, PLAN_RELOJ_APB_HZ, bits) || ledc.bits != bits) {
+            continue;
+        }
+        uint32_t error = error_ppm((uint64_t)PLAN_RELOJ_APB_HZ * 256 * DDS_MHZ_POR_HZ,
+                                   p->frecuencia_mhz * ((uint64_t)ledc.divisor_q8 << ledc.bits));
+        if (!posible || error < r->error_ppm) {
+            r->real_mhz = dds_ledc_frecuencia(&ledc, PLAN_RELOJ_APB_HZ);
+            r->error_ppm = error;
+            r->bits_ledc = ledc.bits;
+            r->jitter_ns = (ledc.divisor_q8 & 0xFF) ? (1000000000u + PLAN_RELOJ_APB_HZ - 1) / PLAN_RELOJ_APB_HZ : 0;
+            posible = true;
+        }
+        if (error <= p->error_ppm_max) {
+            break;
+        }
+    }
+    return posible;
+}
+
+// Flancos exactos al tick; el error es solo el redondeo del periodo
+static bool evaluar_rmt(uint64_t f, plan_resultado_t *r) {
+    uint32_t resolucion, periodo;
+    if (!plan_rmt_calcular(f, &resolucion, &periodo)) {
+        return false;
+    }
+    r->real_mhz = dds_frecuencia_ticks(periodo, resolucion);
+    r->error_ppm = error_ppm((uint64_t)resolucion * DDS_MHZ_POR_HZ, f * periodo);
+    r->jitter_ns = 0;
+    return true;
+}
+
+// El reparto de residuos deja el periodo medio exacto, pero cada flanco
+// llega un tick tarde como mucho más la latencia de la interrupción.
+static bool evaluar_temporizador(uint64_t f, plan_resultado_t *r) {
+    dds_flancos_t flancos;
+    if (f > PLAN_TEMPORIZADOR_MAX_MHZ || !dds_flancos_iniciar(&flancos, f, PLAN_TEMPORIZADOR_RESOLUCION_HZ, 2)) {
+        return false;
+    }
+    r->real_mhz = f;
+    r->error_ppm = 0;
+    r->jitter_ns = 1000000000u / PLAN_TEMPORIZADOR_RESOLUCION_HZ + PLAN_LATENCIA_ISR_NS;
+    return true;
+}
+
+bool plan_evaluar(plan_backend_t backend, const plan_peticion_t *p, plan_resultado_t *r) {
+    bool posible;
+    if (p->frecuencia_mhz == 0) {
+        return false;
+    }
+    r->bits_ledc = 0;
+    switch (backend) {
+    case PLAN_LEDC:
+        posible = evaluar_ledc(p, r);
+        break;
+    case PLAN_RMT:
+        posible = evaluar_rmt(p->frecuencia_mhz, r);
+        break;
+    case PLAN_TEMPORIZADOR:
+        posible = evaluar_temporizador(p->frecuencia_mhz, r);
+        break;
+    default:
+        return false;
+    }
+    if (posible) {
+        r->backend = backend;
+    }
+    return posible;
+}
+
+bool planificar(const plan_peticion_t *p, plan_resultado_t *r) {
+    bool alguno = false;
+    for (int b = 0; b < PLAN_NUM_BACKENDS; b++) {
+        plan_resultado_t candidato;
+        if (!plan_evaluar(b, p, &candidato)) {
+            continue;
+        }
+        if (candidato.error_ppm <= p->error_ppm_max && candidato.jitter_ns <= p->jitter_ns_max) {
+            *r = candidato;
+            return true;
+        }
+        if (!alguno || candidato.error_ppm < r->error_ppm) {
+            *r = candidato;
+            alguno = true;
+        }
+    }
+    if (!alguno) {
+        r->backend = PLAN_NUM_BACKENDS;
+    }
+    return false;
+}
+
+const char *plan_nombre(plan_backend_t backend) {
+    static const char *const nombres[] = { "LEDC", "RMT", "temporizador" };
+    return backend < PLAN_NUM_BACKENDS ? nombres[backend] : "ninguno";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Elige el periférico que genera una onda cuadrada según la frecuencia y el
+// presupuesto de error y jitter. No depende de ESP-IDF: las cifras de cada
+// salida salen de la misma aritmética de dds.c que usan los generadores.
+
+#define PLAN_RELOJ_APB_HZ 80000000
+#define PLAN_TEMPORIZADOR_RESOLUCION_HZ 10000000
+#define PLAN_TEMPORIZADOR_MAX_MHZ (20000 * 1000ULL)
+#define PLAN_LATENCIA_ISR_NS 2000   // latencia típica de la alarma hasta el GPIO
+#define PLAN_RMT_DIVISOR_MAX 255
+#define PLAN_RMT_MAX_TICKS 65534u   // dos mitades de 15 bits por símbolo
+#define PLAN_RMT_MIN_TICKS 2u
+
+// En orden de costo: el LEDC no usa CPU ni canales escasos, el RMT ocupa un
+// canal y la memoria de símbolos, el temporizador interrumpe en cada flanco.
+typedef enum {
+    PLAN_LEDC,
+    PLAN_RMT,
+    PLAN_TEMPORIZADOR,
+    PLAN_NUM_BACKENDS
+} plan_backend_t;
+
+typedef struct {
+    uint64_t frecuencia_mhz;
+    uint32_t error_ppm_max;
+    uint32_t jitter_ns_max;
+} plan_peticion_t;
+
+typedef struct {
+    plan_backend_t backend;
+    uint64_t real_mhz;
+    uint32_t error_ppm;
+    uint32_t jitter_ns;
+    uint32_t bits_ledc;             // resolución de duty elegida si es LEDC
+} plan_resultado_t;
+
+// Cifras esperadas de una salida concreta; false si no alcanza la
+// frecuencia. En el LEDC se cede resolución de duty si así cumple el error.
+bool plan_evaluar(plan_backend_t backend, const plan_peticion_t *p, plan_resultado_t *r);
+
+// La salida más barata que cumple los dos límites. Si ninguna cumple
+// devuelve false y deja en r la posible con menor error, para informarlo.
+bool planificar(const plan_peticion_t *p, plan_resultado_t *r);
+
+// Mayor resolución del RMT (menor divisor de APB) con la que el periodo cabe
+// en un símbolo
+bool plan_rmt_calcular(uint64_t frecuencia_mhz, uint32_t *resolucion_hz, uint32_t *periodo_ticks);
+
+const char *plan_nombre(plan_backend_t backend);
@@ -0,0 +1,192 @@
+// Comprobación del núcleo DDS en el PC, sin ESP-IDF:
+//   gcc -O2 -std=c99 prueba_dds.c dds.c -lm -o prueba_dds && ./prueba_dds
+// Recorre todo el rango del DAC continuo (1 mHz a fs/4) y verifica que
+// incremento -> frecuencia devuelve la frecuencia pedida y que el
+// acumulador de fase da, contando vueltas, la frecuencia esperada. También
+// hace la ida y vuelta de periodos en ticks, flancos y divisores LEDC, y
+// mide cuánto cuesta por muestra el bucle de dds_avanzar de onda_dac.
+#define _POSIX_C_SOURCE 199309L
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "dds.h"
+
+// Igual que ONDA_DAC_FRECUENCIA_MUESTREO, PLAN_RELOJ_APB_HZ y
+// GENERADOR_GPIO_RESOLUCION_HZ; sus cabeceras necesitan ESP-IDF
+#define MUESTREO_HZ 200000
+#define RELOJ_APB_HZ 80000000
+#define RESOLUCION_GPTIMER_HZ 10000000
+#define MUESTRAS_MEDIDA 100000000u
+
+static int errores;
+
+static void fallo(const char *que, uint64_t pedida_mhz, uint64_t obtenida_mhz) {
+    if (errores++ < 10) {
+        printf("FALLO %s: pedida %" PRIu64 " mHz, obtenida %" PRIu64 " mHz\n", que, pedida_mhz, obtenida_mhz);
+    }
+}
+
+// Incremento de ida y vuelta: con fs = 200 kHz un paso del acumulador vale
+// 46,6 uHz, menos de medio milihercio, así que debe volver la misma cifra.
+static void idaVuelta(uint64_t f_mhz, double *peor) {
+    uint32_t inc = dds_incremento(f_mhz, MUESTREO_HZ);
+    uint64_t vuelta = dds_frecuencia_incremento(inc, MUESTREO_HZ);
+    if (vuelta != f_mhz) {
+        fallo("ida y vuelta", f_mhz, vuelta);
+    }
+    double real_mhz = (double)inc * MUESTREO_HZ * DDS_MHZ_POR_HZ / 4294967296.0;
+    double error = real_mhz - (double)f_mhz;
+    if (error < 0) {
+        error = -error;
+    }
+    if (error > *peor) {
+        *peor = error;
+    }
+}
+
+// Cuenta vueltas del acumulador durante un segundo de muestras: deben ser
+// la parte entera de la frecuencia pedida, con un ciclo de margen.
+static void vueltasEnUnSegundo(uint64_t f_mhz) {
+    dds_t d;
+    dds_iniciar(&d, f_mhz, MUESTREO_HZ);
+    uint64_t vueltas = 0;
+    for (uint32_t i = 0; i < MUESTREO_HZ; i++) {
+        uint32_t antes = dds_avanzar(&d);
+        vueltas += d.fase < antes;
+    }
+    uint64_t esperadas = f_mhz / DDS_MHZ_POR_HZ;
+    if (vueltas + 1 < esperadas || vueltas > esperadas + 1) {
+        fallo("vueltas en 1 s", f_mhz, vueltas * DDS_MHZ_POR_HZ);
+    }
+}
+
+static uint64_t distancia(uint64_t a, uint64_t b) {
+    return a > b ? a - b : b - a;
+}
+
+// Periodo redondeado a ticks y vuelta: el error no pasa de medio tick
+static void idaVueltaTicks(uint64_t f_mhz, uint32_t resolucion_hz) {
+    uint64_t ticks = dds_periodo_ticks(f_mhz, resolucion_hz);
+    if (ticks == 0) {
+        return;
+    }
+    uint64_t vuelta = dds_frecuencia_ticks(ticks, resolucion_hz);
+    if (distancia(vuelta, f_mhz) > f_mhz / (2 * ticks) + f_mhz / (2 * ticks * ticks) + 1) {
+        fallo("ida y vuelta en ticks", f_mhz, vuelta);
+    }
+}
+
+// Los flancos repartidos deben sumar exactamente n * resolución / f
+static void flancosExactos(uint64_t f_mhz, uint32_t resolucion_hz) {
+    dds_flancos_t fl;
+    if (!dds_flancos_iniciar(&fl, f_mhz, resolucion_hz, 2)) {
+        return;
+    }
+    const uint64_t n = 100000;
+    uint64_t suma = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        suma += dds_flancos_siguiente(&fl);
+    }
+    uint64_t num = (uint64_t)resolucion_hz * DDS_MHZ_POR_HZ;
+    uint64_t esperada = n * fl.ticks + n * fl.resto / fl.divisor;
+    if (suma != esperada || fl.ticks != num / fl.divisor) {
+        fallo("suma de flancos", f_mhz, suma);
+    }
+}
+
+// Divisor fraccionario del LEDC y vuelta: error de medio paso del divisor
+static void idaVueltaLedc(uint64_t f_mhz) {
+    dds_ledc_t l;
+    if (!dds_ledc_calcular(&l, f_mhz, RELOJ_APB_HZ, DDS_LEDC_BITS_MAX)) {
+        return;
+    }
+    uint64_t vuelta = dds_ledc_frecuencia(&l, RELOJ_APB_HZ);
+    if (distancia(vuelta, f_mhz) > f_mhz / (2 * l.divisor_q8) + f_mhz / ((uint64_t)l.divisor_q8 * l.divisor_q8) + 1) {
+        fallo("ida y vuelta LEDC", f_mhz, vuelta);
+    }
+}
+
+// Global para que el compilador no descarte el bucle medido
+volatile int32_t sumidero;
+
+static double segundos(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// El mismo bucle que llena el buffer del DAC: avance, índice y tabla
+static void medirAvance(void) {
+    static int16_t tabla[256];
+    dds_tabla_seno(tabla, 8);
+    dds_t d;
+    dds_iniciar(&d, 1000000, MUESTREO_HZ);
+    int32_t acumulado = 0;
+    double inicio = segundos();
+    for (uint32_t i = 0; i < MUESTRAS_MEDIDA; i++) {
+        acumulado += tabla[dds_indice(dds_avanzar(&d), 8)];
+    }
+    double ns = (segundos() - inicio) * 1e9 / MUESTRAS_MEDIDA;
+    sumidero = acumulado;
+    printf("dds_avanzar + tabla: %.2f ns por muestra (%.3f %% de una muestra a %d Hz)\n", ns,
+           ns * MUESTREO_HZ / 1e7, MUESTREO_HZ);
+}
+
+int main(void) {
+    const uint64_t maximo = MUESTREO_HZ / 4 * DDS_MHZ_POR_HZ;
+    double peor = 0;
+    uint64_t casos = 0;
+
+    // Todos los valores hasta 100 Hz y luego una rejilla de ~0,1 %
+    for (uint64_t f = 1; f <= 100000; f++, casos++) {
+        idaVuelta(f, &peor);
+    }
+    for (uint64_t f = 100000; f <= maximo; f += f / 1024 + 1, casos++) {
+        idaVuelta(f, &peor);
+    }
+    idaVuelta(maximo, &peor);
+
+    uint32_t semilla = 12345;
+    for (int i = 0; i < 1000000; i++, casos++) {
+        semilla = semilla * 1664525u + 1013904223u;
+        idaVuelta(1 + (uint64_t)semilla % maximo, &peor);
+    }
+    printf("ida y vuelta: %" PRIu64 " frecuencias, error de salida máximo %.4f mHz\n", casos, peor);
+    // El incremento se redondea: el error no pasa de medio paso del acumulador
+    double medio_paso = (double)MUESTREO_HZ * DDS_MHZ_POR_HZ / 8589934592.0;
+    if (peor > medio_paso * 1.000001) {
+        printf("FALLO error %.4f mHz mayor que medio paso (%.4f mHz)\n", peor, medio_paso);
+        errores++;
+    }
+
+    const uint64_t pruebas[] = {1000, 1500, 60000, 440000, 1000000, 12345678, maximo};
+    for (unsigned i = 0; i < sizeof pruebas / sizeof pruebas[0]; i++) {
+        vueltasEnUnSegundo(pruebas[i]);
+    }
+
+    // 10 mHz a 40 MHz por pasos de ~0,1 %
+    for (uint64_t f = 10; f <= 40000000000ULL; f += f / 1024 + 1) {
+        idaVueltaTicks(f, RELOJ_APB_HZ);
+        idaVueltaTicks(f, RESOLUCION_GPTIMER_HZ);
+        idaVueltaLedc(f);
+    }
+    for (uint64_t f = 1000; f <= 5000000000ULL; f = f * 3 + 7) {
+        flancosExactos(f, RESOLUCION_GPTIMER_HZ);
+    }
+
+    if (dds_incremento(MUESTREO_HZ * DDS_MHZ_POR_HZ, MUESTREO_HZ) != 0) {
+        fallo("fs no rechazada", MUESTREO_HZ * DDS_MHZ_POR_HZ, 0);
+    }
+    // Entradas de formulario fuera de rango
+    const double entradas[] = {-5.0, 0.0, NAN, 1e300, INFINITY, 0.0004, 2.5};
+    const uint64_t esperadas[] = {0, 0, 0, UINT64_MAX, UINT64_MAX, 0, 2500};
+    for (unsigned i = 0; i < sizeof entradas / sizeof entradas[0]; i++) {
+        if (dds_mhz_desde_hz(entradas[i]) != esperadas[i]) {
+            fallo("conversión desde Hz", esperadas[i], dds_mhz_desde_hz(entradas[i]));
+        }
+    }
+    medirAvance();
+    printf("%s (%d errores)\n", errores ? "FALLA" : "OK", errores);
+    return errores != 0;
+}
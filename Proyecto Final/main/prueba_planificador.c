@@ -0,0 +1,171 @@
+// Tabla de decisiones del planificador en el PC, sin ESP-IDF:
+//   gcc -O2 -std=c99 prueba_planificador.c planificador.c dds.c -lm -o prueba_planificador
+//   ./prueba_planificador        comprueba de 0,01 Hz a 50 MHz
+//   ./prueba_planificador -v     además imprime la salida elegida por década
+// Para cada frecuencia y presupuesto recalcula en coma flotante la
+// frecuencia real de cada salida y verifica el error informado, que la
+// elegida cumpla los límites y que ninguna más barata los cumpla.
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "planificador.h"
+#include "dds.h"
+
+#define F_MIN_MHZ 10ULL                 // 0,01 Hz
+#define F_MAX_MHZ 50000000000ULL        // 50 MHz
+
+static const plan_peticion_t presupuestos[] = {
+    {0, 0, 0},
+    {0, 10, 0},
+    {0, 100, 20},
+    {0, 1000, 5000},
+    {0, 50000, UINT32_MAX},
+    {0, UINT32_MAX, UINT32_MAX},
+};
+#define NUM_PRESUPUESTOS (sizeof presupuestos / sizeof presupuestos[0])
+
+static int errores;
+static uint64_t casos;
+
+static void fallo(const char *que, const plan_peticion_t *p, const plan_resultado_t *r) {
+    if (errores++ < 20) {
+        printf("FALLO %s: %" PRIu64 " mHz (%" PRIu32 " ppm, %" PRIu32 " ns) -> %s %" PRIu64 " mHz, %" PRIu32
+               " ppm, %" PRIu32 " ns\n",
+               que, p->frecuencia_mhz, p->error_ppm_max, p->jitter_ns_max, plan_nombre(r->backend), r->real_mhz,
+               r->error_ppm, r->jitter_ns);
+    }
+}
+
+// Frecuencia real en mHz según el modelo de cada periférico, sin pasar por
+// dds.c: divisor del LEDC en Q8 redondeado, periodo del RMT y del
+// temporizador en ticks enteros.
+static double modelo_ledc(double f, uint32_t bits) {
+    double divisor = round((double)PLAN_RELOJ_APB_HZ * 256 * 1000 / (f * (double)(1u << bits)));
+    if (divisor < DDS_LEDC_DIVISOR_MIN || divisor > DDS_LEDC_DIVISOR_MAX) {
+        return -1;
+    }
+    return (double)PLAN_RELOJ_APB_HZ * 256 * 1000 / (divisor * (double)(1u << bits));
+}
+
+static double modelo_rmt(double f) {
+    for (uint32_t d = 1; d <= PLAN_RMT_DIVISOR_MAX; d++) {
+        double resolucion = (double)(PLAN_RELOJ_APB_HZ / d);
+        double periodo = round(resolucion * 1000 / f);
+        if (periodo < PLAN_RMT_MIN_TICKS) {
+            return -1;
+        }
+        if (periodo <= PLAN_RMT_MAX_TICKS) {
+            return resolucion * 1000 / periodo;
+        }
+    }
+    return -1;
+}
+
+static bool cumple(const plan_peticion_t *p, const plan_resultado_t *r) {
+    return r->error_ppm <= p->error_ppm_max && r->jitter_ns <= p->jitter_ns_max;
+}
+
+// La frecuencia real se informa redondeada a mHz, pero el error debe ser el
+// verdadero redondeado hacia arriba, también por debajo de 1 Hz.
+static void comprobar_evaluacion(const plan_peticion_t *p, const plan_resultado_t *r) {
+    double f = (double)p->frecuencia_mhz;
+    double real;
+    switch (r->backend) {
+    case PLAN_LEDC:
+        real = modelo_ledc(f, r->bits_ledc);
+        break;
+    case PLAN_RMT:
+        real = modelo_rmt(f);
+        break;
+    default:
+        real = f;
+        if (r->jitter_ns != 1000000000u / PLAN_TEMPORIZADOR_RESOLUCION_HZ + PLAN_LATENCIA_ISR_NS) {
+            fallo("jitter del temporizador", p, r);
+        }
+        break;
+    }
+    if (real < 0 || fabs(real - (double)r->real_mhz) > 0.5 + 1e-9 * real) {
+        fallo("frecuencia real", p, r);
+        return;
+    }
+    double ppm = ceil(fabs(real - f) * 1e6 / f);
+    if (fabs((double)r->error_ppm - ppm) > 1) {
+        fallo("error informado", p, r);
+    }
+}
+
+static void comprobar(uint64_t f, bool detalle) {
+    for (unsigned k = 0; k < NUM_PRESUPUESTOS; k++) {
+        plan_peticion_t p = presupuestos[k];
+        p.frecuencia_mhz = f;
+        plan_resultado_t elegido, posibles[PLAN_NUM_BACKENDS];
+        bool valido[PLAN_NUM_BACKENDS];
+        memset(&elegido, 0, sizeof elegido);
+        bool ok = planificar(&p, &elegido);
+        casos++;
+
+        bool alguno = false;
+        int primero_que_cumple = -1;
+        for (int b = 0; b < PLAN_NUM_BACKENDS; b++) {
+            valido[b] = plan_evaluar(b, &p, &posibles[b]);
+            if (!valido[b]) {
+                continue;
+            }
+            alguno = true;
+            comprobar_evaluacion(&p, &posibles[b]);
+            if (primero_que_cumple < 0 && cumple(&p, &posibles[b])) {
+                primero_que_cumple = b;
+            }
+        }
+
+        if (ok) {
+            if (!cumple(&p, &elegido)) {
+                fallo("elegida fuera de presupuesto", &p, &elegido);
+            } else if ((int)elegido.backend != primero_que_cumple) {
+                fallo("no es la más barata", &p, &elegido);
+            }
+        } else if (primero_que_cumple >= 0) {
+            fallo("rechazada pero alguna cumple", &p, &elegido);
+        } else if (!alguno) {
+            if (elegido.backend != PLAN_NUM_BACKENDS) {
+                fallo("sin salida posible", &p, &elegido);
+            }
+        } else {
+            for (int b = 0; b < PLAN_NUM_BACKENDS; b++) {
+                if (valido[b] && posibles[b].error_ppm < elegido.error_ppm) {
+                    fallo("no informa la de menor error", &p, &elegido);
+                }
+            }
+        }
+        if (detalle) {
+            printf("%14.2f Hz  %10" PRIu32 " ppm %10" PRIu32 " ns  %-3s %-12s %10" PRIu32 " ppm %6" PRIu32 " ns\n",
+                   f / 1000.0, p.error_ppm_max, p.jitter_ns_max, ok ? "sí" : "no", plan_nombre(elegido.backend),
+                   elegido.error_ppm, elegido.jitter_ns);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    bool detalle = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    // Rejilla de ~0,1 % más los bordes de cada salida y sus vecinos
+    for (uint64_t f = F_MIN_MHZ; f <= F_MAX_MHZ; f += f / 1024 + 1) {
+        comprobar(f, false);
+    }
+    const uint64_t bordes[] = {
+        F_MIN_MHZ, 74, 75, 76, 4767, 4768, 4769, 1000000, 20000000000ULL, 20000000001ULL,
+        26666666667ULL, 40000000000ULL, 40000000001ULL, F_MAX_MHZ,
+    };
+    for (unsigned i = 0; i < sizeof bordes / sizeof bordes[0]; i++) {
+        comprobar(bordes[i], false);
+    }
+    if (detalle) {
+        for (uint64_t f = F_MIN_MHZ; f <= F_MAX_MHZ; f *= 10) {
+            comprobar(f, true);
+        }
+        comprobar(F_MAX_MHZ, true);
+    }
+    printf("%" PRIu64 " peticiones: %s (%d errores)\n", casos, errores ? "FALLA" : "OK", errores);
+    return errores != 0;
+}
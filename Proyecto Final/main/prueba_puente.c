@@ -0,0 +1,105 @@
+// Comprobación de los tiempos del puente H en el PC, sin ESP-IDF:
+//   gcc -O2 -std=c99 prueba_puente.c puente_modelo.c dds.c -lm -o prueba_puente && ./prueba_puente
+// Recorre configuraciones al azar y, tick a tick dentro de un periodo, usa
+// puente_pulso para verificar que los dos lados de una rama nunca conducen
+// a la vez, que cada conmutación deja al menos el tiempo muerto, que los
+// anchos son los del duty y que la rama B va retrasada el desfase pedido.
+#include <inttypes.h>
+#include <stdio.h>
+#include "puente_modelo.h"
+
+#define CONFIGURACIONES 20000
+
+static int errores;
+
+static void fallo(const char *que, const puente_config_t *c, const puente_tiempos_t *t) {
+    if (errores++ < 10) {
+        printf("FALLO %s: %.3f Hz, duty %u/%u, muerto %" PRIu32 " ns, desfase %u -> periodo %" PRIu32
+               ", muerto %" PRIu32 " ticks\n",
+               que, c->frecuencia_mhz / 1000.0, c->duty_permil[0], c->duty_permil[1], c->muerto_ns,
+               c->desfase_grados, t->periodo_ticks, t->muerto_ticks);
+    }
+}
+
+static bool en_alto(const puente_pulso_t *p, uint32_t tick) {
+    if (!p->activa) {
+        return false;
+    }
+    if (p->subida == p->bajada) {
+        return true;
+    }
+    if (p->subida < p->bajada) {
+        return tick >= p->subida && tick < p->bajada;
+    }
+    return tick >= p->subida || tick < p->bajada;
+}
+
+static uint32_t siguiente_azar(uint32_t *semilla) {
+    *semilla = *semilla * 1664525u + 1013904223u;
+    return *semilla >> 8;
+}
+
+static void revisar_rama(const puente_config_t *c, const puente_tiempos_t *t, int rama) {
+    puente_pulso_t alto, bajo;
+    puente_pulso(t, rama, true, &alto);
+    puente_pulso(t, rama, false, &bajo);
+    uint32_t periodo = t->periodo_ticks, cmp = t->comparacion_ticks[rama];
+    uint32_t ticks_alto = 0, ticks_bajo = 0;
+    for (uint32_t k = 0; k < periodo; k++) {
+        bool a = en_alto(&alto, k), b = en_alto(&bajo, k);
+        ticks_alto += a;
+        ticks_bajo += b;
+        if (a && b) {
+            fallo("los dos lados conducen a la vez", c, t);
+            return;
+        }
+    }
+    uint32_t esperado_alto = cmp > t->muerto_ticks ? cmp - t->muerto_ticks : 0;
+    uint32_t esperado_bajo = cmp + t->muerto_ticks < periodo ? periodo - cmp - t->muerto_ticks : 0;
+    if (ticks_alto != esperado_alto || ticks_bajo != esperado_bajo) {
+        fallo("ancho de pulso", c, t);
+        return;
+    }
+    // Si conmutan los dos lados, cada hueco entre ellos dura el tiempo muerto
+    if (ticks_alto && ticks_bajo) {
+        uint32_t hueco_bajo_a_alto = (alto.subida + periodo - bajo.bajada) % periodo;
+        uint32_t hueco_alto_a_bajo = (bajo.subida + periodo - alto.bajada) % periodo;
+        if (hueco_bajo_a_alto != t->muerto_ticks || hueco_alto_a_bajo != t->muerto_ticks) {
+            fallo("tiempo muerto", c, t);
+        }
+    }
+}
+
+int main(void) {
+    uint32_t semilla = 2025;
+    int revisadas = 0;
+    for (int i = 0; i < CONFIGURACIONES; i++) {
+        puente_config_t c = {
+            .frecuencia_mhz = 10000000 + (uint64_t)siguiente_azar(&semilla) % 1990000000ULL,
+            .duty_permil = { siguiente_azar(&semilla) % 1001, siguiente_azar(&semilla) % 1001 },
+            .muerto_ns = siguiente_azar(&semilla) % 4 == 0 ? 0 : siguiente_azar(&semilla) % 5000,
+            .desfase_grados = siguiente_azar(&semilla) % 360,
+        };
+        if (i % 8 == 0) {
+            c.duty_permil[i % 16 == 0] = (i % 3 == 0) ? 0 : PUENTE_PERMIL_MAX;
+        }
+        puente_tiempos_t t;
+        if (!puente_calcular(&c, &t)) {
+            continue;
+        }
+        revisadas++;
+        for (int r = 0; r < PUENTE_RAMAS; r++) {
+            revisar_rama(&c, &t, r);
+        }
+        // Con el mismo duty, la rama B sube desfase ticks después que la A
+        t.comparacion_ticks[1] = t.comparacion_ticks[0];
+        puente_pulso_t a, b;
+        puente_pulso(&t, 0, true, &a);
+        puente_pulso(&t, 1, true, &b);
+        if (b.subida != (a.subida + t.desfase_ticks) % t.periodo_ticks) {
+            fallo("desfase de la rama B", &c, &t);
+        }
+    }
+    printf("%d configuraciones revisadas: %s (%d errores)\n", revisadas, errores ? "FALLA" : "OK", errores);
+    return errores != 0;
+}
@@ -0,0 +1,128 @@
+// Comprobación de las rampas del motor paso a paso en el PC, sin ESP-IDF:
+//   gcc -O2 -std=c99 prueba_rampa_pasos.c rampa_pasos.c -lm -o prueba_rampa_pasos && ./prueba_rampa_pasos
+// Ejecuta planes completos y compara con el perfil trapezoidal ideal: el
+// crucero debe ir exactamente a la velocidad pedida, la duración total
+// debe coincidir con v/a + pasos/v y ningún paso puede superar v.
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include "rampa_pasos.h"
+
+// Igual que MOTOR_PASOS_RESOLUCION_HZ; motor_pasos.h necesita ESP-IDF
+#define RESOLUCION_HZ 10000000
+
+static int errores;
+
+typedef struct {
+    uint32_t pasos;
+    uint32_t vel_pps;
+    uint32_t acel_pps2;
+} caso_t;
+
+static const caso_t casos[] = {
+    {200000, 50000, 100000},
+    {200000, 50000, 1000000},
+    {100000, 20000, 4000},
+    {1000, 2000, 4000},
+    {10000, 2000, 4000},
+    {50000, 10000, 1000},
+    {500, 50000, 100000},
+    {3, 1000, 1000},
+    {1000000, 50000, 20000},
+    {20000, 333, 50},
+};
+
+// Duración ideal del trapecio, o del triángulo si no llega a crucero
+static double duracion_ideal(const caso_t *c) {
+    double v = c->vel_pps, a = c->acel_pps2;
+    if (v * v / a <= c->pasos) {
+        return v / a + c->pasos / v;
+    }
+    return 2 * sqrt(c->pasos / a);
+}
+
+static void probar(const caso_t *c) {
+    rampa_t r;
+    if (!rampa_planificar(&r, c->pasos, c->vel_pps, c->acel_pps2, RESOLUCION_HZ)) {
+        printf("FALLO %" PRIu32 " pasos a %" PRIu32 " pps: plan rechazado\n", c->pasos, c->vel_pps);
+        errores++;
+        return;
+    }
+    uint32_t ticks_min = RESOLUCION_HZ / c->vel_pps;
+    uint64_t total = 0, ticks_crucero = 0;
+    uint32_t pasos = 0, pasos_crucero = 0, intervalo_min = UINT32_MAX;
+    bool crucero_exacto = true;
+    for (uint32_t ticks; (ticks = rampa_siguiente(&r)) != 0; pasos++) {
+        total += ticks;
+        if (pasos > 0 && ticks < intervalo_min) {
+            intervalo_min = ticks;
+        }
+        if (r.segmentos[r.seg].tipo == RAMPA_CRUCERO) {
+            ticks_crucero += ticks;
+            pasos_crucero++;
+            crucero_exacto &= r.c_q8 == r.c_min_q8;
+        }
+    }
+    // Incluye el retardo del primer paso: en el ideal, sqrt(2/a)
+    double segundos = (double)total / RESOLUCION_HZ;
+    double ideal = duracion_ideal(c);
+    double vel_crucero = pasos_crucero ? (double)pasos_crucero * RESOLUCION_HZ / ticks_crucero : 0;
+    bool llega = (uint64_t)c->vel_pps * c->vel_pps / (2ull * c->acel_pps2) <= c->pasos / 2;
+
+    printf("%8" PRIu32 " pasos %6" PRIu32 " pps %8" PRIu32 " pps²: %.4f s (ideal %.4f s)", c->pasos, c->vel_pps,
+           c->acel_pps2, segundos, ideal);
+    if (pasos_crucero) {
+        printf(", crucero %.1f pps", vel_crucero);
+    }
+    printf("\n");
+
+    if (pasos != c->pasos) {
+        printf("FALLO %" PRIu32 " pasos dados de %" PRIu32 "\n", pasos, c->pasos);
+        errores++;
+    }
+    if (intervalo_min + 1 < ticks_min) {
+        printf("FALLO intervalo de %" PRIu32 " ticks, menor que %" PRIu32 "\n", intervalo_min, ticks_min);
+        errores++;
+    }
+    if (llega && pasos_crucero && (!crucero_exacto || fabs(vel_crucero - c->vel_pps) > c->vel_pps * 1e-4)) {
+        printf("FALLO el crucero no va al intervalo mínimo\n");
+        errores++;
+    }
+    // El primer intervalo corregido por 0,676 adelanta la subida y el frenado
+    // un tercio del primer paso exacto, sqrt(2/a); fuera de eso, 0,1 %
+    if (fabs(segundos - ideal) > ideal * 0.001 + sqrt(2.0 / c->acel_pps2)) {
+        printf("FALLO duración fuera del 0,1 %%\n");
+        errores++;
+    }
+}
+
+// Frenar a media subida debe parar antes del destino y sin acelerar
+static void probar_frenado(void) {
+    rampa_t r;
+    rampa_planificar(&r, 200000, 50000, 100000, RESOLUCION_HZ);
+    for (int i = 0; i < 5000; i++) {
+        rampa_siguiente(&r);
+    }
+    uint32_t c_al_frenar = r.c_q8;
+    rampa_frenar(&r);
+    uint32_t pasos = 0, anterior = 0;
+    bool monotono = true;
+    for (uint32_t ticks; (ticks = rampa_siguiente(&r)) != 0; pasos++) {
+        monotono &= r.c_q8 >= anterior && r.c_q8 >= c_al_frenar;
+        anterior = r.c_q8;
+    }
+    printf("frenado tras 5000 pasos: %" PRIu32 " pasos más\n", pasos);
+    if (!monotono || pasos > 5001) {
+        printf("FALLO el frenado acelera o no acorta el recorrido\n");
+        errores++;
+    }
+}
+
+int main(void) {
+    for (unsigned i = 0; i < sizeof casos / sizeof casos[0]; i++) {
+        probar(&casos[i]);
+    }
+    probar_frenado();
+    printf("%s (%d errores)\n", errores ? "FALLA" : "OK", errores);
+    return errores != 0;
+}
@@ -0,0 +1,164 @@
+// Comprobación del bytecode de secuencias en el PC, sin ESP-IDF:
+//   gcc -O2 -std=c99 prueba_secuencia.c secuencia.c dds.c -lm -o prueba_secuencia && ./prueba_secuencia
+// Interpreta programas completos con el mismo código que corre en la ISR y
+// revisa tiempos, flancos y nivel final; después pasa al validador los
+// programas mal formados que el intérprete no debe recibir nunca.
+#include <inttypes.h>
+#include <stdio.h>
+#include "secuencia.h"
+
+// Igual que SECUENCIADOR_RESOLUCION_HZ; secuenciador.h necesita ESP-IDF
+#define RESOLUCION_HZ 10000000
+#define MS(x) ((uint32_t)(x) * (RESOLUCION_HZ / 1000))
+
+static int errores;
+
+static void comprobar(bool condicion, const char *que) {
+    if (!condicion) {
+        printf("FALLO %s\n", que);
+        errores++;
+    }
+}
+
+static dds_flancos_t flancos(uint64_t frecuencia_hz) {
+    dds_flancos_t f;
+    dds_flancos_iniciar(&f, frecuencia_hz * DDS_MHZ_POR_HZ, RESOLUCION_HZ, 2);
+    return f;
+}
+
+typedef struct {
+    uint64_t fin;
+    uint32_t eventos;
+    uint32_t subidas;
+    bool ordenado;
+    bool termina_bajo;
+} recorrido_t;
+
+// Ejecuta hasta el evento final o hasta max_eventos
+static recorrido_t ejecutar(const uint32_t *codigo, uint32_t longitud, uint32_t max_eventos) {
+    sec_maquina_t m;
+    sec_evento_t ev;
+    recorrido_t r = { .ordenado = true };
+    uint8_t nivel = 0;
+    uint64_t anterior = 0;
+    sec_iniciar(&m, codigo, longitud);
+    while (r.eventos < max_eventos && sec_siguiente(&m, &ev)) {
+        r.eventos++;
+        r.ordenado &= ev.tiempo >= anterior;
+        anterior = ev.tiempo;
+        r.subidas += nivel == 0 && ev.nivel == 1;
+        nivel = ev.nivel;
+        if (ev.fin) {
+            r.fin = ev.tiempo;
+            r.termina_bajo = ev.nivel == 0;
+        }
+    }
+    return r;
+}
+
+// 1 kHz 200 ms, pausa 50 ms, ráfaga de 30 pulsos a 2 kHz, 10 veces:
+// 10 × (200 + 50 + 15) ms = 2,65 s = 26 500 000 ticks exactos
+static void probar_ejemplo(void) {
+    uint32_t codigo[SEC_MAX_PALABRAS];
+    sec_programa_t p;
+    sec_programa_iniciar(&p, codigo, SEC_MAX_PALABRAS);
+    dds_flancos_t f1k = flancos(1000), f2k = flancos(2000);
+    sec_emitir_tono(&p, &f1k, MS(200));
+    sec_emitir_pausa(&p, MS(50));
+    sec_emitir_rafaga(&p, &f2k, 30);
+    sec_emitir_bucle(&p, 0, 0, 10);
+    sec_emitir_fin(&p);
+    comprobar(!p.desbordado && sec_validar(codigo, p.longitud), "ejemplo rechazado");
+
+    recorrido_t r = ejecutar(codigo, p.longitud, 1000000);
+    printf("ejemplo: %" PRIu32 " eventos, %" PRIu32 " pulsos, fin en %" PRIu64 " ticks\n", r.eventos, r.subidas, r.fin);
+    comprobar(r.fin == 26500000, "el ejemplo no termina en 26 500 000 ticks");
+    comprobar(r.subidas == 10 * (200 + 30), "número de pulsos del ejemplo");
+    comprobar(r.ordenado && r.termina_bajo, "eventos desordenados o salida final en alto");
+}
+
+// 3 kHz no da un semiperiodo entero de ticks: en 1 s deben salir 3000
+// pulsos justos y el tono debe acabar exactamente en su duración
+static void probar_frecuencia_fraccionaria(void) {
+    uint32_t codigo[16];
+    sec_programa_t p;
+    sec_programa_iniciar(&p, codigo, 16);
+    dds_flancos_t f = flancos(3000);
+    sec_emitir_tono(&p, &f, MS(1000));
+    sec_emitir_fin(&p);
+    recorrido_t r = ejecutar(codigo, p.longitud, 100000);
+    comprobar(r.subidas == 3000 && r.fin == MS(1000), "tono de 3 kHz durante 1 s");
+}
+
+// Un bucle sin fin con paso temporizado nunca llega al evento final
+static void probar_bucle_infinito(void) {
+    uint32_t codigo[16];
+    sec_programa_t p;
+    sec_programa_iniciar(&p, codigo, 16);
+    sec_emitir_pausa(&p, 1);
+    sec_emitir_bucle(&p, 0, 0, 0);
+    sec_emitir_fin(&p);
+    comprobar(sec_validar(codigo, p.longitud), "bucle sin fin rechazado");
+    recorrido_t r = ejecutar(codigo, p.longitud, 10000);
+    comprobar(r.eventos == 10000 && r.fin == 0 && r.ordenado, "bucle sin fin");
+}
+
+#define W(op, arg) ((uint32_t)(op) << 24 | (arg))
+
+static void rechazar(const char *nombre, const uint32_t *codigo, uint32_t longitud) {
+    if (sec_validar(codigo, longitud)) {
+        printf("FALLO aceptado: %s\n", nombre);
+        errores++;
+    }
+}
+
+static void probar_validador(void) {
+    // El propio bucle como destino: saltaría a sí mismo sin consumir tiempo
+    const uint32_t auto_bucle[] = { W(SEC_PAUSA, 0), 100, W(SEC_BUCLE, 3), 2, W(SEC_FIN, 0) };
+    rechazar("bucle que salta a sí mismo", auto_bucle, 5);
+    const uint32_t auto_bucle_fin[] = { W(SEC_PAUSA, 0), 100, W(SEC_BUCLE, 0), 2, W(SEC_FIN, 0) };
+    rechazar("bucle sin fin que salta a sí mismo", auto_bucle_fin, 5);
+    // Cuerpo formado solo por otro bucle
+    const uint32_t solo_bucles[] = { W(SEC_PAUSA, 0), 100, W(SEC_BUCLE, 2), 0, W(SEC_BUCLE, 2), 2, W(SEC_FIN, 0) };
+    rechazar("bucle cuyo cuerpo es otro bucle", solo_bucles, 7);
+    const uint32_t adelante[] = { W(SEC_PAUSA, 0), 100, W(SEC_BUCLE, 2), 4, W(SEC_FIN, 0) };
+    rechazar("salto hacia adelante", adelante, 5);
+    const uint32_t en_medio[] = { W(SEC_PAUSA, 0), 100, W(SEC_BUCLE, 2), 1, W(SEC_FIN, 0) };
+    rechazar("salto a mitad de instrucción", en_medio, 5);
+    const uint32_t nivel[] = { W(SEC_PAUSA, 0), 100, W(SEC_BUCLE, SEC_MAX_BUCLES << 16 | 2), 0, W(SEC_FIN, 0) };
+    rechazar("nivel de bucle fuera de rango", nivel, 5);
+    const uint32_t cortado[] = { W(SEC_TONO, 0), 5000, 0, 1 };
+    rechazar("instrucción cortada", cortado, 4);
+    const uint32_t op[] = { W(SEC_NUM_OPS, 0) };
+    rechazar("operación desconocida", op, 1);
+    const uint32_t sin_duracion[] = { W(SEC_TONO, 0), 5000, 0, 1, 0, W(SEC_FIN, 0) };
+    rechazar("tono sin duración", sin_duracion, 6);
+    const uint32_t resto[] = { W(SEC_TONO, 0), 5000, 3, 3, 100, W(SEC_FIN, 0) };
+    rechazar("resto no menor que el divisor", resto, 6);
+    const uint32_t sin_pulsos[] = { W(SEC_RAFAGA, 0), 5000, 0, 1, W(SEC_FIN, 0) };
+    rechazar("ráfaga sin pulsos", sin_pulsos, 5);
+    const uint32_t pausa_nula[] = { W(SEC_PAUSA, 0), 0, W(SEC_FIN, 0) };
+    rechazar("pausa nula", pausa_nula, 3);
+    rechazar("programa vacío", pausa_nula, 0);
+    static uint32_t largo[SEC_MAX_PALABRAS + 1];
+    rechazar("programa demasiado largo", largo, SEC_MAX_PALABRAS + 1);
+
+    // El emisor tampoco genera lo que el validador rechazaría
+    uint32_t codigo[4];
+    sec_programa_t p;
+    sec_programa_iniciar(&p, codigo, 4);
+    dds_flancos_t f = flancos(1000);
+    comprobar(!sec_emitir_tono(&p, &f, 0), "emisor acepta tono sin duración");
+    comprobar(!sec_emitir_bucle(&p, 0, SEC_MAX_BUCLES, 1), "emisor acepta nivel fuera de rango");
+    comprobar(!sec_emitir_tono(&p, &f, 1) && p.desbordado, "emisor no marca desbordamiento");
+    comprobar(!sec_emitir_fin(&p), "emisor escribe tras desbordar");
+}
+
+int main(void) {
+    probar_ejemplo();
+    probar_frecuencia_fraccionaria();
+    probar_bucle_infinito();
+    probar_validador();
+    printf("%s (%d errores)\n", errores ? "FALLA" : "OK", errores);
+    return errores != 0;
+}
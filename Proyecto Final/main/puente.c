@@ -0,0 +1,257 @@
+#include "puente.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/mcpwm_prelude.h"
+#include "placa.h"
+
+#define TAG "PUENTE"
+#define PUENTE_GRUPO 0
+
+static const int pin_alto[PUENTE_RAMAS] = { PLACA_AIN1, PLACA_BIN1 };
+static const int pin_bajo[PUENTE_RAMAS] = { PLACA_AIN2, PLACA_BIN2 };
+static const int pin_habilitar[PUENTE_RAMAS] = { PLACA_PWMA, PLACA_PWMB };
+
+static mcpwm_timer_handle_t temporizadores[PUENTE_RAMAS];
+static mcpwm_oper_handle_t operadores[PUENTE_RAMAS];
+static mcpwm_cmpr_handle_t comparadores[PUENTE_RAMAS];
+static mcpwm_gen_handle_t generadores[PUENTE_RAMAS][2];
+static mcpwm_sync_handle_t sincronia;
+static mcpwm_fault_handle_t falla;
+static puente_tiempos_t tiempos_actuales;
+static volatile bool en_falla;
+static bool activo;
+
+static bool IRAM_ATTR falla_entrada_cb(mcpwm_fault_handle_t f, const mcpwm_fault_event_data_t *edata, void *arg) {
+    en_falla = true;
+    return false;
+}
+
+static esp_err_t crear_falla(void) {
+    mcpwm_gpio_fault_config_t falla_config = {
+        .group_id = PUENTE_GRUPO,
+        .gpio_num = PLACA_FALLA,
+        .flags.active_level = 0,
+        .flags.pull_up = true,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_new_gpio_fault(&falla_config, &falla), TAG, "entrada de falla");
+    mcpwm_fault_event_callbacks_t cbs = {
+        .on_fault_enter = falla_entrada_cb,
+    };
+    return mcpwm_fault_register_event_callbacks(falla, &cbs, NULL);
+}
+
+// Lado alto: sube en cero y baja en la comparación; el tiempo muerto retrasa
+// su subida. Lado bajo: la misma señal invertida con la bajada retrasada, así
+// nunca conducen los dos transistores a la vez.
+static esp_err_t crear_rama(int r, const puente_tiempos_t *t) {
+    mcpwm_timer_config_t timer_config = {
+        .group_id = PUENTE_GRUPO,
+        .clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT,
+        .resolution_hz = t->resolucion_hz,
+        .count_mode = MCPWM_TIMER_COUNT_MODE_UP,
+        .period_ticks = t->periodo_ticks,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_new_timer(&timer_config, &temporizadores[r]), TAG, "sin temporizador MCPWM libre");
+
+    mcpwm_operator_config_t operador_config = {
+        .group_id = PUENTE_GRUPO,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_new_operator(&operador_config, &operadores[r]), TAG, "sin operador MCPWM libre");
+    ESP_RETURN_ON_ERROR(mcpwm_operator_connect_timer(operadores[r], temporizadores[r]), TAG, "operador");
+
+    mcpwm_comparator_config_t comparador_config = {
+        .flags.update_cmp_on_tez = true,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_new_comparator(operadores[r], &comparador_config, &comparadores[r]), TAG, "comparador");
+    ESP_RETURN_ON_ERROR(mcpwm_comparator_set_compare_value(comparadores[r], t->comparacion_ticks[r]), TAG, "comparador");
+
+    int pines[2] = { pin_alto[r], pin_bajo[r] };
+    for (int lado = 0; lado < 2; lado++) {
+        mcpwm_generator_config_t generador_config = {
+            .gen_gpio_num = pines[lado],
+        };
+        ESP_RETURN_ON_ERROR(mcpwm_new_generator(operadores[r], &generador_config, &generadores[r][lado]), TAG, "generador");
+    }
+    mcpwm_gen_handle_t alto = generadores[r][0];
+    mcpwm_gen_handle_t bajo = generadores[r][1];
+    ESP_RETURN_ON_ERROR(mcpwm_generator_set_action_on_timer_event(alto,
+                        MCPWM_GEN_TIMER_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_TIMER_EVENT_EMPTY, MCPWM_GEN_ACTION_HIGH)),
+                        TAG, "acción en cero");
+    ESP_RETURN_ON_ERROR(mcpwm_generator_set_action_on_compare_event(alto,
+                        MCPWM_GEN_COMPARE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, comparadores[r], MCPWM_GEN_ACTION_LOW)),
+                        TAG, "acción en comparación");
+
+    mcpwm_dead_time_config_t muerto_alto = {
+        .posedge_delay_ticks = t->muerto_ticks,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_generator_set_dead_time(alto, alto, &muerto_alto), TAG, "tiempo muerto");
+    mcpwm_dead_time_config_t muerto_bajo = {
+        .negedge_delay_ticks = t->muerto_ticks,
+        .flags.invert_output = true,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_generator_set_dead_time(alto, bajo, &muerto_bajo), TAG, "tiempo muerto");
+
+    // El paro actúa después del tiempo muerto: ambas salidas quedan en bajo
+    mcpwm_brake_config_t paro = {
+        .fault = falla,
+        .brake_mode = MCPWM_OPER_BRAKE_MODE_OST,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_operator_set_brake_on_fault(operadores[r], &paro), TAG, "paro por falla");
+    for (int lado = 0; lado < 2; lado++) {
+        ESP_RETURN_ON_ERROR(mcpwm_generator_set_action_on_brake_event(generadores[r][lado],
+                            MCPWM_GEN_BRAKE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_OPER_BRAKE_MODE_OST, MCPWM_GEN_ACTION_LOW)),
+                            TAG, "acción de paro");
+    }
+    return ESP_OK;
+}
+
+// La rama B carga (periodo - desfase) cada vez que la A pasa por cero, así
+// queda retrasada exactamente desfase_ticks.
+static esp_err_t sincronizar(const puente_tiempos_t *t) {
+    mcpwm_timer_sync_src_config_t fuente = {
+        .timer_event = MCPWM_TIMER_EVENT_EMPTY,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_new_timer_sync_src(temporizadores[0], &fuente, &sincronia), TAG, "sincronía");
+    mcpwm_timer_sync_phase_config_t fase = {
+        .sync_src = sincronia,
+        .count_value = (t->periodo_ticks - t->desfase_ticks) % t->periodo_ticks,
+        .direction = MCPWM_TIMER_DIRECTION_UP,
+    };
+    return mcpwm_timer_set_phase_on_sync(temporizadores[1], &fase);
+}
+
+static void liberar(void) {
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        for (int lado = 0; lado < 2; lado++) {
+            if (generadores[r][lado] != NULL) {
+                mcpwm_del_generator(generadores[r][lado]);
+                generadores[r][lado] = NULL;
+            }
+        }
+        if (comparadores[r] != NULL) {
+            mcpwm_del_comparator(comparadores[r]);
+            comparadores[r] = NULL;
+        }
+        if (operadores[r] != NULL) {
+            mcpwm_del_operator(operadores[r]);
+            operadores[r] = NULL;
+        }
+    }
+    if (sincronia != NULL) {
+        mcpwm_del_sync_src(sincronia);
+        sincronia = NULL;
+    }
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        if (temporizadores[r] != NULL) {
+            mcpwm_timer_disable(temporizadores[r]);
+            mcpwm_del_timer(temporizadores[r]);
+            temporizadores[r] = NULL;
+        }
+    }
+    if (falla != NULL) {
+        mcpwm_del_fault(falla);
+        falla = NULL;
+    }
+}
+
+static esp_err_t crear(const puente_tiempos_t *t) {
+    ESP_RETURN_ON_ERROR(crear_falla(), TAG, "falla");
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        ESP_RETURN_ON_ERROR(crear_rama(r, t), TAG, "rama %d", r);
+    }
+    ESP_RETURN_ON_ERROR(sincronizar(t), TAG, "sincronía");
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        ESP_RETURN_ON_ERROR(mcpwm_timer_enable(temporizadores[r]), TAG, "habilitar");
+    }
+    return ESP_OK;
+}
+
+esp_err_t puente_iniciar(const puente_config_t *cfg, puente_tiempos_t *tiempos) {
+    ESP_RETURN_ON_ERROR(puente_armar(cfg, tiempos), TAG, "armar");
+    return puente_disparar();
+}
+
+esp_err_t puente_armar(const puente_config_t *cfg, puente_tiempos_t *tiempos) {
+    puente_tiempos_t t;
+    if (!puente_calcular(cfg, &t)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    puente_detener();
+
+    en_falla = false;
+    esp_err_t err = crear(&t);
+    if (err != ESP_OK) {
+        liberar();
+        return err;
+    }
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        gpio_set_direction(pin_habilitar[r], GPIO_MODE_OUTPUT);
+        gpio_set_level(pin_habilitar[r], 1);
+    }
+    gpio_set_direction(PLACA_STBY, GPIO_MODE_OUTPUT);
+    gpio_set_level(PLACA_STBY, 1);
+
+    tiempos_actuales = t;
+    activo = true;
+    if (tiempos != NULL) {
+        *tiempos = t;
+    }
+    ESP_LOGI(TAG, "Puente a %lu ticks de %lu Hz, muerto %lu, desfase %lu", (unsigned long)t.periodo_ticks,
+             (unsigned long)t.resolucion_hz, (unsigned long)t.muerto_ticks, (unsigned long)t.desfase_ticks);
+    return ESP_OK;
+}
+
+// La B arranca primero; se alinea en el primer cero de la A
+esp_err_t puente_disparar(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int r = PUENTE_RAMAS - 1; r >= 0; r--) {
+        ESP_RETURN_ON_ERROR(mcpwm_timer_start_stop(temporizadores[r], MCPWM_TIMER_START_NO_STOP), TAG, "arrancar");
+    }
+    return ESP_OK;
+}
+
+// El comparador se actualiza en el cero del contador: sin pulsos cortados
+esp_err_t puente_fijar_duty(int rama, uint16_t duty_permil) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (rama < 0 || rama >= PUENTE_RAMAS || duty_permil > PUENTE_PERMIL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    tiempos_actuales.comparacion_ticks[rama] = puente_comparacion(&tiempos_actuales, duty_permil);
+    return mcpwm_comparator_set_compare_value(comparadores[rama], tiempos_actuales.comparacion_ticks[rama]);
+}
+
+esp_err_t puente_detener(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gpio_set_level(PLACA_STBY, 0);
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        gpio_set_level(pin_habilitar[r], 0);
+        mcpwm_timer_start_stop(temporizadores[r], MCPWM_TIMER_STOP_EMPTY);
+    }
+    liberar();
+    activo = false;
+    return ESP_OK;
+}
+
+bool puente_en_falla(void) {
+    return en_falla;
+}
+
+// Solo se libera el paro si la entrada de falla ya volvió a reposo
+esp_err_t puente_rearmar(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        ESP_RETURN_ON_ERROR(mcpwm_operator_recover_from_fault(operadores[r], falla), TAG, "falla aún activa");
+    }
+    en_falla = false;
+    return ESP_OK;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "puente_modelo.h"
+
+// Puente H del driver tipo TB6612 por MCPWM: cada rama lleva IN1/IN2 como
+// par complementario con tiempo muerto (PWMx fijo en alto, antifase
+// bloqueada) y la rama B sigue a la A con el desfase pedido.
+esp_err_t puente_iniciar(const puente_config_t *cfg, puente_tiempos_t *tiempos);
+// Armar crea y habilita todo con los contadores parados; disparar solo los
+// arranca.
+esp_err_t puente_armar(const puente_config_t *cfg, puente_tiempos_t *tiempos);
+esp_err_t puente_disparar(void);
+esp_err_t puente_fijar_duty(int rama, uint16_t duty_permil);
+esp_err_t puente_detener(void);
+
+// La entrada de falla (activa en bajo) apaga las cuatro salidas por
+// hardware hasta que se rearma con la entrada ya inactiva.
+bool puente_en_falla(void);
+esp_err_t puente_rearmar(void);
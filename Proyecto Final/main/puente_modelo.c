@@ -0,0 +1,61 @@
+#include "puente_modelo.h"
+#include "dds.h"
+
+// Resoluciones alcanzables con el preescalador del temporizador MCPWM
+static const uint32_t resoluciones_hz[] = { 40000000, 20000000, 10000000, 5000000, 1000000 };
+
+uint32_t puente_comparacion(const puente_tiempos_t *t, uint16_t duty_permil) {
+    if (duty_permil > PUENTE_PERMIL_MAX) {
+        duty_permil = PUENTE_PERMIL_MAX;
+    }
+    return (uint32_t)(((uint64_t)t->periodo_ticks * duty_permil + PUENTE_PERMIL_MAX / 2) / PUENTE_PERMIL_MAX);
+}
+
+bool puente_calcular(const puente_config_t *cfg, puente_tiempos_t *t) {
+    if (cfg->desfase_grados >= 360) {
+        return false;
+    }
+    t->periodo_ticks = 0;
+    for (unsigned i = 0; i < sizeof(resoluciones_hz) / sizeof(resoluciones_hz[0]); i++) {
+        uint64_t periodo = dds_periodo_ticks(cfg->frecuencia_mhz, resoluciones_hz[i]);
+        if (periodo >= PUENTE_MIN_TICKS && periodo <= PUENTE_MAX_TICKS) {
+            t->resolucion_hz = resoluciones_hz[i];
+            t->periodo_ticks = (uint32_t)periodo;
+            break;
+        }
+    }
+    if (t->periodo_ticks == 0) {
+        return false;
+    }
+
+    t->muerto_ticks = (uint32_t)(((uint64_t)cfg->muerto_ns * t->resolucion_hz + 999999999ULL) / 1000000000ULL);
+    if (2 * t->muerto_ticks >= t->periodo_ticks) {
+        return false;
+    }
+    for (int r = 0; r < PUENTE_RAMAS; r++) {
+        t->comparacion_ticks[r] = puente_comparacion(t, cfg->duty_permil[r]);
+    }
+    t->desfase_ticks = (uint32_t)(((uint64_t)t->periodo_ticks * cfg->desfase_grados + 180) / 360) % t->periodo_ticks;
+    return true;
+}
+
+uint64_t puente_frecuencia_real(const puente_tiempos_t *t) {
+    return dds_frecuencia_ticks(t->periodo_ticks, t->resolucion_hz);
+}
+
+void puente_pulso(const puente_tiempos_t *t, int rama, bool lado_alto, puente_pulso_t *p) {
+    uint32_t cmp = t->comparacion_ticks[rama];
+    uint32_t desfase = rama == 0 ? 0 : t->desfase_ticks;
+    uint32_t subida, bajada;
+    if (lado_alto) {
+        p->activa = cmp > t->muerto_ticks;
+        subida = t->muerto_ticks;
+        bajada = cmp;
+    } else {
+        p->activa = cmp + t->muerto_ticks < t->periodo_ticks;
+        subida = cmp + t->muerto_ticks;
+        bajada = t->periodo_ticks;
+    }
+    p->subida = (subida + desfase) % t->periodo_ticks;
+    p->bajada = (bajada + desfase) % t->periodo_ticks;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Modelo de tiempos del puente: traduce la configuración a ticks del MCPWM y
+// da los intervalos en alto de cada salida dentro del periodo. Lo usa el
+// firmware para programar el periférico y no depende de ESP-IDF, así que
+// también compila en el host para revisar tiempos muertos y desfases.
+
+#define PUENTE_RAMAS 2
+#define PUENTE_MAX_TICKS 65535u
+#define PUENTE_MIN_TICKS 20u
+#define PUENTE_PERMIL_MAX 1000u
+
+typedef struct {
+    uint64_t frecuencia_mhz;
+    uint16_t duty_permil[PUENTE_RAMAS];
+    uint32_t muerto_ns;
+    uint16_t desfase_grados;            // retraso de la rama B respecto a la A
+} puente_config_t;
+
+typedef struct {
+    uint32_t resolucion_hz;
+    uint32_t periodo_ticks;
+    uint32_t comparacion_ticks[PUENTE_RAMAS];
+    uint32_t muerto_ticks;
+    uint32_t desfase_ticks;
+} puente_tiempos_t;
+
+// Intervalo en alto [subida, bajada) en ticks desde el inicio del periodo de
+// la rama A; si bajada < subida el pulso cruza el fin del periodo y si son
+// iguales (duty 0 o 100 % sin tiempo muerto) ocupa el periodo entero.
+typedef struct {
+    bool activa;
+    uint32_t subida;
+    uint32_t bajada;
+} puente_pulso_t;
+
+// Elige la mayor resolución con la que el periodo cabe en el contador de
+// 16 bits; falla si el tiempo muerto no deja sitio a ningún pulso.
+bool puente_calcular(const puente_config_t *cfg, puente_tiempos_t *t);
+uint64_t puente_frecuencia_real(const puente_tiempos_t *t);
+uint32_t puente_comparacion(const puente_tiempos_t *t, uint16_t duty_permil);
+
+// Lado alto: sube con el contador en cero retrasado el tiempo muerto y baja
+// en la comparación. Lado bajo: complemento con la subida retrasada. El
+// firmware no lo necesita; prueba_puente.c lo usa para revisar los tiempos.
+void puente_pulso(const puente_tiempos_t *t, int rama, bool lado_alto, puente_pulso_t *p);
@@ -0,0 +1,263 @@
+#include "pwm.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "dds.h"
+#include "planificador.h"
+#include "recursos.h"
+
+#define TAG "PWM"
+#define PWM_MAX_PASOS 1023
+#define PWM_MAX_ESCALA 1023
+#define PWM_MAX_CICLOS 1023
+// Bits de la notificación de la tarea de fundidos
+#define AVISO_FIN_TROZO (1u << 0)
+#define AVISO_LISTA_NUEVA (1u << 1)
+
+_Static_assert(LEDC_RELOJ_HZ == PLAN_RELOJ_APB_HZ, "el planificador supone el reloj del LEDC");
+
+static uint32_t bits;
+static uint64_t frecuencia_real_mhz;
+static bool configurado;
+static bool fundido_instalado;
+
+// Lista y avance del fundido, protegidos por mutex_fundido
+static pwm_segmento_t segmentos[PWM_MAX_SEGMENTOS];
+static int num_segmentos;
+static int segmento_actual;
+static bool repetir_fundido;
+static bool fundiendo;
+static bool trozo_en_curso;
+static uint32_t duty_inicio;        // al empezar el tramo en curso
+static uint32_t total_us;
+static uint32_t transcurrido_us;
+static SemaphoreHandle_t mutex_fundido;
+static TaskHandle_t tarea_fundido;
+
+esp_err_t pwm_configurar(int gpio, uint64_t frecuencia_mhz, uint64_t *real_mhz) {
+    return pwm_configurar_bits(gpio, frecuencia_mhz, DDS_LEDC_BITS_MAX, real_mhz);
+}
+
+esp_err_t pwm_configurar_bits(int gpio, uint64_t frecuencia_mhz, uint32_t bits_preferidos, uint64_t *real_mhz) {
+    ESP_RETURN_ON_ERROR(pwm_armar_bits(gpio, frecuencia_mhz, bits_preferidos, real_mhz), TAG, "armar");
+    return pwm_disparar();
+}
+
+esp_err_t pwm_armar_bits(int gpio, uint64_t frecuencia_mhz, uint32_t bits_preferidos, uint64_t *real_mhz) {
+    dds_ledc_t ledc;
+    if (bits_preferidos < 1 || bits_preferidos > DDS_LEDC_BITS_MAX ||
+        !dds_ledc_calcular(&ledc, frecuencia_mhz, LEDC_RELOJ_HZ, bits_preferidos)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pwm_fundido_detener();
+
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = PWM_LEDC_MODO,
+        .timer_num = PWM_LEDC_TIMER,
+        .duty_resolution = ledc.bits,
+        .freq_hz = frecuencia_mhz < DDS_MHZ_POR_HZ ? 1 : (uint32_t)((frecuencia_mhz + DDS_MHZ_POR_HZ / 2) / DDS_MHZ_POR_HZ),
+        .clk_cfg = LEDC_USE_APB_CLK
+    };
+    ledc_timer_config(&ledc_timer);
+    ESP_RETURN_ON_ERROR(ledc_timer_pause(PWM_LEDC_MODO, PWM_LEDC_TIMER), TAG, "pausar");
+    ESP_RETURN_ON_ERROR(ledc_timer_set(PWM_LEDC_MODO, PWM_LEDC_TIMER, ledc.divisor_q8, ledc.bits, LEDC_APB_CLK),
+                        TAG, "divisor LEDC fuera de rango");
+
+    ledc_channel_config_t ledc_channel = {
+        .gpio_num = gpio,
+        .speed_mode = PWM_LEDC_MODO,
+        .channel = PWM_LEDC_CANAL,
+        .timer_sel = PWM_LEDC_TIMER,
+        .duty = 1u << (ledc.bits - 1),
+        .hpoint = 0
+    };
+    ESP_RETURN_ON_ERROR(ledc_channel_config(&ledc_channel), TAG, "canal LEDC");
+    ESP_RETURN_ON_ERROR(ledc_timer_rst(PWM_LEDC_MODO, PWM_LEDC_TIMER), TAG, "reiniciar contador");
+
+    bits = ledc.bits;
+    frecuencia_real_mhz = dds_ledc_frecuencia(&ledc, LEDC_RELOJ_HZ);
+    configurado = true;
+    if (real_mhz != NULL) {
+        *real_mhz = frecuencia_real_mhz;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pwm_disparar(void) {
+    if (!configurado) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ledc_timer_resume(PWM_LEDC_MODO, PWM_LEDC_TIMER);
+}
+
+esp_err_t pwm_detener(void) {
+    if (!configurado) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pwm_fundido_detener();
+    configurado = false;
+    return ledc_stop(PWM_LEDC_MODO, PWM_LEDC_CANAL, 0);
+}
+
+uint32_t pwm_duty_maximo(void) {
+    return configurado ? 1u << bits : 0;
+}
+
+static bool IRAM_ATTR fundido_terminado_cb(const ledc_cb_param_t *param, void *user_arg) {
+    BaseType_t despertar = pdFALSE;
+    if (param->event == LEDC_FADE_END_EVT) {
+        xTaskNotifyFromISR(tarea_fundido, AVISO_FIN_TROZO, eSetBits, &despertar);
+    }
+    return despertar == pdTRUE;
+}
+
+// Reparte el cambio de duty en pasos de 'escala' cuentas cada 'ciclos'
+// periodos PWM, respetando los campos de 10 bits del LEDC.
+static esp_err_t iniciar_trozo(uint32_t duty_final, uint32_t tiempo_us) {
+    uint32_t actual = ledc_get_duty(PWM_LEDC_MODO, PWM_LEDC_CANAL);
+    uint32_t delta = duty_final > actual ? duty_final - actual : actual - duty_final;
+    uint64_t periodos = (uint64_t)tiempo_us * frecuencia_real_mhz / 1000000000ULL;
+    if (delta == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (periodos == 0) {
+        periodos = 1;
+    }
+
+    uint32_t escala = delta > periodos ? (delta + periodos - 1) / periodos : 1;
+    if (delta / escala > PWM_MAX_PASOS) {
+        escala = (delta + PWM_MAX_PASOS - 1) / PWM_MAX_PASOS;
+    }
+    uint64_t ciclos = periodos * escala / delta;
+    escala = escala > PWM_MAX_ESCALA ? PWM_MAX_ESCALA : escala;
+    ciclos = ciclos == 0 ? 1 : (ciclos > PWM_MAX_CICLOS ? PWM_MAX_CICLOS : ciclos);
+
+    ESP_RETURN_ON_ERROR(ledc_set_fade_with_step(PWM_LEDC_MODO, PWM_LEDC_CANAL, duty_final, escala, ciclos),
+                        TAG, "fundido");
+    return ledc_fade_start(PWM_LEDC_MODO, PWM_LEDC_CANAL, LEDC_FADE_NO_WAIT);
+}
+
+// Con el mutex tomado. Arranca el siguiente trozo del tramo en curso o del
+// siguiente; los destinos se calculan desde el inicio del tramo para que el
+// redondeo no se acumule. Devuelve cuánto esperar: hasta el fin del trozo
+// por hardware, o su duración si no cambia el duty y solo pasa el tiempo.
+static TickType_t siguiente_trozo(void) {
+    if (transcurrido_us >= total_us) {
+        if (++segmento_actual >= num_segmentos) {
+            if (!repetir_fundido) {
+                fundiendo = false;
+                return portMAX_DELAY;
+            }
+            segmento_actual = 0;
+        }
+        duty_inicio = ledc_get_duty(PWM_LEDC_MODO, PWM_LEDC_CANAL);
+        total_us = segmentos[segmento_actual].tiempo_us > 0 ? segmentos[segmento_actual].tiempo_us : 1;
+        transcurrido_us = 0;
+    }
+    uint32_t us = total_us - transcurrido_us < PWM_FUNDIDO_TROZO_US ? total_us - transcurrido_us
+                                                                    : PWM_FUNDIDO_TROZO_US;
+    transcurrido_us += us;
+    int64_t delta = (int64_t)segmentos[segmento_actual].duty_final - duty_inicio;
+    uint32_t destino = (uint32_t)(duty_inicio + delta * transcurrido_us / total_us);
+    esp_err_t err = iniciar_trozo(destino, us);
+    if (err == ESP_OK) {
+        trozo_en_curso = true;
+        return portMAX_DELAY;
+    }
+    if (err != ESP_ERR_INVALID_SIZE) {
+        fundiendo = false;
+        return portMAX_DELAY;
+    }
+    TickType_t ticks = pdMS_TO_TICKS((us + 999) / 1000);
+    return ticks > 0 ? ticks : 1;
+}
+
+// Solo despierta una vez por trozo; los pasos dentro del trozo los da el LEDC
+static void fundido_task(void *param) {
+    TickType_t espera = portMAX_DELAY;
+    while (1) {
+        uint32_t avisos = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &avisos, espera);
+        xSemaphoreTake(mutex_fundido, portMAX_DELAY);
+        if (avisos & AVISO_FIN_TROZO) {
+            trozo_en_curso = false;
+        }
+        espera = fundiendo && !trozo_en_curso ? siguiente_trozo() : portMAX_DELAY;
+        xSemaphoreGive(mutex_fundido);
+    }
+}
+
+static esp_err_t instalar_fundido(void) {
+    if (fundido_instalado) {
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(ledc_fade_func_install(0), TAG, "servicio de fundido");
+    mutex_fundido = xSemaphoreCreateMutex();
+    if (mutex_fundido == NULL ||
+        xTaskCreate(fundido_task, "fundido_task", 2048, NULL, 10, &tarea_fundido) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ledc_cbs_t cbs = {
+        .fade_cb = fundido_terminado_cb,
+    };
+    ESP_RETURN_ON_ERROR(ledc_cb_register(PWM_LEDC_MODO, PWM_LEDC_CANAL, &cbs, NULL), TAG, "callback de fundido");
+    fundido_instalado = true;
+    return ESP_OK;
+}
+
+esp_err_t pwm_fijar_duty(uint32_t duty) {
+    if (!configurado || duty > pwm_duty_maximo()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_RETURN_ON_ERROR(instalar_fundido(), TAG, "fundido");
+    pwm_fundido_detener();
+    return ledc_set_duty_and_update(PWM_LEDC_MODO, PWM_LEDC_CANAL, duty, 0);
+}
+
+esp_err_t pwm_fundido(const pwm_segmento_t *segs, int n, bool repetir) {
+    if (!configurado || n < 1 || n > PWM_MAX_SEGMENTOS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < n; i++) {
+        if (segs[i].duty_final > pwm_duty_maximo()) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    ESP_RETURN_ON_ERROR(instalar_fundido(), TAG, "fundido");
+
+    // La tarea solo lee la lista con el mutex tomado; si hay un trozo en
+    // curso, la nueva arranca desde donde él termine
+    xSemaphoreTake(mutex_fundido, portMAX_DELAY);
+    memcpy(segmentos, segs, n * sizeof(pwm_segmento_t));
+    num_segmentos = n;
+    segmento_actual = -1;
+    transcurrido_us = 0;
+    total_us = 0;
+    repetir_fundido = repetir;
+    fundiendo = true;
+    xSemaphoreGive(mutex_fundido);
+    xTaskNotify(tarea_fundido, AVISO_LISTA_NUEVA, eSetBits);
+    return ESP_OK;
+}
+
+esp_err_t pwm_fundido_detener(void) {
+    if (!fundido_instalado) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(mutex_fundido, portMAX_DELAY);
+    bool estaba = fundiendo;
+    fundiendo = false;
+#if SOC_LEDC_SUPPORT_FADE_STOP
+    // El trozo se corta donde va y no llega aviso de fin
+    if (trozo_en_curso) {
+        ledc_fade_stop(PWM_LEDC_MODO, PWM_LEDC_CANAL);
+        trozo_en_curso = false;
+    }
+#endif
+    xSemaphoreGive(mutex_fundido);
+    return estaba ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
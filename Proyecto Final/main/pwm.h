@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Salida PWM por LEDC con duty preciso y fundidos por hardware
+#define PWM_MAX_SEGMENTOS 16
+// Los tramos se parten en fundidos de hardware de como mucho este tiempo
+#define PWM_FUNDIDO_TROZO_US 50000
+
+// Tramo de fundido: el hardware lleva el duty hasta duty_final en tiempo_us
+typedef struct {
+    uint32_t duty_final;
+    uint32_t tiempo_us;
+} pwm_segmento_t;
+
+// Configura frecuencia y pin con la mayor resolución de duty posible; deja
+// el duty al 50 %.
+esp_err_t pwm_configurar(int gpio, uint64_t frecuencia_mhz, uint64_t *real_mhz);
+// Igual, pero partiendo de bits_preferidos de duty: menos bits dan un divisor mayor y
+// una frecuencia más exacta (lo que elige el planificador).
+esp_err_t pwm_configurar_bits(int gpio, uint64_t frecuencia_mhz, uint32_t bits_preferidos, uint64_t *real_mhz);
+// Lo mismo en dos pasos: armar deja el contador en pausa y a cero, y
+// disparar lo reanuda (lo que programa la agenda).
+esp_err_t pwm_armar_bits(int gpio, uint64_t frecuencia_mhz, uint32_t bits_preferidos, uint64_t *real_mhz);
+esp_err_t pwm_disparar(void);
+esp_err_t pwm_detener(void);
+uint32_t pwm_duty_maximo(void);
+esp_err_t pwm_fijar_duty(uint32_t duty);
+
+// Encadena los tramos: al terminar cada trozo la interrupción del LEDC
+// despierta una tarea que programa el siguiente. Con repetir, vuelve al
+// primero (respiración, modulación periódica). No espera al hardware: la
+// lista nueva la toma la tarea al acabar el trozo en curso.
+esp_err_t pwm_fundido(const pwm_segmento_t *segmentos, int num_segmentos, bool repetir);
+// Sin parada de fundidos en el LEDC (ESP32) el trozo en curso acaba solo, y
+// el siguiente cambio de duty espera a lo sumo PWM_FUNDIDO_TROZO_US.
+esp_err_t pwm_fundido_detener(void);
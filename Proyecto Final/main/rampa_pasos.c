@@ -0,0 +1,69 @@
+#include "rampa_pasos.h"
+#include <math.h>
+
+bool rampa_planificar(rampa_t *r, uint32_t pasos, uint32_t vel_max_pps, uint32_t acel_pps2, uint32_t resolucion_hz) {
+    if (pasos == 0 || vel_max_pps == 0 || acel_pps2 == 0 || vel_max_pps > resolucion_hz) {
+        return false;
+    }
+    // Primer intervalo corregido por 0,676 (error de la recurrencia en n = 1)
+    double c0 = 0.676 * resolucion_hz * sqrt(2.0 / acel_pps2) * (1u << RAMPA_Q);
+    if (c0 >= RAMPA_C_MAX_Q8) {
+        return false;
+    }
+    uint32_t c_min_q8 = (uint32_t)(((uint64_t)resolucion_hz << RAMPA_Q) / vel_max_pps);
+
+    // Pasos hasta la velocidad máxima, v² / 2a; en trayectos cortos la mitad
+    uint64_t n_acel = (uint64_t)vel_max_pps * vel_max_pps / (2ull * acel_pps2);
+    bool llega = n_acel <= pasos / 2;
+    if (!llega) {
+        n_acel = pasos / 2;
+    }
+
+    *r = (rampa_t){ .num_segmentos = RAMPA_MAX_SEGMENTOS, .c_min_q8 = c_min_q8, .seg = -1 };
+    r->segmentos[0] = (rampa_segmento_t){ RAMPA_ACELERA, (uint32_t)n_acel, (uint32_t)c0, 0 };
+
+    // El crucero y el frenado arrancan del último intervalo de la subida. Si
+    // la subida completa los v² / 2a pasos, ese intervalo es c_min: la
+    // recurrencia solo se le acerca y el crucero iría algo más lento.
+    uint32_t c_fin_q8 = c_min_q8;
+    if (!llega) {
+        rampa_t subida = *r;
+        subida.num_segmentos = 1;
+        c_fin_q8 = (uint32_t)c0;
+        for (uint64_t i = 0; i < n_acel; i++) {
+            rampa_siguiente(&subida);
+            c_fin_q8 = subida.c_q8;
+        }
+        if (c_fin_q8 < c_min_q8) {
+            c_fin_q8 = c_min_q8;
+        }
+    }
+    r->segmentos[1] = (rampa_segmento_t){ RAMPA_CRUCERO, pasos - 2 * (uint32_t)n_acel, c_fin_q8, 0 };
+    r->segmentos[2] = (rampa_segmento_t){ RAMPA_FRENA, (uint32_t)n_acel, c_fin_q8, -(int32_t)n_acel };
+    return true;
+}
+
+void rampa_frenar(rampa_t *r) {
+    if (r->seg < 0) {
+        r->num_segmentos = 0;
+        return;
+    }
+    if (r->seg >= r->num_segmentos) {
+        return;
+    }
+    rampa_segmento_t *frenado = &r->segmentos[RAMPA_MAX_SEGMENTOS - 1];
+    switch (r->segmentos[r->seg].tipo) {
+    case RAMPA_ACELERA:
+        // Tantos pasos como los que lleva acelerando, desde el intervalo actual
+        frenado->pasos = (uint32_t)r->n + 1;
+        frenado->c_q8 = r->c_q8;
+        frenado->n = -(int32_t)frenado->pasos;
+        break;
+    case RAMPA_CRUCERO:
+        break;
+    case RAMPA_FRENA:
+        return;
+    }
+    r->seg = RAMPA_MAX_SEGMENTOS - 2;
+    r->restantes = 0;
+}
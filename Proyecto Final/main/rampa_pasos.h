@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Rampas de velocidad para motores paso a paso (método de la nota AVR446).
+// El plan se precalcula en tres segmentos (acelerar, crucero, frenar); dentro
+// de cada uno el intervalo del paso siguiente sale de la recurrencia
+// c_n = c_{n-1} - 2·c_{n-1} / (4n + 1), una división entera por paso cuyo
+// resto pasa al paso siguiente, como en la nota: sin él la subida pierde la
+// fracción en cada paso y se queda por debajo de la velocidad pedida.
+// No depende de ESP-IDF. Intervalos en ticks del temporizador, en Q8.
+
+#define RAMPA_Q 8
+#define RAMPA_MAX_SEGMENTOS 3
+// 2·c debe caber en un int32 con signo
+#define RAMPA_C_MAX_Q8 (1u << 29)
+
+typedef enum {
+    RAMPA_ACELERA,
+    RAMPA_CRUCERO,
+    RAMPA_FRENA
+} rampa_tipo_t;
+
+// Al entrar al segmento el intervalo pasa a c_q8 y el índice de rampa a n
+// (0 al arrancar desde reposo, -pasos al empezar a frenar).
+typedef struct {
+    rampa_tipo_t tipo;
+    uint32_t pasos;
+    uint32_t c_q8;
+    int32_t n;
+} rampa_segmento_t;
+
+typedef struct {
+    rampa_segmento_t segmentos[RAMPA_MAX_SEGMENTOS];
+    int num_segmentos;
+    uint32_t c_min_q8;
+    int seg;
+    uint32_t restantes;
+    uint32_t c_q8;
+    uint32_t resto_q8;
+    int32_t resto_n;
+    int32_t n;
+    bool primero;
+} rampa_t;
+
+// Falla si la aceleración es tan baja que el primer intervalo no cabe en
+// RAMPA_C_MAX_Q8, o si la velocidad pide menos de un tick por paso.
+bool rampa_planificar(rampa_t *r, uint32_t pasos, uint32_t vel_max_pps, uint32_t acel_pps2, uint32_t resolucion_hz);
+// Cambia lo que queda del plan por el frenado más corto desde la velocidad actual
+void rampa_frenar(rampa_t *r);
+
+// Ticks hasta el paso siguiente, 0 si ya no quedan. La primera llamada da
+// el retardo del primer paso. La parte fraccionaria de c_q8 se acumula y
+// sale como un tick más cuando completa uno: cada intervalo queda a menos
+// de un tick de c, y en crucero el periodo medio es c_min.
+static inline uint32_t rampa_siguiente(rampa_t *r) {
+    while (r->restantes == 0) {
+        if (++r->seg >= r->num_segmentos) {
+            return 0;
+        }
+        const rampa_segmento_t *s = &r->segmentos[r->seg];
+        r->restantes = s->pasos;
+        r->c_q8 = s->c_q8;
+        r->n = s->n;
+        r->resto_n = 0;
+        r->primero = true;
+    }
+    r->restantes--;
+    rampa_tipo_t tipo = r->segmentos[r->seg].tipo;
+    if (r->primero) {
+        r->primero = false;
+    } else if (tipo != RAMPA_CRUCERO) {
+        r->n++;
+        int32_t num = (int32_t)(2 * r->c_q8) + r->resto_n;
+        int32_t den = 4 * r->n + 1;
+        r->c_q8 = (uint32_t)((int32_t)r->c_q8 - num / den);
+        r->resto_n = num % den;
+        if (tipo == RAMPA_ACELERA && r->c_q8 < r->c_min_q8) {
+            r->c_q8 = r->c_min_q8;
+        }
+    }
+    r->resto_q8 += r->c_q8 & ((1u << RAMPA_Q) - 1);
+    uint32_t ticks = (r->c_q8 >> RAMPA_Q) + (r->resto_q8 >> RAMPA_Q);
+    r->resto_q8 &= (1u << RAMPA_Q) - 1;
+    return ticks;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "driver/ledc.h"
+#include "soc/soc.h"
+
+// Reparto de los temporizadores y canales LEDC entre los modos de salida
+#define LEDC_RELOJ_HZ APB_CLK_FREQ
+
+#define PWM_LEDC_MODO LEDC_HIGH_SPEED_MODE
+#define PWM_LEDC_TIMER LEDC_TIMER_0
+#define PWM_LEDC_CANAL LEDC_CHANNEL_0
+
+#define BARRIDO_LEDC_MODO LEDC_HIGH_SPEED_MODE
+#define BARRIDO_LEDC_TIMER LEDC_TIMER_1
+#define BARRIDO_LEDC_CANAL LEDC_CHANNEL_1
+
+#define ZUMBADOR_LEDC_MODO LEDC_HIGH_SPEED_MODE
+#define ZUMBADOR_LEDC_TIMER LEDC_TIMER_2
+#define ZUMBADOR_LEDC_CANAL LEDC_CHANNEL_2
+
+// Los grupos ocupan un temporizador de baja velocidad y sus canales
+// consecutivos a partir de GRUPO_LEDC_PRIMER_CANAL
+#define GRUPO_LEDC_MODO LEDC_LOW_SPEED_MODE
+#define GRUPO_LEDC_TIMER LEDC_TIMER_0
+#define GRUPO_LEDC_PRIMER_CANAL LEDC_CHANNEL_0
+
+// Los servos comparten temporizador por frecuencia de refresco: un banco en
+// alta velocidad (canales 3-7) y otro en baja (canales 6-7)
+#define SERVO_BANCOS 2
+#define SERVO_LEDC_MODO_0 LEDC_HIGH_SPEED_MODE
+#define SERVO_LEDC_TIMER_0 LEDC_TIMER_3
+#define SERVO_LEDC_PRIMER_CANAL_0 LEDC_CHANNEL_3
+#define SERVO_LEDC_CANALES_0 5
+#define SERVO_LEDC_MODO_1 LEDC_LOW_SPEED_MODE
+#define SERVO_LEDC_TIMER_1 LEDC_TIMER_1
+#define SERVO_LEDC_PRIMER_CANAL_1 LEDC_CHANNEL_6
+#define SERVO_LEDC_CANALES_1 2
@@ -0,0 +1,157 @@
+#include "reproductor.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/dac_continuous.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+#include "dds.h"
+#include "onda_dac.h"
+
+#define TAG "REPRODUCTOR"
+
+static dac_continuous_handle_t dac;
+static RingbufHandle_t buffer;
+static uint8_t muestras[ONDA_DAC_TAMANO_BUFFER];
+
+// Bloque del buffer circular que la ISR está consumiendo
+static uint8_t *bloque;
+static size_t bloque_len;
+static size_t bloque_pos;
+static uint8_t actual = 128;
+
+static dds_t reloj;
+static volatile bool reproduciendo;
+static volatile bool fin_de_datos;
+static volatile bool vaciado;
+static reproductor_estadisticas_t estadisticas;
+
+// Cada desborde del acumulador de fase toca una muestra nueva; si no hay
+// datos se mantiene la última y se cuenta el hueco.
+static void IRAM_ATTR llenar_muestras(size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint32_t fase = dds_avanzar(&reloj);
+        if (reproduciendo && reloj.fase < fase) {
+            if (bloque_pos >= bloque_len) {
+                if (bloque != NULL) {
+                    vRingbufferReturnItemFromISR(buffer, bloque, NULL);
+                }
+                bloque = xRingbufferReceiveUpToFromISR(buffer, &bloque_len, REPRODUCTOR_BLOQUE);
+                bloque_pos = 0;
+            }
+            if (bloque != NULL) {
+                actual = bloque[bloque_pos++];
+            } else if (fin_de_datos) {
+                vaciado = true;
+            } else {
+                estadisticas.subdesbordes++;
+            }
+        }
+        muestras[i] = actual;
+    }
+}
+
+static bool IRAM_ATTR dac_convertido_isr(dac_continuous_handle_t handle, const dac_event_data_t *event, void *user_data) {
+    size_t n = event->buf_size < sizeof(muestras) ? event->buf_size : sizeof(muestras);
+    size_t cargados;
+    llenar_muestras(n);
+    dac_continuous_write_asynchronously(handle, event->buf, event->buf_size, muestras, n, &cargados);
+    return false;
+}
+
+static esp_err_t crear_dac(int canal) {
+    dac_continuous_config_t cfg = {
+        .chan_mask = canal == 0 ? DAC_CHANNEL_MASK_CH0 : DAC_CHANNEL_MASK_CH1,
+        .desc_num = ONDA_DAC_DESCRIPTORES,
+        .buf_size = ONDA_DAC_TAMANO_BUFFER,
+        .freq_hz = ONDA_DAC_FRECUENCIA_MUESTREO,
+        .offset = 0,
+        .clk_src = DAC_DIGI_CLK_SRC_DEFAULT,
+        .chan_mode = DAC_CHANNEL_MODE_SIMUL,
+    };
+    ESP_RETURN_ON_ERROR(dac_continuous_new_channels(&cfg, &dac), TAG, "DAC ocupado");
+
+    dac_event_callbacks_t cbs = {
+        .on_convert_done = dac_convertido_isr,
+        .on_stop = NULL,
+    };
+    ESP_ERROR_CHECK(dac_continuous_register_event_callback(dac, &cbs, NULL));
+    ESP_ERROR_CHECK(dac_continuous_enable(dac));
+    return dac_continuous_start_async_writing(dac);
+}
+
+esp_err_t reproductor_iniciar(uint32_t muestreo_hz, int canal) {
+    if (muestreo_hz < REPRODUCTOR_MIN_HZ || muestreo_hz >= ONDA_DAC_FRECUENCIA_MUESTREO || (canal != 0 && canal != 1)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    reproductor_detener();
+    onda_dac_detener();
+
+    buffer = xRingbufferCreate(REPRODUCTOR_BUFFER_BYTES, RINGBUF_TYPE_BYTEBUF);
+    if (buffer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    bloque = NULL;
+    bloque_len = bloque_pos = 0;
+    actual = 128;
+    reproduciendo = fin_de_datos = vaciado = false;
+    estadisticas = (reproductor_estadisticas_t){ 0 };
+    dds_iniciar(&reloj, (uint64_t)muestreo_hz * DDS_MHZ_POR_HZ, ONDA_DAC_FRECUENCIA_MUESTREO);
+
+    esp_err_t err = crear_dac(canal);
+    if (err != ESP_OK) {
+        vRingbufferDelete(buffer);
+        buffer = NULL;
+        return err;
+    }
+    ESP_LOGI(TAG, "Reproduciendo a %lu Hz por el canal %d", (unsigned long)muestreo_hz, canal);
+    return ESP_OK;
+}
+
+esp_err_t reproductor_escribir(const uint8_t *datos, size_t len, uint32_t espera_ms) {
+    if (buffer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xRingbufferSend(buffer, datos, len, pdMS_TO_TICKS(espera_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    estadisticas.recibidos += len;
+    // Arranca con medio buffer lleno para absorber la irregularidad de la red
+    if (!reproduciendo && xRingbufferGetCurFreeSize(buffer) <= REPRODUCTOR_BUFFER_BYTES / 2) {
+        reproduciendo = true;
+    }
+    return ESP_OK;
+}
+
+esp_err_t reproductor_terminar(uint32_t espera_ms) {
+    if (buffer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    fin_de_datos = true;
+    reproduciendo = true;
+    for (uint32_t t = 0; !vaciado; t += 10) {
+        if (t >= espera_ms) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
+
+esp_err_t reproductor_detener(void) {
+    if (dac == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    dac_continuous_stop_async_writing(dac);
+    dac_continuous_disable(dac);
+    dac_continuous_del_channels(dac);
+    dac = NULL;
+    vRingbufferDelete(buffer);
+    buffer = NULL;
+    return ESP_OK;
+}
+
+void reproductor_estadisticas(reproductor_estadisticas_t *e) {
+    *e = estadisticas;
+}
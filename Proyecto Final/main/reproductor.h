@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Reproduce por el DAC muestras de 8 bits que llegan por partes (p. ej. una
+// subida HTTP) sin tenerlas enteras en memoria: el emisor escribe en un
+// buffer circular de tamaño fijo y la ISR del DMA lo vacía.
+#define REPRODUCTOR_BUFFER_BYTES (16 * 1024)
+#define REPRODUCTOR_BLOQUE 1024
+#define REPRODUCTOR_MIN_HZ 100
+
+typedef struct {
+    uint32_t recibidos;
+    uint32_t subdesbordes;      // muestras repetidas por falta de datos
+} reproductor_estadisticas_t;
+
+// El DAC corre a ONDA_DAC_FRECUENCIA_MUESTREO; un acumulador de fase decide
+// cuándo pasar a la siguiente muestra, así vale cualquier frecuencia por
+// debajo de esa. La propia no: su incremento no cabe en el acumulador y la
+// fase nunca daría la vuelta. Detiene el modo Onda DAC si estaba activo.
+esp_err_t reproductor_iniciar(uint32_t muestreo_hz, int canal);
+
+// Bloquea hasta que todo cabe en el buffer: esa espera frena al emisor
+esp_err_t reproductor_escribir(const uint8_t *datos, size_t len, uint32_t espera_ms);
+
+// Marca el fin de los datos y espera a que se reproduzca lo pendiente
+esp_err_t reproductor_terminar(uint32_t espera_ms);
+esp_err_t reproductor_detener(void);
+void reproductor_estadisticas(reproductor_estadisticas_t *e);
@@ -0,0 +1,214 @@
+#include "secuencia.h"
+#include <string.h>
+
+static const uint8_t palabras_por_op[SEC_NUM_OPS] = {
+    [SEC_FIN] = 1,
+    [SEC_TONO] = 5,
+    [SEC_RAFAGA] = 4,
+    [SEC_PAUSA] = 2,
+    [SEC_BUCLE] = 2,
+};
+
+void sec_programa_iniciar(sec_programa_t *p, uint32_t *buffer, uint32_t capacidad) {
+    p->codigo = buffer;
+    p->capacidad = capacidad;
+    p->longitud = 0;
+    p->desbordado = false;
+}
+
+static bool emitir(sec_programa_t *p, const uint32_t *palabras, uint32_t n) {
+    if (p->desbordado || p->longitud + n > p->capacidad) {
+        p->desbordado = true;
+        return false;
+    }
+    memcpy(&p->codigo[p->longitud], palabras, n * sizeof(uint32_t));
+    p->longitud += n;
+    return true;
+}
+
+static bool flancos_validos(const dds_flancos_t *f) {
+    return f->ticks > 0 && f->divisor > 0 && f->divisor <= UINT32_MAX && f->resto < f->divisor;
+}
+
+bool sec_emitir_tono(sec_programa_t *p, const dds_flancos_t *f, uint32_t duracion_ticks) {
+    if (!flancos_validos(f) || duracion_ticks == 0) {
+        return false;
+    }
+    uint32_t w[5] = { (uint32_t)SEC_TONO << 24, f->ticks, (uint32_t)f->resto, (uint32_t)f->divisor, duracion_ticks };
+    return emitir(p, w, 5);
+}
+
+bool sec_emitir_rafaga(sec_programa_t *p, const dds_flancos_t *f, uint32_t pulsos) {
+    if (!flancos_validos(f) || pulsos == 0 || pulsos > SEC_ARG(UINT32_MAX) / 2) {
+        return false;
+    }
+    uint32_t w[4] = { (uint32_t)SEC_RAFAGA << 24 | pulsos, f->ticks, (uint32_t)f->resto, (uint32_t)f->divisor };
+    return emitir(p, w, 4);
+}
+
+bool sec_emitir_pausa(sec_programa_t *p, uint32_t duracion_ticks) {
+    if (duracion_ticks == 0) {
+        return false;
+    }
+    uint32_t w[2] = { (uint32_t)SEC_PAUSA << 24, duracion_ticks };
+    return emitir(p, w, 2);
+}
+
+bool sec_emitir_bucle(sec_programa_t *p, uint32_t destino, uint32_t nivel, uint32_t veces) {
+    if (nivel >= SEC_MAX_BUCLES || veces > 0xFFFF) {
+        return false;
+    }
+    uint32_t w[2] = { (uint32_t)SEC_BUCLE << 24 | nivel << 16 | veces, destino };
+    return emitir(p, w, 2);
+}
+
+bool sec_emitir_fin(sec_programa_t *p) {
+    uint32_t w = (uint32_t)SEC_FIN << 24;
+    return emitir(p, &w, 1);
+}
+
+bool sec_validar(const uint32_t *codigo, uint32_t longitud) {
+    uint8_t inicio[SEC_MAX_PALABRAS / 8] = { 0 };
+    uint32_t ultimo_con_duracion = UINT32_MAX;
+    if (longitud == 0 || longitud > SEC_MAX_PALABRAS) {
+        return false;
+    }
+    for (uint32_t pc = 0; pc < longitud;) {
+        uint32_t op = SEC_OP(codigo[pc]);
+        if (op >= SEC_NUM_OPS || pc + palabras_por_op[op] > longitud) {
+            return false;
+        }
+        inicio[pc / 8] |= 1u << (pc % 8);
+        const uint32_t *w = &codigo[pc];
+        switch (op) {
+        case SEC_TONO:
+            if (w[1] == 0 || w[3] == 0 || w[2] >= w[3] || w[4] == 0) {
+                return false;
+            }
+            ultimo_con_duracion = pc;
+            break;
+        case SEC_RAFAGA:
+            if (w[1] == 0 || w[3] == 0 || w[2] >= w[3] || SEC_ARG(w[0]) == 0) {
+                return false;
+            }
+            ultimo_con_duracion = pc;
+            break;
+        case SEC_PAUSA:
+            if (w[1] == 0) {
+                return false;
+            }
+            ultimo_con_duracion = pc;
+            break;
+        case SEC_BUCLE:
+            if (((SEC_ARG(w[0]) >> 16) & 0xFF) >= SEC_MAX_BUCLES || w[1] >= pc ||
+                !(inicio[w[1] / 8] & (1u << (w[1] % 8))) ||
+                ultimo_con_duracion == UINT32_MAX || ultimo_con_duracion < w[1]) {
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+        pc += palabras_por_op[op];
+    }
+    return true;
+}
+
+void sec_iniciar(sec_maquina_t *m, const uint32_t *codigo, uint32_t longitud) {
+    memset(m, 0, sizeof(*m));
+    m->codigo = codigo;
+    m->longitud = longitud;
+    m->op = SEC_NUM_OPS;
+}
+
+static void cargar_flancos(sec_maquina_t *m, const uint32_t *w) {
+    m->flancos.ticks = w[1];
+    m->flancos.resto = w[2];
+    m->flancos.divisor = w[3];
+    m->flancos.acumulado = 0;
+    m->nivel = 1;
+    m->proximo_flanco = m->tiempo + dds_flancos_siguiente(&m->flancos);
+}
+
+// Resuelve bucles hasta el siguiente paso con duración y lo arranca en
+// m->tiempo; los bucles no consumen tiempo.
+static bool cargar_paso(sec_maquina_t *m) {
+    for (int saltos = 0; saltos < SEC_MAX_SALTOS && m->pc < m->longitud; saltos++) {
+        const uint32_t *w = &m->codigo[m->pc];
+        m->op = SEC_OP(w[0]);
+        switch (m->op) {
+        case SEC_TONO:
+            cargar_flancos(m, w);
+            m->fin_paso = m->tiempo + w[4];
+            m->pc += palabras_por_op[SEC_TONO];
+            return true;
+        case SEC_RAFAGA:
+            cargar_flancos(m, w);
+            m->flancos_restantes = 2 * SEC_ARG(w[0]) - 1;
+            m->pc += palabras_por_op[SEC_RAFAGA];
+            return true;
+        case SEC_PAUSA:
+            m->nivel = 0;
+            m->fin_paso = m->tiempo + w[1];
+            m->pc += palabras_por_op[SEC_PAUSA];
+            return true;
+        case SEC_BUCLE: {
+            uint32_t nivel = (SEC_ARG(w[0]) >> 16) & 0xFF;
+            uint32_t veces = SEC_ARG(w[0]) & 0xFFFF;
+            if (veces == 0 || ++m->contadores[nivel] < veces) {
+                m->pc = w[1];
+            } else {
+                m->contadores[nivel] = 0;
+                m->pc += palabras_por_op[SEC_BUCLE];
+            }
+            break;
+        }
+        default:
+            m->pc = m->longitud;
+            break;
+        }
+    }
+    m->op = SEC_FIN;
+    return false;
+}
+
+bool sec_siguiente(sec_maquina_t *m, sec_evento_t *ev) {
+    switch (m->op) {
+    case SEC_TONO:
+        if (m->proximo_flanco < m->fin_paso) {
+            m->nivel ^= 1;
+            ev->tiempo = m->proximo_flanco;
+            ev->nivel = m->nivel;
+            ev->fin = false;
+            m->proximo_flanco += dds_flancos_siguiente(&m->flancos);
+            return true;
+        }
+        m->tiempo = m->fin_paso;
+        break;
+    case SEC_RAFAGA:
+        if (m->flancos_restantes > 0) {
+            m->flancos_restantes--;
+            m->nivel ^= 1;
+            ev->tiempo = m->proximo_flanco;
+            ev->nivel = m->nivel;
+            ev->fin = false;
+            m->proximo_flanco += dds_flancos_siguiente(&m->flancos);
+            return true;
+        }
+        // La ráfaga dura pulsos periodos completos, incluido el último bajo
+        m->tiempo = m->proximo_flanco;
+        break;
+    case SEC_PAUSA:
+        m->tiempo = m->fin_paso;
+        break;
+    case SEC_FIN:
+        return false;
+    default:
+        break;
+    }
+    bool hay_paso = cargar_paso(m);
+    ev->tiempo = m->tiempo;
+    ev->nivel = hay_paso ? m->nivel : 0;
+    ev->fin = !hay_paso;
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "dds.h"
+
+// Bytecode de secuencias de onda cuadrada y su intérprete. Todo en ticks
+// enteros precalculados: el intérprete solo suma y compara, corre en la ISR
+// del secuenciador y, como no depende de ESP-IDF, también en el host.
+//
+// Cada instrucción empieza con una palabra op << 24 | argumento:
+//   SEC_TONO    [op] [semiperiodo] [resto] [divisor] [duración]
+//   SEC_RAFAGA  [op | pulsos] [semiperiodo] [resto] [divisor]
+//   SEC_PAUSA   [op] [duración]
+//   SEC_BUCLE   [op | nivel << 16 | veces] [destino]   veces 0 = sin fin
+//   SEC_FIN     [op]
+// semiperiodo/resto/divisor son los de dds_flancos_t, el reparto de residuos
+// hace exacta la frecuencia media aunque el semiperiodo no sea entero.
+
+#define SEC_MAX_PALABRAS 512
+#define SEC_MAX_BUCLES 4
+#define SEC_MAX_SALTOS 64
+
+#define SEC_OP(w) ((w) >> 24)
+#define SEC_ARG(w) ((w) & 0xFFFFFFu)
+
+typedef enum {
+    SEC_FIN,
+    SEC_TONO,
+    SEC_RAFAGA,
+    SEC_PAUSA,
+    SEC_BUCLE,
+    SEC_NUM_OPS
+} sec_op_t;
+
+typedef struct {
+    uint32_t *codigo;
+    uint32_t capacidad;
+    uint32_t longitud;
+    bool desbordado;
+} sec_programa_t;
+
+// Cada cambio de nivel de la salida, en ticks desde el inicio; el último
+// lleva fin y deja la salida en bajo.
+typedef struct {
+    uint64_t tiempo;
+    uint8_t nivel;
+    bool fin;
+} sec_evento_t;
+
+typedef struct {
+    const uint32_t *codigo;
+    uint32_t longitud;
+    uint32_t pc;
+    uint16_t contadores[SEC_MAX_BUCLES];
+    uint8_t op;
+    uint8_t nivel;
+    dds_flancos_t flancos;
+    uint32_t flancos_restantes;
+    uint64_t tiempo;
+    uint64_t fin_paso;
+    uint64_t proximo_flanco;
+} sec_maquina_t;
+
+void sec_programa_iniciar(sec_programa_t *p, uint32_t *buffer, uint32_t capacidad);
+bool sec_emitir_tono(sec_programa_t *p, const dds_flancos_t *f, uint32_t duracion_ticks);
+bool sec_emitir_rafaga(sec_programa_t *p, const dds_flancos_t *f, uint32_t pulsos);
+bool sec_emitir_pausa(sec_programa_t *p, uint32_t duracion_ticks);
+bool sec_emitir_bucle(sec_programa_t *p, uint32_t destino, uint32_t nivel, uint32_t veces);
+bool sec_emitir_fin(sec_programa_t *p);
+
+// Comprueba límites, saltos a inicio de instrucción y que todo bucle
+// contenga al menos un paso con duración; el intérprete confía en ello.
+bool sec_validar(const uint32_t *codigo, uint32_t longitud);
+
+void sec_iniciar(sec_maquina_t *m, const uint32_t *codigo, uint32_t longitud);
+// Siguiente evento en orden de tiempo; false después del evento final
+bool sec_siguiente(sec_maquina_t *m, sec_evento_t *ev);
@@ -0,0 +1,197 @@
+#include "secuenciador.h"
+#include <string.h>
+#include "cJSON.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "dds.h"
+
+#define TAG "SECUENCIADOR"
+#define TICKS_POR_US (SECUENCIADOR_RESOLUCION_HZ / 1000000)
+
+static uint32_t codigo[SEC_MAX_PALABRAS];
+static sec_maquina_t maquina;
+static sec_evento_t pendiente;
+static gptimer_handle_t temporizador;
+static int pin = -1;
+static volatile bool en_curso;
+static bool activo;
+
+// Aplica el evento pendiente y los que caen en el mismo tick; devuelve el
+// instante del siguiente o false si la secuencia terminó.
+static bool IRAM_ATTR aplicar_eventos(uint64_t *proximo) {
+    uint64_t ahora = pendiente.tiempo;
+    while (pendiente.tiempo <= ahora) {
+        gpio_set_level(pin, pendiente.nivel);
+        if (pendiente.fin || !sec_siguiente(&maquina, &pendiente)) {
+            return false;
+        }
+    }
+    *proximo = pendiente.tiempo;
+    return true;
+}
+
+static bool IRAM_ATTR evento_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    uint64_t proximo;
+    if (!aplicar_eventos(&proximo)) {
+        gptimer_stop(timer);
+        en_curso = false;
+        return false;
+    }
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = proximo,
+    };
+    gptimer_set_alarm_action(timer, &alarma);
+    return false;
+}
+
+static esp_err_t crear_temporizador(void) {
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = SECUENCIADOR_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = evento_isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+    return ESP_OK;
+}
+
+esp_err_t secuenciador_iniciar(int gpio, const uint32_t *programa, uint32_t longitud) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio) || !sec_validar(programa, longitud)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    secuenciador_detener();
+    ESP_RETURN_ON_ERROR(crear_temporizador(), TAG, "no se pudo crear el temporizador");
+
+    memcpy(codigo, programa, longitud * sizeof(uint32_t));
+    sec_iniciar(&maquina, codigo, longitud);
+    pin = gpio;
+    gpio_set_direction(pin, GPIO_MODE_OUTPUT);
+    activo = true;
+    en_curso = true;
+
+    // El primer evento cae en el tick 0: se aplica aquí y la alarma queda
+    // en el siguiente.
+    uint64_t proximo;
+    sec_siguiente(&maquina, &pendiente);
+    if (!aplicar_eventos(&proximo)) {
+        en_curso = false;
+        return ESP_OK;
+    }
+    gptimer_alarm_config_t alarma = {
+        .alarm_count = proximo,
+    };
+    ESP_ERROR_CHECK(gptimer_set_raw_count(temporizador, 0));
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(temporizador, &alarma));
+    return gptimer_start(temporizador);
+}
+
+esp_err_t secuenciador_detener(void) {
+    if (!activo) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (en_curso) {
+        gptimer_stop(temporizador);
+    }
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+    gpio_set_level(pin, 0);
+    en_curso = false;
+    activo = false;
+    return ESP_OK;
+}
+
+bool secuenciador_en_curso(void) {
+    return en_curso;
+}
+
+static bool leer_duracion(const cJSON *paso, uint32_t *ticks) {
+    const cJSON *ms = cJSON_GetObjectItem(paso, "ms");
+    const cJSON *us = cJSON_GetObjectItem(paso, "us");
+    double t;
+    if (cJSON_IsNumber(ms)) {
+        t = ms->valuedouble * 1000.0 * TICKS_POR_US;
+    } else if (cJSON_IsNumber(us)) {
+        t = us->valuedouble * TICKS_POR_US;
+    } else {
+        return false;
+    }
+    if (t < 1 || t > UINT32_MAX) {
+        return false;
+    }
+    *ticks = (uint32_t)(t + 0.5);
+    return true;
+}
+
+static bool leer_flancos(const cJSON *paso, dds_flancos_t *f) {
+    const cJSON *hz = cJSON_GetObjectItem(paso, "hz");
+    if (!cJSON_IsNumber(hz)) {
+        return false;
+    }
+    uint64_t frecuencia_mhz = dds_mhz_desde_hz(hz->valuedouble);
+    return frecuencia_mhz <= SECUENCIADOR_MAX_MHZ &&
+           dds_flancos_iniciar(f, frecuencia_mhz, SECUENCIADOR_RESOLUCION_HZ, 2);
+}
+
+// Cada nivel de anidamiento usa su propio contador de bucle
+static bool compilar_pasos(const cJSON *pasos, sec_programa_t *p, uint32_t nivel) {
+    const cJSON *paso;
+    if (!cJSON_IsArray(pasos) || cJSON_GetArraySize(pasos) == 0) {
+        return false;
+    }
+    cJSON_ArrayForEach(paso, pasos) {
+        const cJSON *tipo = cJSON_GetObjectItem(paso, "tipo");
+        if (!cJSON_IsString(tipo)) {
+            return false;
+        }
+        dds_flancos_t f;
+        uint32_t ticks;
+        bool ok;
+        if (strcmp(tipo->valuestring, "tono") == 0) {
+            ok = leer_flancos(paso, &f) && leer_duracion(paso, &ticks) && sec_emitir_tono(p, &f, ticks);
+        } else if (strcmp(tipo->valuestring, "pausa") == 0) {
+            ok = leer_duracion(paso, &ticks) && sec_emitir_pausa(p, ticks);
+        } else if (strcmp(tipo->valuestring, "rafaga") == 0) {
+            const cJSON *pulsos = cJSON_GetObjectItem(paso, "pulsos");
+            ok = cJSON_IsNumber(pulsos) && pulsos->valueint > 0 && leer_flancos(paso, &f) &&
+                 sec_emitir_rafaga(p, &f, pulsos->valueint);
+        } else if (strcmp(tipo->valuestring, "bucle") == 0) {
+            const cJSON *veces = cJSON_GetObjectItem(paso, "veces");
+            uint32_t inicio = p->longitud;
+            ok = nivel < SEC_MAX_BUCLES && cJSON_IsNumber(veces) && veces->valueint >= 0 &&
+                 compilar_pasos(cJSON_GetObjectItem(paso, "pasos"), p, nivel + 1) &&
+                 sec_emitir_bucle(p, inicio, nivel, veces->valueint);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t secuenciador_compilar(const char *json, sec_programa_t *programa, int *gpio) {
+    cJSON *raiz = cJSON_Parse(json);
+    if (raiz == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const cJSON *pin_json = cJSON_GetObjectItem(raiz, "gpio");
+    if (gpio != NULL && cJSON_IsNumber(pin_json)) {
+        *gpio = pin_json->valueint;
+    }
+    bool ok = compilar_pasos(cJSON_GetObjectItem(raiz, "pasos"), programa, 0) && sec_emitir_fin(programa);
+    cJSON_Delete(raiz);
+    if (programa->desbordado) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ok && sec_validar(programa->codigo, programa->longitud) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
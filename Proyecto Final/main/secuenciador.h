@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "secuencia.h"
+
+// Ejecuta secuencias de secuencia.h sobre un GPIO desde la alarma de un
+// GPTimer: cada evento programa la alarma absoluta del siguiente.
+#define SECUENCIADOR_RESOLUCION_HZ 10000000
+#define SECUENCIADOR_MAX_MHZ (20000 * 1000ULL)
+
+// Compila JSON a bytecode. Formato:
+//   {"gpio":2,"pasos":[{"tipo":"tono","hz":1000,"ms":200},
+//                      {"tipo":"pausa","ms":50},
+//                      {"tipo":"rafaga","hz":2000,"pulsos":30},
+//                      {"tipo":"bucle","veces":10,"pasos":[...]}]}
+// Las duraciones admiten "ms" o "us"; "veces" 0 repite sin fin.
+esp_err_t secuenciador_compilar(const char *json, sec_programa_t *programa, int *gpio);
+
+// Copia el código, así el llamador puede liberar el suyo al volver
+esp_err_t secuenciador_iniciar(int gpio, const uint32_t *codigo, uint32_t longitud);
+esp_err_t secuenciador_detener(void);
+bool secuenciador_en_curso(void);
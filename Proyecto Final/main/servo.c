@@ -0,0 +1,307 @@
+#include "servo.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "dds.h"
+#include "recursos.h"
+
+#define TAG "SERVO"
+#define SERVO_RESOLUCION_HZ 1000000
+
+_Static_assert(SERVO_LEDC_CANALES_0 + SERVO_LEDC_CANALES_1 == SERVO_MAX, "un canal LEDC por servo");
+_Static_assert(((int64_t)SERVO_MAX_RECORRIDO_US << SERVO_PERFIL_Q) <= INT64_MAX / (360 * 1000),
+               "pulso_q32 desborda con el recorrido máximo");
+
+typedef struct {
+    ledc_mode_t modo;
+    ledc_timer_t timer;
+    ledc_channel_t primer_canal;
+    int canales;
+    uint32_t ocupados;              // máscara de canales en uso
+    uint32_t frecuencia_hz;
+    uint64_t cuentas_por_us_q16;
+} servo_banco_t;
+
+typedef struct {
+    int gpio;
+    servo_banco_t *banco;
+    ledc_channel_t canal;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t rango_grados;
+    uint32_t duty;
+    servo_perfil_t perfil;
+} servo_estado_t;
+
+static servo_banco_t bancos[SERVO_BANCOS] = {
+    { .modo = SERVO_LEDC_MODO_0, .timer = SERVO_LEDC_TIMER_0, .primer_canal = SERVO_LEDC_PRIMER_CANAL_0,
+      .canales = SERVO_LEDC_CANALES_0 },
+    { .modo = SERVO_LEDC_MODO_1, .timer = SERVO_LEDC_TIMER_1, .primer_canal = SERVO_LEDC_PRIMER_CANAL_1,
+      .canales = SERVO_LEDC_CANALES_1 },
+};
+static servo_estado_t servos[SERVO_MAX];
+static int num_servos;
+static gptimer_handle_t temporizador;
+static portMUX_TYPE servo_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Pulso en µs Q32 a cuentas de duty: se baja a Q16 para que el producto
+// quepa en 64 bits.
+static inline uint32_t IRAM_ATTR cuentas(int64_t pulso_q32, uint64_t cuentas_por_us_q16) {
+    return (uint32_t)((((uint64_t)pulso_q32 >> 16) * cuentas_por_us_q16) >> 32);
+}
+
+static bool IRAM_ATTR actualizar_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    portENTER_CRITICAL_ISR(&servo_lock);
+    for (int i = 0; i < num_servos; i++) {
+        servo_estado_t *s = &servos[i];
+        if (!s->perfil.moviendo) {
+            continue;
+        }
+        uint32_t duty = cuentas(servo_perfil_avanzar(&s->perfil), s->banco->cuentas_por_us_q16);
+        if (duty != s->duty) {
+            s->duty = duty;
+            ledc_set_duty(s->banco->modo, s->canal, duty);
+            ledc_update_duty(s->banco->modo, s->canal);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&servo_lock);
+    return false;
+}
+
+static esp_err_t crear_temporizador(void) {
+    if (temporizador != NULL) {
+        return ESP_OK;
+    }
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = SERVO_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = actualizar_isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+    gptimer_alarm_config_t alarma = {
+        .reload_count = 0,
+        .alarm_count = SERVO_RESOLUCION_HZ / SERVO_ACTUALIZACION_HZ,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(temporizador, &alarma));
+    return gptimer_start(temporizador);
+}
+
+static void borrar_temporizador(void) {
+    if (temporizador == NULL) {
+        return;
+    }
+    gptimer_stop(temporizador);
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+}
+
+// La mayor resolución que admite la frecuencia: a 50 Hz sobran cuentas por
+// microsegundo y a 400 Hz sigue habiendo más de una.
+static esp_err_t configurar_banco(servo_banco_t *b, uint32_t frecuencia_hz) {
+    dds_ledc_t ledc;
+    uint64_t frecuencia_mhz = (uint64_t)frecuencia_hz * DDS_MHZ_POR_HZ;
+    if (!dds_ledc_calcular(&ledc, frecuencia_mhz, LEDC_RELOJ_HZ, DDS_LEDC_BITS_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = b->modo,
+        .timer_num = b->timer,
+        .duty_resolution = ledc.bits,
+        .freq_hz = frecuencia_hz,
+        .clk_cfg = LEDC_USE_APB_CLK
+    };
+    ledc_timer_config(&ledc_timer);
+    ESP_RETURN_ON_ERROR(ledc_timer_set(b->modo, b->timer, ledc.divisor_q8, ledc.bits, LEDC_APB_CLK),
+                        TAG, "divisor LEDC fuera de rango");
+    b->frecuencia_hz = frecuencia_hz;
+    b->cuentas_por_us_q16 = ((dds_ledc_frecuencia(&ledc, LEDC_RELOJ_HZ) << ledc.bits) << 16) /
+                            (1000000ULL * DDS_MHZ_POR_HZ);
+    return ESP_OK;
+}
+
+// Un banco ya en uso a la misma frecuencia o, si no, uno libre
+static servo_banco_t *buscar_banco(uint32_t frecuencia_hz, bool *nuevo) {
+    for (int i = 0; i < SERVO_BANCOS; i++) {
+        if (bancos[i].ocupados != 0 && bancos[i].frecuencia_hz == frecuencia_hz &&
+            bancos[i].ocupados != (1u << bancos[i].canales) - 1) {
+            *nuevo = false;
+            return &bancos[i];
+        }
+    }
+    for (int i = 0; i < SERVO_BANCOS; i++) {
+        if (bancos[i].ocupados == 0) {
+            *nuevo = true;
+            return &bancos[i];
+        }
+    }
+    return NULL;
+}
+
+static int buscar(int gpio) {
+    for (int i = 0; i < num_servos; i++) {
+        if (servos[i].gpio == gpio) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Con el recorrido limitado a SERVO_MAX_RECORRIDO_US el producto por el
+// ángulo en milésimas cabe en 64 bits
+static int64_t pulso_q32(const servo_estado_t *s, uint32_t angulo_mgrados) {
+    return ((int64_t)s->min_us << SERVO_PERFIL_Q) +
+           (((int64_t)(s->max_us - s->min_us) << SERVO_PERFIL_Q) * angulo_mgrados) / (s->rango_grados * 1000LL);
+}
+
+static int64_t posicion_actual(const servo_perfil_t *p) {
+    if (!p->moviendo) {
+        return p->destino;
+    }
+    return p->destino >= p->origen ? p->origen + p->recorrido : p->origen - p->recorrido;
+}
+
+esp_err_t servo_conectar(const servo_config_t *cfg) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(cfg->gpio) || cfg->frecuencia_hz < SERVO_MIN_HZ ||
+        cfg->frecuencia_hz > SERVO_MAX_HZ || cfg->min_us >= cfg->max_us || cfg->max_us >= 1000000 / cfg->frecuencia_hz ||
+        cfg->max_us - cfg->min_us > SERVO_MAX_RECORRIDO_US ||
+        cfg->rango_grados == 0 || cfg->rango_grados > 360 || cfg->angulo_mgrados > cfg->rango_grados * 1000) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (buscar(cfg->gpio) >= 0) {
+        servo_quitar(cfg->gpio);
+    }
+    bool nuevo;
+    servo_banco_t *b = buscar_banco(cfg->frecuencia_hz, &nuevo);
+    if (b == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (nuevo) {
+        ESP_RETURN_ON_ERROR(configurar_banco(b, cfg->frecuencia_hz), TAG, "temporizador del banco");
+    }
+    int libre = 0;
+    while (b->ocupados & (1u << libre)) {
+        libre++;
+    }
+
+    servo_estado_t s = {
+        .gpio = cfg->gpio,
+        .banco = b,
+        .canal = b->primer_canal + libre,
+        .min_us = cfg->min_us,
+        .max_us = cfg->max_us,
+        .rango_grados = cfg->rango_grados,
+    };
+    servo_perfil_fijar(&s.perfil, pulso_q32(&s, cfg->angulo_mgrados));
+    s.duty = cuentas(s.perfil.destino, b->cuentas_por_us_q16);
+    ledc_channel_config_t ledc_channel = {
+        .gpio_num = cfg->gpio,
+        .speed_mode = b->modo,
+        .channel = s.canal,
+        .timer_sel = b->timer,
+        .duty = s.duty,
+        .hpoint = 0
+    };
+    ESP_RETURN_ON_ERROR(ledc_channel_config(&ledc_channel), TAG, "canal LEDC");
+
+    portENTER_CRITICAL(&servo_lock);
+    b->ocupados |= 1u << libre;
+    servos[num_servos++] = s;
+    portEXIT_CRITICAL(&servo_lock);
+    ESP_LOGI(TAG, "Servo en GPIO %d a %lu Hz, canal %d", cfg->gpio, (unsigned long)cfg->frecuencia_hz, s.canal);
+    return crear_temporizador();
+}
+
+// Los límites pasan de grados a µs de pulso por tick de actualización
+esp_err_t servo_mover(int gpio, const servo_movimiento_t *m) {
+    int i = buscar(gpio);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    servo_estado_t *s = &servos[i];
+    if (m->angulo_mgrados > s->rango_grados * 1000 || m->velocidad_gps > SERVO_MAX_GPS ||
+        m->aceleracion_gps2 > SERVO_MAX_GPS2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Pulso por grado y tick: dividir antes de multiplicar deja los productos
+    // por debajo de 2^54 con los límites de servo.h
+    int64_t escala = ((int64_t)(s->max_us - s->min_us) << SERVO_PERFIL_Q) /
+                     ((int64_t)s->rango_grados * SERVO_ACTUALIZACION_HZ);
+    int64_t vel = escala * m->velocidad_gps;
+    int64_t acel = escala * m->aceleracion_gps2 / SERVO_ACTUALIZACION_HZ;
+
+    // Se congela donde esté mientras se planifica el nuevo perfil
+    portENTER_CRITICAL(&servo_lock);
+    int64_t desde = posicion_actual(&s->perfil);
+    servo_perfil_fijar(&s->perfil, desde);
+    portEXIT_CRITICAL(&servo_lock);
+
+    servo_perfil_t perfil;
+    if (!servo_perfil_planificar(&perfil, desde, pulso_q32(s, m->angulo_mgrados), vel, acel, m->forma)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&servo_lock);
+    s->perfil = perfil;
+    portEXIT_CRITICAL(&servo_lock);
+    if (!perfil.moviendo) {
+        s->duty = cuentas(perfil.destino, s->banco->cuentas_por_us_q16);
+        ledc_set_duty(s->banco->modo, s->canal, s->duty);
+        ledc_update_duty(s->banco->modo, s->canal);
+    }
+    return ESP_OK;
+}
+
+esp_err_t servo_posicion(int gpio, uint32_t *angulo_mgrados, bool *moviendo) {
+    int i = buscar(gpio);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    servo_estado_t *s = &servos[i];
+    portENTER_CRITICAL(&servo_lock);
+    int64_t pulso = posicion_actual(&s->perfil);
+    *moviendo = s->perfil.moviendo;
+    portEXIT_CRITICAL(&servo_lock);
+    int64_t desplazamiento = pulso - ((int64_t)s->min_us << SERVO_PERFIL_Q);
+    *angulo_mgrados = (uint32_t)((desplazamiento * (s->rango_grados * 1000LL)) /
+                                 ((int64_t)(s->max_us - s->min_us) << SERVO_PERFIL_Q));
+    return ESP_OK;
+}
+
+esp_err_t servo_quitar(int gpio) {
+    int i = buscar(gpio);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    servo_banco_t *b = servos[i].banco;
+    ledc_channel_t canal = servos[i].canal;
+    portENTER_CRITICAL(&servo_lock);
+    servos[i] = servos[--num_servos];
+    b->ocupados &= ~(1u << (canal - b->primer_canal));
+    portEXIT_CRITICAL(&servo_lock);
+
+    ledc_stop(b->modo, canal, 0);
+    if (num_servos == 0) {
+        borrar_temporizador();
+    }
+    return ESP_OK;
+}
+
+esp_err_t servo_detener(void) {
+    if (num_servos == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    while (num_servos > 0) {
+        servo_quitar(servos[0].gpio);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "servo_perfil.h"
+
+// Servos de radiomodelismo por LEDC: un pulso de min_us a max_us repetido a
+// 50-400 Hz. Los servos con la misma frecuencia comparten temporizador; los
+// perfiles de movimiento los integra una alarma a SERVO_ACTUALIZACION_HZ.
+#define SERVO_MAX 7
+#define SERVO_MIN_HZ 50
+#define SERVO_MAX_HZ 400
+#define SERVO_ACTUALIZACION_HZ 1000
+// Límites para que los cálculos en Q32 de servo.c quepan en 64 bits; de
+// sobra para servos de 0,5-2,5 ms
+#define SERVO_MAX_RECORRIDO_US 3000     // max_us - min_us
+#define SERVO_MAX_GPS 10000
+#define SERVO_MAX_GPS2 1000000
+
+typedef struct {
+    int gpio;
+    uint32_t frecuencia_hz;
+    uint32_t min_us;                // pulso en 0 grados
+    uint32_t max_us;                // pulso en rango_grados
+    uint32_t rango_grados;
+    uint32_t angulo_mgrados;        // posición al conectar, en milésimas de grado
+} servo_config_t;
+
+typedef struct {
+    uint32_t angulo_mgrados;
+    uint32_t velocidad_gps;         // grados por segundo
+    uint32_t aceleracion_gps2;      // grados por segundo al cuadrado (pico en curva S)
+    servo_forma_t forma;
+} servo_movimiento_t;
+
+esp_err_t servo_conectar(const servo_config_t *cfg);
+// Parte de la posición actual: si el servo ya se movía, se detiene ahí y el
+// nuevo perfil arranca desde reposo.
+esp_err_t servo_mover(int gpio, const servo_movimiento_t *m);
+esp_err_t servo_posicion(int gpio, uint32_t *angulo_mgrados, bool *moviendo);
+esp_err_t servo_quitar(int gpio);
+esp_err_t servo_detener(void);
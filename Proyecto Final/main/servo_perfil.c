@@ -0,0 +1,84 @@
+#include "servo_perfil.h"
+#include <math.h>
+
+// Tramos de arranque hasta 'vel' (signo 1) o de frenado desde 'vel' (signo
+// -1). El frenado es el arranque con la aceleración cambiada de signo, así
+// que termina exactamente en velocidad cero.
+static int tramos_rampa(servo_tramo_t *t, int64_t vel, int64_t acel_max, servo_forma_t forma, int signo) {
+    int64_t n = (vel + acel_max - 1) / acel_max;
+    if (forma == SERVO_TRAPECIO) {
+        t[0] = (servo_tramo_t){ (uint32_t)n, signo * (vel / n), 0 };
+        return 1;
+    }
+    // Aceleración en triángulo de 2n ticks: v = j·n² con pico j·n <= acel_max
+    int64_t j = vel / (n * n);
+    t[0] = (servo_tramo_t){ (uint32_t)n, 0, signo * j };
+    t[1] = (servo_tramo_t){ (uint32_t)n, signo * j * n, -signo * j };
+    return 2;
+}
+
+// Integra los tramos igual que servo_perfil_avanzar y devuelve el recorrido
+static int64_t simular(const servo_tramo_t *t, int n, int64_t *v) {
+    int64_t x = 0;
+    for (int i = 0; i < n; i++) {
+        int64_t a = t[i].acel;
+        for (uint32_t k = 0; k < t[i].ticks; k++) {
+            *v += a;
+            x += *v;
+            a += t[i].jerk;
+        }
+    }
+    return x;
+}
+
+void servo_perfil_fijar(servo_perfil_t *p, int64_t posicion) {
+    *p = (servo_perfil_t){ .origen = posicion, .destino = posicion };
+}
+
+bool servo_perfil_planificar(servo_perfil_t *p, int64_t desde, int64_t hasta, int64_t vel_max, int64_t acel_max,
+                             servo_forma_t forma) {
+    if (vel_max <= 0 || acel_max <= 0 || forma >= SERVO_NUM_FORMAS ||
+        (vel_max + acel_max - 1) / acel_max > SERVO_PERFIL_MAX_TICKS_RAMPA) {
+        return false;
+    }
+    servo_perfil_fijar(p, desde);
+    p->destino = hasta;
+    p->distancia = hasta > desde ? hasta - desde : desde - hasta;
+    p->tramo = -1;
+
+    // Se baja la velocidad de crucero hasta que arranque y frenado quepan
+    for (int64_t vel = vel_max; vel > 0; vel = vel * 3 / 4) {
+        servo_tramo_t subida[2], bajada[2];
+        int ns = tramos_rampa(subida, vel, acel_max, forma, 1);
+        int nb = tramos_rampa(bajada, vel, acel_max, forma, -1);
+        int64_t v = 0;
+        int64_t x = simular(subida, ns, &v);
+        int64_t crucero = v;
+        x += simular(bajada, nb, &v);
+        if (crucero <= 0 || x > p->distancia) {
+            continue;
+        }
+
+        // Con un tick de crucero de más el perfil se pasa; como el recorrido
+        // es lineal en aceleración y jerk, basta escalarlos a la baja para
+        // llegar justo sin superar ningún límite.
+        int64_t ticks_crucero = (p->distancia - x) / crucero + 1;
+        double escala = (double)p->distancia / (double)(x + ticks_crucero * crucero);
+        for (int i = 0; i < ns; i++) {
+            p->tramos[p->num_tramos++] = subida[i];
+        }
+        p->tramos[p->num_tramos++] = (servo_tramo_t){ (uint32_t)ticks_crucero, 0, 0 };
+        for (int i = 0; i < nb; i++) {
+            p->tramos[p->num_tramos++] = bajada[i];
+        }
+        for (int i = 0; i < p->num_tramos; i++) {
+            p->tramos[i].acel = llround(p->tramos[i].acel * escala);
+            p->tramos[i].jerk = llround(p->tramos[i].jerk * escala);
+        }
+        p->moviendo = true;
+        return true;
+    }
+    // Menos de un tick de recorrido: el destino se aplica directamente
+    p->origen = hasta;
+    return true;
+}
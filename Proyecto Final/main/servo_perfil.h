@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Perfiles de movimiento para servos, en enteros y por ticks de actualización.
+// La planificación simula los tramos aquí mismo; la ISR solo integra
+// jerk -> aceleración -> velocidad -> posición con sumas. No depende de ESP-IDF.
+// Posiciones en µs de pulso en Q32; velocidades por tick y aceleraciones por
+// tick al cuadrado, en la misma escala.
+
+#define SERVO_PERFIL_Q 32
+#define SERVO_PERFIL_MAX_TRAMOS 5
+#define SERVO_PERFIL_MAX_TICKS_RAMPA 65535u
+
+typedef enum {
+    SERVO_TRAPECIO,
+    SERVO_CURVA_S,
+    SERVO_NUM_FORMAS
+} servo_forma_t;
+
+// Al entrar al tramo la aceleración pasa a 'acel'; en cada tick se suma 'jerk'
+typedef struct {
+    uint32_t ticks;
+    int64_t acel;
+    int64_t jerk;
+} servo_tramo_t;
+
+typedef struct {
+    int64_t origen;
+    int64_t destino;
+    int64_t distancia;
+    int64_t recorrido;              // desplazamiento desde el origen, 0..distancia
+    int64_t velocidad;
+    int64_t aceleracion;
+    int64_t jerk;
+    servo_tramo_t tramos[SERVO_PERFIL_MAX_TRAMOS];
+    int num_tramos;
+    int tramo;
+    uint32_t restantes;
+    bool moviendo;
+} servo_perfil_t;
+
+// Trapecio: aceleración constante hasta la velocidad máxima, crucero y
+// frenado. Curva S: la aceleración sube y baja en rampa (jerk acotado) con
+// pico en acel_max. En trayectos cortos baja la velocidad de crucero; falla
+// si arrancar llevaría más de SERVO_PERFIL_MAX_TICKS_RAMPA ticks.
+bool servo_perfil_planificar(servo_perfil_t *p, int64_t desde, int64_t hasta, int64_t vel_max, int64_t acel_max,
+                             servo_forma_t forma);
+void servo_perfil_fijar(servo_perfil_t *p, int64_t posicion);
+
+// Un tick: devuelve la posición; al acabar el último tramo fija el destino
+// exacto (el redondeo de los tramos queda por debajo de un tick de crucero).
+static inline int64_t servo_perfil_avanzar(servo_perfil_t *p) {
+    if (!p->moviendo) {
+        return p->destino;
+    }
+    while (p->restantes == 0) {
+        if (++p->tramo >= p->num_tramos) {
+            p->moviendo = false;
+            p->origen = p->destino;
+            return p->destino;
+        }
+        p->restantes = p->tramos[p->tramo].ticks;
+        p->aceleracion = p->tramos[p->tramo].acel;
+        p->jerk = p->tramos[p->tramo].jerk;
+    }
+    p->restantes--;
+    p->velocidad += p->aceleracion;
+    p->recorrido += p->velocidad;
+    p->aceleracion += p->jerk;
+    if (p->recorrido > p->distancia) {
+        p->recorrido = p->distancia;
+    }
+    return p->destino >= p->origen ? p->origen + p->recorrido : p->origen - p->recorrido;
+}
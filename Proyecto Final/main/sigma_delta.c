@@ -0,0 +1,175 @@
+#include "sigma_delta.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "driver/sdm.h"
+#include "freertos/FreeRTOS.h"
+#include "dds.h"
+
+#define TAG "SIGMA_DELTA"
+#define SIGMA_RESOLUCION_HZ 1000000
+
+// La densidad de pulsos va de -128 (siempre en bajo) a 127 (casi siempre en
+// alto); nivel y amplitud se guardan ya en esas unidades, en Q15.
+typedef struct {
+    int gpio;
+    sdm_channel_handle_t sdm;
+    dds_t oscilador;
+    int32_t nivel_q15;
+    int32_t amplitud_q15;
+} sigma_estado_t;
+
+static sigma_estado_t canales[SIGMA_MAX_CANALES];
+static int num_canales;
+static int16_t seno[1 << SIGMA_BITS_TABLA];
+static bool tabla_lista;
+static gptimer_handle_t temporizador;
+static portMUX_TYPE sigma_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int8_t densidad(int32_t q15) {
+    int32_t d = (q15 >> 15) - 128;
+    return d < -128 ? -128 : (d > 127 ? 127 : d);
+}
+
+static bool IRAM_ATTR muestra_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    portENTER_CRITICAL_ISR(&sigma_lock);
+    for (int i = 0; i < num_canales; i++) {
+        sigma_estado_t *c = &canales[i];
+        if (c->amplitud_q15 != 0) {
+            int32_t s = seno[dds_indice(dds_avanzar(&c->oscilador), SIGMA_BITS_TABLA)];
+            int32_t v = c->nivel_q15 + (int32_t)(((int64_t)s * c->amplitud_q15) >> 15);
+            sdm_channel_set_pulse_density(c->sdm, densidad(v));
+        }
+    }
+    portEXIT_CRITICAL_ISR(&sigma_lock);
+    return false;
+}
+
+static esp_err_t crear_temporizador(void) {
+    if (temporizador != NULL) {
+        return ESP_OK;
+    }
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = SIGMA_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = muestra_isr,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(temporizador, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(temporizador));
+    gptimer_alarm_config_t alarma = {
+        .reload_count = 0,
+        .alarm_count = SIGMA_RESOLUCION_HZ / SIGMA_MUESTREO_HZ,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(temporizador, &alarma));
+    return gptimer_start(temporizador);
+}
+
+static void borrar_temporizador(void) {
+    if (temporizador == NULL) {
+        return;
+    }
+    gptimer_stop(temporizador);
+    gptimer_disable(temporizador);
+    gptimer_del_timer(temporizador);
+    temporizador = NULL;
+}
+
+// Sin canales con seno el temporizador sobra: las densidades fijas las
+// mantiene el periférico solo.
+static esp_err_t ajustar_temporizador(void) {
+    for (int i = 0; i < num_canales; i++) {
+        if (canales[i].amplitud_q15 != 0) {
+            return crear_temporizador();
+        }
+    }
+    borrar_temporizador();
+    return ESP_OK;
+}
+
+static int buscar(int gpio) {
+    for (int i = 0; i < num_canales; i++) {
+        if (canales[i].gpio == gpio) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t sigma_delta_aplicar(const sigma_canal_t *cfg) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(cfg->gpio) || cfg->nivel_permil > 1000 || cfg->amplitud_permil > 1000 ||
+        cfg->frecuencia_mhz > SIGMA_MAX_MHZ || (cfg->amplitud_permil > 0 && cfg->frecuencia_mhz == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!tabla_lista) {
+        dds_tabla_seno(seno, SIGMA_BITS_TABLA);
+        tabla_lista = true;
+    }
+
+    int i = buscar(cfg->gpio);
+    if (i < 0) {
+        if (num_canales >= SIGMA_MAX_CANALES) {
+            return ESP_ERR_NO_MEM;
+        }
+        sdm_config_t sdm_config = {
+            .gpio_num = cfg->gpio,
+            .clk_src = SDM_CLK_SRC_DEFAULT,
+            .sample_rate_hz = SIGMA_RELOJ_HZ,
+        };
+        sdm_channel_handle_t sdm;
+        ESP_RETURN_ON_ERROR(sdm_new_channel(&sdm_config, &sdm), TAG, "sin canal sigma-delta libre");
+        ESP_ERROR_CHECK(sdm_channel_enable(sdm));
+        portENTER_CRITICAL(&sigma_lock);
+        i = num_canales;
+        canales[i] = (sigma_estado_t){ .gpio = cfg->gpio, .sdm = sdm };
+        num_canales++;
+        portEXIT_CRITICAL(&sigma_lock);
+    }
+
+    // 256 cuentas de densidad por 1000 de nivel, en Q15
+    int32_t nivel_q15 = (int32_t)(((int64_t)cfg->nivel_permil << 23) / 1000);
+    int32_t amplitud_q15 = (int32_t)(((int64_t)cfg->amplitud_permil << 23) / 1000);
+    portENTER_CRITICAL(&sigma_lock);
+    canales[i].nivel_q15 = nivel_q15;
+    canales[i].amplitud_q15 = amplitud_q15;
+    canales[i].oscilador.incremento = dds_incremento(cfg->frecuencia_mhz, SIGMA_MUESTREO_HZ);
+    portEXIT_CRITICAL(&sigma_lock);
+    if (amplitud_q15 == 0) {
+        sdm_channel_set_pulse_density(canales[i].sdm, densidad(nivel_q15));
+    }
+    return ajustar_temporizador();
+}
+
+esp_err_t sigma_delta_quitar(int gpio) {
+    int i = buscar(gpio);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    sdm_channel_handle_t sdm = canales[i].sdm;
+    portENTER_CRITICAL(&sigma_lock);
+    canales[i] = canales[--num_canales];
+    portEXIT_CRITICAL(&sigma_lock);
+
+    sdm_channel_disable(sdm);
+    sdm_del_channel(sdm);
+    gpio_set_direction(gpio, GPIO_MODE_OUTPUT);
+    gpio_set_level(gpio, 0);
+    return ajustar_temporizador();
+}
+
+esp_err_t sigma_delta_detener(void) {
+    if (num_canales == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    while (num_canales > 0) {
+        sigma_delta_quitar(canales[0].gpio);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Niveles analógicos por el modulador sigma-delta en cualquier GPIO de
+// salida; con un filtro RC se obtiene una tensión continua o una onda lenta.
+#define SIGMA_MAX_CANALES 8
+#define SIGMA_RELOJ_HZ 5000000
+#define SIGMA_MUESTREO_HZ 10000
+#define SIGMA_BITS_TABLA 8
+#define SIGMA_MAX_MHZ (500 * 1000ULL)
+
+typedef struct {
+    int gpio;
+    uint16_t nivel_permil;          // nivel medio, 0..1000 de VDD
+    uint16_t amplitud_permil;       // pico del seno, 0 para nivel fijo
+    uint64_t frecuencia_mhz;
+} sigma_canal_t;
+
+// Crea el canal o, si el GPIO ya tiene uno, cambia sus parámetros en marcha.
+// Los canales con seno los alimenta un temporizador a SIGMA_MUESTREO_HZ.
+esp_err_t sigma_delta_aplicar(const sigma_canal_t *canal);
+esp_err_t sigma_delta_quitar(int gpio);
+esp_err_t sigma_delta_detener(void);
@@ -0,0 +1,280 @@
+#include "zumbador.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "dds.h"
+#include "recursos.h"
+
+#define TAG "ZUMBADOR"
+#define ZUMBADOR_RESOLUCION_HZ 1000000
+// Con 11 bits el divisor del LEDC cubre de unos 40 Hz a 20 kHz
+#define ZUMBADOR_BITS 11
+
+// Divisor Q10.8 por nota MIDI, 0 si la nota queda fuera del rango del LEDC
+static uint32_t divisores[MELODIA_NOTAS_MIDI];
+static melodia_nota_t cola[ZUMBADOR_COLA];
+static uint32_t escritas;
+static uint32_t leidas;
+static uint32_t separacion_us;
+static uint32_t duty_actual;
+static bool sonando;
+// Cuenta en que vence la alarma de la cadena en curso; una ISR con otra es
+// de una cadena ya callada que esperaba el cerrojo
+static uint64_t alarma_us;
+// Solo existe mientras suena algo: se toma al encolar con la cola parada y
+// se suelta cuando se vacía
+static gptimer_handle_t temporizador;
+static portMUX_TYPE zumbador_lock = portMUX_INITIALIZER_UNLOCKED;
+// Serializa crear, arrancar y soltar el temporizador entre tareas
+static SemaphoreHandle_t mutex;
+
+static void IRAM_ATTR fijar_duty(uint32_t duty) {
+    if (duty != duty_actual) {
+        duty_actual = duty;
+        ledc_set_duty(ZUMBADOR_LEDC_MODO, ZUMBADOR_LEDC_CANAL, duty);
+        ledc_update_duty(ZUMBADOR_LEDC_MODO, ZUMBADOR_LEDC_CANAL);
+    }
+}
+
+// Pasa a la fase siguiente (separación o nota nueva) y devuelve cuántos µs
+// dura; 0 cuando la cola se vació. Se llama con zumbador_lock tomado y deja
+// sonando como está: quien llama lo publica tras parar o arrancar la alarma.
+static uint32_t IRAM_ATTR avanzar(void) {
+    if (separacion_us > 0) {
+        uint32_t us = separacion_us;
+        separacion_us = 0;
+        fijar_duty(0);
+        return us;
+    }
+    if (leidas == escritas) {
+        fijar_duty(0);
+        return 0;
+    }
+    melodia_nota_t n = cola[leidas++ % ZUMBADOR_COLA];
+    uint32_t us = n.duracion_ms * 1000u;
+    if (n.nota == MELODIA_SILENCIO) {
+        fijar_duty(0);
+        return us;
+    }
+    // El divisor nuevo entra al desbordar el contador del LEDC, sin cortes
+    ledc_timer_set(ZUMBADOR_LEDC_MODO, ZUMBADOR_LEDC_TIMER, divisores[n.nota], ZUMBADOR_BITS, LEDC_APB_CLK);
+    fijar_duty(1u << (ZUMBADOR_BITS - 1));
+    separacion_us = us / 4 < ZUMBADOR_SEPARACION_MS * 1000u ? us / 4 : ZUMBADOR_SEPARACION_MS * 1000u;
+    return us - separacion_us;
+}
+
+// Con el mutex tomado y la alarma parada
+static void soltar(void) {
+    if (temporizador != NULL) {
+        gptimer_disable(temporizador);
+        gptimer_del_timer(temporizador);
+        temporizador = NULL;
+    }
+}
+
+// Se ejecuta en la tarea de temporizadores de FreeRTOS, pedida por la ISR
+// al vaciarse la cola; si entretanto se encoló algo, el temporizador sigue
+static void soltar_temporizador(void *arg, uint32_t sin_uso) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&zumbador_lock);
+    bool parado = !sonando;
+    portEXIT_CRITICAL(&zumbador_lock);
+    if (parado) {
+        soltar();
+    }
+    xSemaphoreGive(mutex);
+}
+
+static bool IRAM_ATTR nota_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    bool vacia = false;
+    portENTER_CRITICAL_ISR(&zumbador_lock);
+    if (sonando && edata->alarm_value == alarma_us) {
+        uint32_t us = avanzar();
+        if (us == 0) {
+            // Parado antes de publicarlo: quien vea la cola quieta ya puede
+            // rearmar la alarma sin que esta ISR la pare después
+            gptimer_stop(timer);
+            sonando = false;
+            vacia = true;
+        } else {
+            alarma_us = edata->alarm_value + us;
+            gptimer_alarm_config_t alarma = {
+                .alarm_count = alarma_us,
+            };
+            gptimer_set_alarm_action(timer, &alarma);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&zumbador_lock);
+
+    // Si la cola de la tarea está llena el temporizador se reutiliza en el
+    // próximo encolar y se suelta al callar
+    BaseType_t despertar = pdFALSE;
+    if (vacia) {
+        xTimerPendFunctionCallFromISR(soltar_temporizador, NULL, 0, &despertar);
+    }
+    return despertar == pdTRUE;
+}
+
+// Con el mutex tomado
+static esp_err_t tomar_temporizador(void) {
+    if (temporizador != NULL) {
+        return ESP_OK;
+    }
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = ZUMBADOR_RESOLUCION_HZ,
+    };
+    ESP_RETURN_ON_ERROR(gptimer_new_timer(&timer_config, &temporizador), TAG, "sin temporizador libre");
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = nota_isr,
+    };
+    esp_err_t err = gptimer_register_event_callbacks(temporizador, &cbs, NULL);
+    if (err == ESP_OK) {
+        err = gptimer_enable(temporizador);
+    }
+    if (err != ESP_OK) {
+        gptimer_del_timer(temporizador);
+        temporizador = NULL;
+    }
+    return err;
+}
+
+// Con el mutex tomado. Parar antes de vaciar deja sin trabajo a una ISR
+// que ya estuviera en marcha.
+static void vaciar(void) {
+    if (temporizador != NULL) {
+        gptimer_stop(temporizador);
+    }
+    portENTER_CRITICAL(&zumbador_lock);
+    leidas = escritas;
+    separacion_us = 0;
+    sonando = false;
+    fijar_duty(0);
+    portEXIT_CRITICAL(&zumbador_lock);
+}
+
+esp_err_t zumbador_iniciar(int gpio) {
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(gpio)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < MELODIA_NOTAS_MIDI; i++) {
+        uint32_t divisor = dds_ledc_divisor(melodia_frecuencia_mhz(i), LEDC_RELOJ_HZ, ZUMBADOR_BITS);
+        divisores[i] = divisor >= DDS_LEDC_DIVISOR_MIN && divisor <= DDS_LEDC_DIVISOR_MAX ? divisor : 0;
+    }
+
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = ZUMBADOR_LEDC_MODO,
+        .timer_num = ZUMBADOR_LEDC_TIMER,
+        .duty_resolution = ZUMBADOR_BITS,
+        .freq_hz = 440,
+        .clk_cfg = LEDC_USE_APB_CLK
+    };
+    ESP_RETURN_ON_ERROR(ledc_timer_config(&ledc_timer), TAG, "temporizador LEDC");
+    ledc_channel_config_t ledc_channel = {
+        .gpio_num = gpio,
+        .speed_mode = ZUMBADOR_LEDC_MODO,
+        .channel = ZUMBADOR_LEDC_CANAL,
+        .timer_sel = ZUMBADOR_LEDC_TIMER,
+        .duty = 0,
+        .hpoint = 0
+    };
+    ESP_RETURN_ON_ERROR(ledc_channel_config(&ledc_channel), TAG, "canal LEDC");
+
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Zumbador en GPIO %d", gpio);
+    return ESP_OK;
+}
+
+esp_err_t zumbador_encolar(const melodia_nota_t *notas, int num_notas, bool interrumpir) {
+    if (mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (num_notas <= 0 || num_notas > ZUMBADOR_COLA) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < num_notas; i++) {
+        if (notas[i].duracion_ms == 0 ||
+            (notas[i].nota != MELODIA_SILENCIO && (notas[i].nota >= MELODIA_NOTAS_MIDI || divisores[notas[i].nota] == 0))) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if (interrumpir) {
+        vaciar();
+    }
+    esp_err_t err = tomar_temporizador();
+    if (err != ESP_OK) {
+        xSemaphoreGive(mutex);
+        return err;
+    }
+    // La cuenta no se reinicia: la alarma nueva siempre queda por delante de
+    // la de una cadena anterior
+    uint64_t cuenta = 0;
+    gptimer_get_raw_count(temporizador, &cuenta);
+
+    portENTER_CRITICAL(&zumbador_lock);
+    if (ZUMBADOR_COLA - (escritas - leidas) < (uint32_t)num_notas) {
+        portEXIT_CRITICAL(&zumbador_lock);
+        xSemaphoreGive(mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < num_notas; i++) {
+        cola[escritas++ % ZUMBADOR_COLA] = notas[i];
+    }
+    // Con la cola parada la primera nota se aplica aquí y la alarma sigue
+    // sola; se arranca dentro del cerrojo para que la ISR vea la cadena
+    // entera o nada de ella
+    if (!sonando) {
+        alarma_us = cuenta + avanzar();
+        gptimer_alarm_config_t alarma = {
+            .alarm_count = alarma_us,
+        };
+        err = gptimer_set_alarm_action(temporizador, &alarma);
+        if (err == ESP_OK) {
+            err = gptimer_start(temporizador);
+        }
+        if (err == ESP_OK) {
+            sonando = true;
+        } else {
+            leidas = escritas;
+            separacion_us = 0;
+            fijar_duty(0);
+        }
+    }
+    portEXIT_CRITICAL(&zumbador_lock);
+    xSemaphoreGive(mutex);
+    return err;
+}
+
+esp_err_t zumbador_tono(uint8_t nota, uint16_t duracion_ms) {
+    melodia_nota_t n = { .nota = nota, .duracion_ms = duracion_ms };
+    return zumbador_encolar(&n, 1, false);
+}
+
+int zumbador_pendientes(void) {
+    portENTER_CRITICAL(&zumbador_lock);
+    int n = (int)(escritas - leidas);
+    portEXIT_CRITICAL(&zumbador_lock);
+    return n;
+}
+
+esp_err_t zumbador_callar(void) {
+    if (mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    vaciar();
+    soltar();
+    xSemaphoreGive(mutex);
+    return ESP_OK;
+}
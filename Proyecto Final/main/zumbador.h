@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "melodia.h"
+
+// Zumbador pasivo por LEDC. Las notas esperan en una cola circular y las va
+// encadenando una alarma de GPTimer (una por nota y otra por la separación),
+// sin despertar ninguna tarea. El GPTimer se toma al encolar con la cola
+// parada y se suelta al vaciarse. Encolar no espera a que suene nada y
+// devuelve los errores en lugar de abortar: si no cabe la melodía entera,
+// ESP_ERR_NO_MEM sin tocar la cola; sin GPTimer libre, el error de
+// gptimer_new_timer.
+#define ZUMBADOR_COLA 128
+// Silencio al final de cada nota para que dos iguales seguidas se distingan
+#define ZUMBADOR_SEPARACION_MS 10
+
+esp_err_t zumbador_iniciar(int gpio);
+// Con interrumpir se vacía la cola y la melodía suena ya (alarmas)
+esp_err_t zumbador_encolar(const melodia_nota_t *notas, int num_notas, bool interrumpir);
+esp_err_t zumbador_tono(uint8_t nota, uint16_t duracion_ms);
+int zumbador_pendientes(void);
+esp_err_t zumbador_callar(void);
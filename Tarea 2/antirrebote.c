@@ -0,0 +1,66 @@
+#include "antirrebote.h"
+
+#define BIT_PIN(i) ((uint64_t)1 << (i))
+
+void antirreboteIniciar(Antirrebote *a, uint64_t pines, uint64_t nivel, uint32_t ventanaUs) {
+    *a = (Antirrebote){
+        .pines = pines,
+        .crudo = nivel & pines,
+        .estable = nivel & pines,
+    };
+    for (int i = 0; i < ANTIRREBOTE_PINES; i++) {
+        a->ventanaUs[i] = ventanaUs;
+    }
+}
+
+void antirreboteVentana(Antirrebote *a, int pin, uint32_t ventanaUs) {
+    a->ventanaUs[pin] = ventanaUs;
+}
+
+uint64_t antirreboteMuestra(Antirrebote *a, uint64_t crudo, int64_t ahoraUs) {
+    crudo &= a->pines;
+    uint64_t cambiados = crudo ^ a->crudo;
+    a->crudo = crudo;
+    while (cambiados != 0) {
+        int i = __builtin_ctzll(cambiados);
+        cambiados &= cambiados - 1;
+        if (a->abiertas & BIT_PIN(i)) {
+            a->rebotes[i]++;
+        }
+        a->abiertas |= BIT_PIN(i);
+        a->cambioUs[i] = ahoraUs;
+    }
+
+    uint64_t aceptados = 0;
+    uint64_t abiertas = a->abiertas;
+    while (abiertas != 0) {
+        int i = __builtin_ctzll(abiertas);
+        abiertas &= abiertas - 1;
+        if (ahoraUs - a->cambioUs[i] < a->ventanaUs[i]) {
+            continue;
+        }
+        a->abiertas &= ~BIT_PIN(i);
+        if ((crudo ^ a->estable) & BIT_PIN(i)) {
+            aceptados |= BIT_PIN(i);
+            a->cambios[i]++;
+        } else {
+            a->descartes[i]++;
+        }
+    }
+    a->estable ^= aceptados;
+    return aceptados;
+}
+
+int64_t antirreboteProximo(const Antirrebote *a) {
+    int64_t proximo = 0;
+    uint64_t abiertas = a->abiertas;
+    while (abiertas != 0) {
+        int i = __builtin_ctzll(abiertas);
+        abiertas &= abiertas - 1;
+        int64_t cierreUs = a->cambioUs[i] + a->ventanaUs[i];
+        if (proximo == 0 || cierreUs < proximo) {
+            proximo = cierreUs;
+        }
+    }
+    return proximo;
+}
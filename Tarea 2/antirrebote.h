@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+// Antirrebote por ventana de estabilidad, con un bit por GPIO. Cada cambio
+// del nivel crudo abre (o reinicia) la ventana de su pin; al cerrarse sin
+// más cambios el nivel pasa a estable si difiere del anterior, y si no se
+// cuenta como pulso descartado. No hay muestreo periódico: quien lo usa
+// entrega lecturas al llegar un flanco y cuando vence antirreboteProximo.
+// No depende de ESP-IDF.
+
+#define ANTIRREBOTE_PINES 64
+
+typedef struct {
+    uint64_t pines;                 // pines vigilados
+    uint64_t crudo;                 // última lectura
+    uint64_t estable;               // nivel ya filtrado
+    uint64_t abiertas;              // pines con la ventana abierta
+    uint32_t ventanaUs[ANTIRREBOTE_PINES];
+    int64_t cambioUs[ANTIRREBOTE_PINES];
+    // Estadísticas por pin
+    uint32_t cambios[ANTIRREBOTE_PINES];     // cambios aceptados
+    uint32_t rebotes[ANTIRREBOTE_PINES];     // cambios dentro de una ventana abierta
+    uint32_t descartes[ANTIRREBOTE_PINES];   // ventanas cerradas en el nivel de antes
+} Antirrebote;
+
+void antirreboteIniciar(Antirrebote *a, uint64_t pines, uint64_t nivel, uint32_t ventanaUs);
+void antirreboteVentana(Antirrebote *a, int pin, uint32_t ventanaUs);
+// Devuelve los pines cuyo nivel estable cambió con esta lectura
+uint64_t antirreboteMuestra(Antirrebote *a, uint64_t crudo, int64_t ahoraUs);
+// Cierre de la primera ventana abierta, 0 si no hay ninguna
+int64_t antirreboteProximo(const Antirrebote *a);
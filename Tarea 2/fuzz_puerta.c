@@ -0,0 +1,217 @@
+// Fuzzing del controlador de las puertas con invariantes de seguridad
+// comprobadas tras cada evento. Ejercita portones.c, el bucle que corre en el
+// firmware, con una puerta; las entradas llegan como en main.c: niveles de
+// botones y sensor por portonesEntradas, falla, rearme y llegada sueltos.
+// Con libFuzzer (guiado por cobertura):
+//   clang -g -O1 -fsanitize=fuzzer,address fuzz_puerta.c portones.c puerta_fsm.c -o fuzz_puerta
+//   ./fuzz_puerta -max_len=512
+//   ./fuzz_puerta -minimize_crash=1 -runs=100000 crash-<hash>
+// Sin clang, búsqueda aleatoria con minimización propia:
+//   gcc -O2 -std=c99 -DPUERTA_FUZZ_AUTONOMO fuzz_puerta.c portones.c puerta_fsm.c -o fuzz_puerta
+//   ./fuzz_puerta semilla iteraciones
+//   ./fuzz_puerta mutante iteraciones
+// El modo mutante comprueba el propio fuzzer: las invariantes ven la puerta
+// como si portones no hubiera señalizado la falla, y debe salir una traza.
+// Cada fallo se imprime como traza de simulador.c ("ms evento"), que corre
+// el mismo portones.c con una puerta.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "portones.h"
+
+#define TIEMPO_MOVIMIENTO_MS 30000
+#define TIEMPO_ESPERA_MS 2000
+// Cada paso son dos bytes: la entrada y la espera previa en cuartos de segundo
+#define BYTES_POR_PASO 2
+#define MS_POR_UNIDAD 250
+#define PUERTA 0
+#define BIT ((MascaraPortones)1 << PUERTA)
+
+static const struct {
+    const char *nombre;
+    EventoPuerta evento;
+} entradas[] = {
+    {"abrir", EVENTO_ABRIR}, {"cerrar", EVENTO_CERRAR}, {"paro", EVENTO_PARO}, {"obstaculo", EVENTO_OBSTACULO},
+    {"libre", EVENTO_LIBRE}, {"falla", EVENTO_FALLA},   {"rearme", EVENTO_REARME}, {"llegada", EVENTO_LLEGADA},
+};
+#define NUM_ENTRADAS (sizeof(entradas) / sizeof(entradas[0]))
+
+static Portones portones;
+static MascaraPortones niveles[PORTONES_NUM_ENTRADAS];
+// Instante de la entrega en curso: los eventos de la rueda ocurren antes
+static int64_t instanteUs;
+static const char *violacion;
+static int64_t violacionUs;
+static bool sinParpadeo;
+
+static void fallar(const char *motivo) {
+    if (violacion == NULL) {
+        violacion = motivo;
+        violacionUs = instanteUs;
+    }
+}
+
+// Invariantes tras cada evento, sea externo, plazo o fin de parpadeo
+static void comprobar(void *usuario, const Portones *real, int i, EventoPuerta evento, EstadoPuerta anterior,
+                      AccionPuerta accion) {
+    (void)usuario;
+    const Portones *p = real;
+    Portones mutante;
+    if (sinParpadeo && accion == ACCION_SENALIZAR_FALLA) {
+        mutante = *real;
+        mutante.falla &= ~BIT;
+        mutante.vencimientoUs[i] = 0;
+        p = &mutante;
+    }
+    EstadoPuerta estado = (EstadoPuerta)p->estado[i];
+    bool abriendo = (p->abriendo & BIT) != 0, cerrando = (p->cerrando & BIT) != 0;
+    if (estado == CERRANDO && (p->obstaculo & BIT)) {
+        fallar("cerrando con el obstáculo presente");
+    }
+    if (evento == EVENTO_PARO && (abriendo || cerrando)) {
+        fallar("el paro no detuvo el motor");
+    }
+    if (abriendo != (estado == ABRIENDO) || cerrando != (estado == CERRANDO)) {
+        fallar("el motor no corresponde al estado");
+    }
+    if ((estado == ABRIENDO || estado == CERRANDO) &&
+        (p->vencimientoUs[i] == 0 || p->vencimientoUs[i] != p->plazoUs[i] ||
+         p->plazoUs[i] > instanteUs + (int64_t)TIEMPO_MOVIMIENTO_MS * 1000)) {
+        fallar("movimiento sin fin de recorrido pendiente");
+    }
+    // Al entrar en ERROR la falla se señaliza y su fin queda en la rueda
+    if (estado == ERROR && anterior != ERROR && (!(p->falla & BIT) || p->vencimientoUs[i] == 0)) {
+        fallar("en ERROR sin señalizar la falla");
+    }
+}
+
+static void entregar(EventoPuerta evento) {
+    switch (evento) {
+        case EVENTO_ABRIR:
+        case EVENTO_CERRAR:
+        case EVENTO_PARO: {
+            // Pulsación completa en la misma lectura y suelta en la siguiente
+            int e = evento == EVENTO_ABRIR ? ENTRADA_ABRIR : evento == EVENTO_CERRAR ? ENTRADA_CERRAR : ENTRADA_PARO;
+            niveles[e] |= BIT;
+            portonesEntradas(&portones, niveles, instanteUs);
+            niveles[e] &= ~BIT;
+            portonesEntradas(&portones, niveles, instanteUs);
+            break;
+        }
+        case EVENTO_OBSTACULO:
+        case EVENTO_LIBRE:
+            niveles[ENTRADA_OBSTACULO] = evento == EVENTO_OBSTACULO ? BIT : 0;
+            portonesEntradas(&portones, niveles, instanteUs);
+            break;
+        default:
+            portonesEvento(&portones, PUERTA, evento, instanteUs);
+            break;
+    }
+}
+
+// Devuelve la primera invariante violada, o NULL
+static const char *ejecutar(const uint8_t *datos, size_t tam) {
+    portonesIniciar(&portones, 1, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS, 0, 0);
+    portones.observador = comprobar;
+    for (int e = 0; e < PORTONES_NUM_ENTRADAS; e++) {
+        niveles[e] = 0;
+    }
+    violacion = NULL;
+    instanteUs = 0;
+    for (size_t i = 0; i + BYTES_POR_PASO <= tam && violacion == NULL; i += BYTES_POR_PASO) {
+        instanteUs += (int64_t)datos[i + 1] * MS_POR_UNIDAD * 1000;
+        entregar(entradas[datos[i] % NUM_ENTRADAS].evento);
+    }
+    // Los plazos pendientes también tienen que cumplir
+    instanteUs += 10 * (int64_t)TIEMPO_MOVIMIENTO_MS * 1000;
+    portonesAvanzar(&portones, instanteUs);
+    return violacion;
+}
+
+static void imprimirTraza(const uint8_t *datos, size_t tam, const char *motivo) {
+    fprintf(stderr, "# violación a %.3f s: %s\n", violacionUs / 1e6, motivo);
+    int64_t ms = 0;
+    for (size_t i = 0; i + BYTES_POR_PASO <= tam; i += BYTES_POR_PASO) {
+        ms += (int64_t)datos[i + 1] * MS_POR_UNIDAD;
+        fprintf(stderr, "%lld %s\n", (long long)ms, entradas[datos[i] % NUM_ENTRADAS].nombre);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *datos, size_t tam) {
+    const char *motivo = ejecutar(datos, tam);
+    if (motivo != NULL) {
+        imprimirTraza(datos, tam, motivo);
+        abort();
+    }
+    return 0;
+}
+
+#ifdef PUERTA_FUZZ_AUTONOMO
+#define MAX_PASOS 256
+
+static uint32_t semilla;
+
+static uint32_t aleatorio() {
+    semilla ^= semilla << 13;
+    semilla ^= semilla >> 17;
+    semilla ^= semilla << 5;
+    return semilla;
+}
+
+// Quita pasos y acorta esperas mientras siga fallando
+static size_t minimizar(uint8_t *datos, size_t tam) {
+    uint8_t prueba[MAX_PASOS * BYTES_POR_PASO];
+    int mejorado = 1;
+    while (mejorado) {
+        mejorado = 0;
+        for (size_t i = 0; i < tam; i += BYTES_POR_PASO) {
+            size_t n = 0;
+            for (size_t j = 0; j < tam; j++) {
+                if (j < i || j >= i + BYTES_POR_PASO) prueba[n++] = datos[j];
+            }
+            if (ejecutar(prueba, n) != NULL) {
+                for (size_t j = 0; j < n; j++) datos[j] = prueba[j];
+                tam = n;
+                mejorado = 1;
+                i -= BYTES_POR_PASO;
+            }
+        }
+        for (size_t i = 1; i < tam; i += BYTES_POR_PASO) {
+            uint8_t espera = datos[i];
+            while (datos[i] > 0) {
+                datos[i] /= 2;
+                if (ejecutar(datos, tam) == NULL) {
+                    datos[i] = espera;
+                    break;
+                }
+                espera = datos[i];
+                mejorado = 1;
+            }
+        }
+    }
+    return tam;
+}
+
+int main(int argc, char **argv) {
+    sinParpadeo = argc > 1 && strcmp(argv[1], "mutante") == 0;
+    semilla = argc > 1 && !sinParpadeo ? (uint32_t)strtoul(argv[1], NULL, 0) : 1;
+    unsigned long iteraciones = argc > 2 ? strtoul(argv[2], NULL, 0) : 100000;
+    if (semilla == 0) semilla = 1;
+    uint8_t datos[MAX_PASOS * BYTES_POR_PASO];
+    for (unsigned long k = 0; k < iteraciones; k++) {
+        size_t tam = (1 + aleatorio() % MAX_PASOS) * BYTES_POR_PASO;
+        for (size_t i = 0; i < tam; i++) {
+            datos[i] = (uint8_t)aleatorio();
+        }
+        if (ejecutar(datos, tam) != NULL) {
+            tam = minimizar(datos, tam);
+            imprimirTraza(datos, tam, ejecutar(datos, tam));
+            return !sinParpadeo;
+        }
+    }
+    printf("%lu trazas sin violaciones\n", iteraciones);
+    return sinParpadeo;
+}
+#endif
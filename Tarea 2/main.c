@@ -1,10 +1,63 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/pulse_cnt.h"
+#include "esp_adc/adc_oneshot.h"
 #include "esp_timer.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
+#if SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+#include "driver/gpio_filter.h"
+#endif
+#include "antirrebote.h"
+#include "posicion.h"
+#include "rampas.h"
+
+// Pines de cada puerta; para servir otra basta con aadir su fila. Las
+// entradas son activas en bajo. Con motorPwm la puerta se mueve con un
+// TB6612: motorAbrir y motorCerrar son IN1 e IN2 y el PWM sigue las rampas.
+// La puerta 0 no tiene motor: LED_ESTADO hace de motor y se enciende
+// mientras abre. Sin encoder ni medida de corriente la llegada es el fin del
+// plazo de movimiento. Las ventanas de antirrebote en 0 toman el valor por
+// defecto.
+typedef struct {
+    gpio_num_t abrir;
+    gpio_num_t cerrar;
+    gpio_num_t paro;
+    gpio_num_t obstaculo;
+    gpio_num_t motorAbrir;
+    gpio_num_t motorCerrar;     // GPIO_NUM_NC si no hay
+    gpio_num_t motorPwm;        // GPIO_NUM_NC sin puente
+    gpio_num_t falla;
+    gpio_num_t encoderA;        // GPIO_NUM_NC sin encoder
+    gpio_num_t encoderB;
+    int32_t recorrido;          // cuentas del encoder de cerrada a abierta
+    int canalCorriente;         // canal del ADC1 con la corriente del motor
+    int umbralCorriente;        // lectura cruda que marca el tope
+    uint16_t antirreboteBotonesMs;
+    uint16_t antirreboteSensorMs;
+} PinesPuerta;
+
+#define SIN_CORRIENTE -1
+// Los contactos de los botones rebotan unos milisegundos; el sensor, con
+// cable largo, recibe sobre todo picos cortos
+#define ANTIRREBOTE_BOTONES_MS 30
+#define ANTIRREBOTE_SENSOR_MS 10
+// El indicador de falla cambia cada medio segundo
+#define MEDIO_PARPADEO_US 500000
+// Lmite del contador; al alcanzarlo el driver lo acumula y vuelve a cero
+#define ENCODER_LIMITE 30000
+
+// PWM del puente a 20 kHz con 10 bits, un canal de baja velocidad por puerta
+#define MOTOR_LEDC_MODO LEDC_LOW_SPEED_MODE
+#define MOTOR_LEDC_TIMER LEDC_TIMER_0
+#define MOTOR_PWM_HZ 20000
+#define MOTOR_DUTY_MAX 1023
 
-// Definicin de pines
 #define BOTON_ABRIR GPIO_NUM_2
 #define BOTON_CERRAR GPIO_NUM_3
 #define BOTON_PARO GPIO_NUM_4
@@ -12,123 +65,448 @@
 #define LED_ESTADO GPIO_NUM_12
 #define LED_FALLA GPIO_NUM_13
 
-// Definicin de estados
-typedef enum {
-    ESPERA,
-    ABRIENDO,
-    ABIERTA,
-    CERRANDO,
-    CERRADA,
-    DETENIDA,
-    ERROR
-} EstadoPuerta;
+const PinesPuerta pines[] = {
+    {.abrir = BOTON_ABRIR, .cerrar = BOTON_CERRAR, .paro = BOTON_PARO, .obstaculo = SENSOR_OBSTACULO,
+     .motorAbrir = LED_ESTADO, .motorCerrar = GPIO_NUM_NC, .motorPwm = GPIO_NUM_NC, .falla = LED_FALLA,
+     .encoderA = GPIO_NUM_NC, .encoderB = GPIO_NUM_NC, .canalCorriente = SIN_CORRIENTE},
+};
+#define NUM_PUERTAS ((int)(sizeof(pines) / sizeof(pines[0])))
 
 // Variables globales
-EstadoPuerta estadoActual = ESPERA;
-bool obstaculoDetectado = false;
-bool errorSistema = false;
-uint64_t tiempoInicio = 0;
+Portones portones;
+Posiciones posiciones;
+pcnt_unit_handle_t encoders[PORTONES_MAX];
+adc_oneshot_unit_handle_t adcCorriente;
+int32_t cuentas[PORTONES_MAX];
+Rampas rampas;
+const PerfilRampa perfilMotor = {
+    .arranqueUs = 1500000, .paradaUs = 800000, .paradaRapidaUs = 150000, .aproximacionPct = 25};
+int8_t canalMotor[PORTONES_MAX];        // canal LEDC, -1 sin puente
+MascaraPortones conPuente = 0;
 const uint32_t tiempoMovimiento = 30000;
 const uint32_t tiempoEspera = 2000;
+TaskHandle_t tareaPuertas;
+volatile int64_t primerFlancoUs = 0;    // flanco ms antiguo an sin atender, 0 ninguno
+Antirrebote antirrebote;
+esp_timer_handle_t temporizadorAntirrebote;
+esp_timer_handle_t temporizadorPasada;
+volatile uint32_t flancos[ANTIRREBOTE_PINES];    // contados en la interrupcin
+int64_t latenciaMaximaUs = 0;
+MascaraPortones escritasAbrir = 0;
+MascaraPortones escritasCerrar = 0;
+MascaraPortones escritasFalla = 0;
 
 // Prototipos de funciones
 void configurarHardware();
-void gestionarEstado();
-void manejarError();
-void parpadearIndicadorError();
+void configurarPosicion();
+void medirPosicion(int64_t ahoraUs);
+void configurarMotores();
+void aplicarRampas(int64_t ahoraUs);
+void configurarAntirrebote();
+void ventanaCerrada(void *arg);
+void programarPasada(int64_t ahoraUs);
+void pasadaVencida(void *arg);
+uint64_t leerPines();
+void repartirEntradas(uint64_t entrada, MascaraPortones niveles[PORTONES_NUM_ENTRADAS]);
+void mostrarRebotes(uint64_t aceptados);
+void escribirSalidas(int64_t ahoraUs);
+void atenderPuertas();
+void entradaIsr(void *arg);
+void mostrarTransicion(void *usuario, const Portones *p, int puerta, EventoPuerta evento, EstadoPuerta anterior,
+                       AccionPuerta accion);
 
 void app_main() {
-    printf("Iniciando sistema de control de puerta\n");
+    printf("Iniciando sistema de control de %d puertas\n", NUM_PUERTAS);
     configurarHardware();
+    configurarAntirrebote();
+    MascaraPortones niveles[PORTONES_NUM_ENTRADAS];
+    repartirEntradas(antirrebote.estable, niveles);
+    portonesIniciar(&portones, NUM_PUERTAS, tiempoMovimiento, tiempoEspera, niveles[ENTRADA_OBSTACULO],
+                    esp_timer_get_time());
+    portones.observador = mostrarTransicion;
+    configurarPosicion();
+    configurarMotores();
+    esp_timer_create_args_t pasada = {.callback = pasadaVencida, .name = "pasada"};
+    esp_timer_create(&pasada, &temporizadorPasada);
+    tareaPuertas = xTaskGetCurrentTaskHandle();
+    gpio_install_isr_service(0);
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        const gpio_num_t entradas[] = {pines[i].abrir, pines[i].cerrar, pines[i].paro, pines[i].obstaculo};
+        for (int j = 0; j < 4; j++) {
+            gpio_isr_handler_add(entradas[j], entradaIsr, (void *)(intptr_t)entradas[j]);
+        }
+    }
 
+    // Una sola tarea para todas las puertas. La despiertan los flancos, el
+    // cierre del antirrebote y temporizadorPasada, que cada pasada arma para
+    // lo siguiente que tenga fecha.
     while (1) {
-        gestionNarEstado();
-        vTaskDelay(pdMS_TO_TICKS(500));
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        atenderPuertas();
     }
 }
 
-void configurarHardware() {
-    gpio_config_t configuracion;
-    configuracion.intr_type = GPIO_INTR_DISABLE;
-    configuracion.mode = GPIO_MODE_INPUT;
-    configuracion.pin_bit_mask = (1ULL << BOTON_ABRIR) | (1ULL << BOTON_CERRAR) | (1ULL << BOTON_PARO) | (1ULL << SENSOR_OBSTACULO);
-    configuracion.pull_up_en = 1;
-    gpio_config(&configuracion);
-
-    configuracion.mode = GPIO_MODE_OUTPUT;
-    configuracion.pin_bit_mask = (1ULL << LED_ESTADO) | (1ULL << LED_FALLA);
-    gpio_config(&configuracion);
-}
-
-void gestionarEstado() {
-    if (!gpio_get_level(BOTON_ABRIR)) {
-        printf("Apertura iniciada\n");
-        estadoActual = ABRIENDO;
-        tiempoInicio = esp_timer_get_time();
-    }
-    if (!gpio_get_level(BOTON_CERRAR)) {
-        printf("Cierre iniciado\n");
-        estadoActual = CERRANDO;
-        tiempoInicio = esp_timer_get_time();
-    }
-    if (!gpio_get_level(BOTON_PARO)) {
-        printf("Operacin detenida\n");
-        estadoActual = DETENIDA;
-    }
-    if (!gpio_get_level(SENSOR_OBSTACULO)) {
-        printf("Obstculo detectado\n");
-        obstaculoDetectado = true;
-    } else {
-        obstaculoDetectado = false;
-    }
-
-    switch (estadoActual) {
-        case ESPERA:
-            gpio_set_level(LED_ESTADO, 0);
-            break;
-        case ABRIENDO:
-            gpio_set_level(LED_ESTADO, 1);
-            if ((esp_timer_get_time() - tiempoInicio) / 1000 >= tiempoMovimiento) {
-                estadoActual = ABIERTA;
+// La interrupcin solo cuenta el flanco, anota el instante y despierta a la
+// tarea; los flancos que lleguen antes de la lectura se atienden juntos en
+// ella.
+void entradaIsr(void *arg) {
+    flancos[(intptr_t)arg]++;
+    if (primerFlancoUs == 0) {
+        primerFlancoUs = esp_timer_get_time();
+    }
+    BaseType_t despertar = pdFALSE;
+    vTaskNotifyGiveFromISR(tareaPuertas, &despertar);
+    portYIELD_FROM_ISR(despertar);
+}
+
+// Los dos registros de entrada se leen una vez por pasada
+uint64_t leerPines() {
+    return ((uint64_t)REG_READ(GPIO_IN1_REG) << 32) | REG_READ(GPIO_IN_REG);
+}
+
+// Reparte los bits ya filtrados a las mscaras de las puertas
+void repartirEntradas(uint64_t entrada, MascaraPortones niveles[PORTONES_NUM_ENTRADAS]) {
+    for (int e = 0; e < PORTONES_NUM_ENTRADAS; e++) {
+        niveles[e] = 0;
+    }
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        const gpio_num_t pin[] = {pines[i].abrir, pines[i].cerrar, pines[i].paro, pines[i].obstaculo};
+        for (int e = 0; e < PORTONES_NUM_ENTRADAS; e++) {
+            niveles[e] |= (MascaraPortones)(~entrada >> pin[e] & 1) << i;
+        }
+    }
+}
+
+// Solo se tocan los pines de las puertas cuyo bit cambi. Con puente el
+// sentido es el de la rampa, que solo cambia con el motor parado. El
+// indicador de falla parpadea a 1 Hz mientras la puerta tiene la falla
+// sealizada.
+void escribirSalidas(int64_t ahoraUs) {
+    bool encendido = (ahoraUs / MEDIO_PARPADEO_US) % 2 == 0;
+    MascaraPortones falla = encendido ? portones.falla : 0;
+    MascaraPortones abrir = (portones.abriendo & ~conPuente) | (rampas.abriendo & conPuente);
+    MascaraPortones cerrar = (portones.cerrando & ~conPuente) | (rampas.cerrando & conPuente);
+    MascaraPortones cambios = (abrir ^ escritasAbrir) | (cerrar ^ escritasCerrar) | (falla ^ escritasFalla);
+    while (cambios != 0) {
+        int i = __builtin_ctzll(cambios);
+        cambios &= cambios - 1;
+        gpio_set_level(pines[i].motorAbrir, (abrir >> i) & 1);
+        if (pines[i].motorCerrar != GPIO_NUM_NC) {
+            gpio_set_level(pines[i].motorCerrar, (cerrar >> i) & 1);
+        }
+        gpio_set_level(pines[i].falla, (falla >> i) & 1);
+    }
+    escritasAbrir = abrir;
+    escritasCerrar = cerrar;
+    escritasFalla = falla;
+    aplicarRampas(ahoraUs);
+}
+
+void atenderPuertas() {
+    MascaraPortones niveles[PORTONES_NUM_ENTRADAS];
+    int64_t flancoUs = primerFlancoUs;
+    uint64_t crudo = leerPines();
+    int64_t ahoraUs = esp_timer_get_time();
+    uint64_t aceptados = antirreboteMuestra(&antirrebote, crudo, ahoraUs);
+    // El cierre de la primera ventana abierta vuelve a despertar la tarea
+    esp_timer_stop(temporizadorAntirrebote);
+    int64_t cierreUs = antirreboteProximo(&antirrebote);
+    if (cierreUs != 0) {
+        esp_timer_start_once(temporizadorAntirrebote, cierreUs > ahoraUs ? cierreUs - ahoraUs : 0);
+    }
+    if (aceptados != 0 || antirrebote.abiertas == 0) {
+        primerFlancoUs = 0;
+    }
+    repartirEntradas(antirrebote.estable, niveles);
+    portonesEntradas(&portones, niveles, ahoraUs);
+    medirPosicion(ahoraUs);
+    rampasRevisar(&rampas, &portones, posiciones.llegadaUs, ahoraUs);
+    escribirSalidas(ahoraUs);
+    programarPasada(ahoraUs);
+
+    if (aceptados != 0) {
+        mostrarRebotes(aceptados);
+    }
+    if (aceptados != 0 && flancoUs != 0) {
+        // Ningn estado bloquea la tarea, as que la peor latencia es la
+        // ventana de antirrebote ms el despertar y lo que tarde la pasada
+        // anterior.
+        int64_t latenciaUs = esp_timer_get_time() - flancoUs;
+        if (latenciaUs > latenciaMaximaUs) latenciaMaximaUs = latenciaUs;
+        printf("Reaccin en %lld us, mxima %lld us\n", (long long)latenciaUs, (long long)latenciaMaximaUs);
+    }
+}
+
+void mostrarRebotes(uint64_t aceptados) {
+    while (aceptados != 0) {
+        int pin = __builtin_ctzll(aceptados);
+        aceptados &= aceptados - 1;
+        printf("GPIO %d: %lu flancos, %lu cambios, %lu rebotes, %lu pulsos descartados\n", pin,
+               (unsigned long)flancos[pin], (unsigned long)antirrebote.cambios[pin],
+               (unsigned long)antirrebote.rebotes[pin], (unsigned long)antirrebote.descartes[pin]);
+    }
+}
+
+void mostrarTransicion(void *usuario, const Portones *p, int puerta, EventoPuerta evento, EstadoPuerta anterior,
+                       AccionPuerta accion) {
+    if (p->estado[puerta] != anterior) {
+        printf("Puerta %d %s: %s -> %s\n", puerta, puertaNombreEvento(evento), puertaNombreEstado(anterior),
+               puertaNombreEstado((EstadoPuerta)p->estado[puerta]));
+    }
+    if ((evento == EVENTO_LLEGADA || evento == EVENTO_FALLA) && (p->conPosicion >> puerta & 1)) {
+        printf("Puerta %d: %lu llegadas, %lu atascos, deriva %ld cuentas\n", puerta,
+               (unsigned long)posiciones.llegadas[puerta], (unsigned long)posiciones.atascos[puerta],
+               (long)posiciones.deriva[puerta]);
+    }
+}
+
+// Un contador PCNT en cuadratura x4 por encoder; el tope por corriente usa
+// lecturas sueltas del ADC1
+void configurarPosicion() {
+    ConfigPosicion config[PORTONES_MAX] = {0};
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        const PinesPuerta *pin = &pines[i];
+        if (pin->encoderA != GPIO_NUM_NC) {
+            pcnt_unit_config_t unidad = {.low_limit = -ENCODER_LIMITE, .high_limit = ENCODER_LIMITE};
+            unidad.flags.accum_count = 1;
+            ESP_ERROR_CHECK(pcnt_new_unit(&unidad, &encoders[i]));
+            pcnt_glitch_filter_config_t filtro = {.max_glitch_ns = 1000};
+            ESP_ERROR_CHECK(pcnt_unit_set_glitch_filter(encoders[i], &filtro));
+            pcnt_chan_config_t a = {.edge_gpio_num = pin->encoderA, .level_gpio_num = pin->encoderB};
+            pcnt_chan_config_t b = {.edge_gpio_num = pin->encoderB, .level_gpio_num = pin->encoderA};
+            pcnt_channel_handle_t canalA, canalB;
+            ESP_ERROR_CHECK(pcnt_new_channel(encoders[i], &a, &canalA));
+            ESP_ERROR_CHECK(pcnt_new_channel(encoders[i], &b, &canalB));
+            pcnt_channel_set_edge_action(canalA, PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+            pcnt_channel_set_level_action(canalA, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+            pcnt_channel_set_edge_action(canalB, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+            pcnt_channel_set_level_action(canalB, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+            ESP_ERROR_CHECK(pcnt_unit_add_watch_point(encoders[i], -ENCODER_LIMITE));
+            ESP_ERROR_CHECK(pcnt_unit_add_watch_point(encoders[i], ENCODER_LIMITE));
+            ESP_ERROR_CHECK(pcnt_unit_enable(encoders[i]));
+            ESP_ERROR_CHECK(pcnt_unit_clear_count(encoders[i]));
+            ESP_ERROR_CHECK(pcnt_unit_start(encoders[i]));
+            config[i].recorrido = pin->recorrido;
+        }
+        if (pin->canalCorriente != SIN_CORRIENTE) {
+            if (adcCorriente == NULL) {
+                adc_oneshot_unit_init_cfg_t unidad = {.unit_id = ADC_UNIT_1};
+                ESP_ERROR_CHECK(adc_oneshot_new_unit(&unidad, &adcCorriente));
             }
-            break;
-        case ABIERTA:
-            vTaskDelay(pdMS_TO_TICKS(tiempoEspera));
-            estadoActual = CERRANDO;
-            break;
-        case CERRANDO:
-            gpio_set_level(LED_ESTADO, 0);
-            if (obstaculoDetectado) {
-                printf("Obstculo! Reabriendo\n");
-                estadoActual = ABRIENDO;
-                tiempoInicio = esp_timer_get_time();
-            } else if ((esp_timer_get_time() - tiempoInicio) / 1000 >= tiempoMovimiento) {
-                estadoActual = CERRADA;
+            adc_oneshot_chan_cfg_t canal = {.atten = ADC_ATTEN_DB_12, .bitwidth = ADC_BITWIDTH_DEFAULT};
+            ESP_ERROR_CHECK(adc_oneshot_config_channel(adcCorriente, (adc_channel_t)pin->canalCorriente, &canal));
+            config[i].tope = true;
+        }
+    }
+    posicionIniciar(&posiciones, NUM_PUERTAS, config);
+    posicionAplicar(&posiciones, &portones);
+}
+
+// Solo se leen las puertas que se mueven, y mientras alguna se mueve la
+// tarea despierta a cada ranura para leerla. La revisin va en cada pasada
+// aunque no se mueva ninguna, para que vea los arranques.
+void medirPosicion(int64_t ahoraUs) {
+    MascaraPortones sobrecorriente = 0;
+    MascaraPortones moviendo = (portones.abriendo | portones.cerrando) & portones.conPosicion;
+    while (moviendo != 0) {
+        int i = __builtin_ctzll(moviendo);
+        moviendo &= moviendo - 1;
+        if (encoders[i] != NULL) {
+            int cuenta;
+            if (pcnt_unit_get_count(encoders[i], &cuenta) == ESP_OK) {
+                cuentas[i] = cuenta;
             }
-            break;
-        case CERRADA:
-            estadoActual = ESPERA;
-            break;
-        case DETENIDA:
-            if (!obstaculoDetectado) estadoActual = ESPERA;
-            break;
-        case ERROR:
-            manejarError();
-            break;
+        }
+        int crudo;
+        if (pines[i].canalCorriente != SIN_CORRIENTE &&
+            adc_oneshot_read(adcCorriente, (adc_channel_t)pines[i].canalCorriente, &crudo) == ESP_OK &&
+            crudo > pines[i].umbralCorriente) {
+            sobrecorriente |= (MascaraPortones)1 << i;
+        }
     }
+    posicionRevisar(&posiciones, &portones, cuentas, sobrecorriente, ahoraUs);
 }
 
-void manejarError() {
-    printf("Error en el sistema!\n");
-    parpadearIndicadorError();
-    estadoActual = ESPERA;
+void configurarHardware() {
+    gpio_config_t entradas = {0};
+    entradas.intr_type = GPIO_INTR_ANYEDGE;
+    entradas.mode = GPIO_MODE_INPUT;
+    entradas.pull_up_en = 1;
+    gpio_config_t salidas = {0};
+    salidas.intr_type = GPIO_INTR_DISABLE;
+    salidas.mode = GPIO_MODE_OUTPUT;
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        entradas.pin_bit_mask |= (1ULL << pines[i].abrir) | (1ULL << pines[i].cerrar) | (1ULL << pines[i].paro) |
+                                 (1ULL << pines[i].obstaculo);
+        salidas.pin_bit_mask |= (1ULL << pines[i].motorAbrir) | (1ULL << pines[i].falla);
+        if (pines[i].motorPwm != GPIO_NUM_NC) {
+            salidas.pin_bit_mask |= 1ULL << pines[i].motorPwm;
+        }
+        if (pines[i].motorCerrar != GPIO_NUM_NC) {
+            salidas.pin_bit_mask |= 1ULL << pines[i].motorCerrar;
+        }
+    }
+    gpio_config(&entradas);
+    gpio_config(&salidas);
 }
 
-void parpadearIndicadorError() {
-    for (int i = 0; i < 5; i++) {
-        gpio_set_level(LED_FALLA, 1);
-        vTaskDelay(pdMS_TO_TICKS(500));
-        gpio_set_level(LED_FALLA, 0);
-        vTaskDelay(pdMS_TO_TICKS(500));
+void configurarMotores() {
+    rampasIniciar(&rampas, NUM_PUERTAS, &perfilMotor, MOTOR_DUTY_MAX);
+    int canales = 0;
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        canalMotor[i] = -1;
+        if (pines[i].motorPwm == GPIO_NUM_NC) {
+            continue;
+        }
+        // Sin canal el pin PWM se queda en bajo y esa puerta nunca movera
+        // su motor: mejor no arrancar que fallar en silencio
+        if (canales == LEDC_CHANNEL_MAX) {
+            printf("Puerta %d: motorPwm en GPIO %d sin canal LEDC libre (hay %d)\n", i, pines[i].motorPwm,
+                   LEDC_CHANNEL_MAX);
+            abort();
+        }
+        if (canales == 0) {
+            ledc_timer_config_t temporizador = {
+                .speed_mode = MOTOR_LEDC_MODO,
+                .duty_resolution = LEDC_TIMER_10_BIT,
+                .timer_num = MOTOR_LEDC_TIMER,
+                .freq_hz = MOTOR_PWM_HZ,
+                .clk_cfg = LEDC_AUTO_CLK,
+            };
+            ESP_ERROR_CHECK(ledc_timer_config(&temporizador));
+#if SOC_LEDC_SUPPORT_FADE_STOP
+            ESP_ERROR_CHECK(ledc_fade_func_install(0));
+#endif
+        }
+        ledc_channel_config_t canal = {
+            .gpio_num = pines[i].motorPwm,
+            .speed_mode = MOTOR_LEDC_MODO,
+            .channel = (ledc_channel_t)canales,
+            .timer_sel = MOTOR_LEDC_TIMER,
+            .duty = 0,
+        };
+        ESP_ERROR_CHECK(ledc_channel_config(&canal));
+        canalMotor[i] = (int8_t)canales++;
+        conPuente |= (MascaraPortones)1 << i;
     }
 }
+
+#if SOC_LEDC_SUPPORT_FADE_STOP
+// Cada segmento nuevo es un fundido del LEDC; el que estuviera en curso se
+// corta donde iba y el nuevo parte de ah
+void aplicarRampas(int64_t ahoraUs) {
+    MascaraPortones nuevas = rampas.nuevas & conPuente;
+    while (nuevas != 0) {
+        int i = __builtin_ctzll(nuevas);
+        nuevas &= nuevas - 1;
+        ledc_channel_t canal = (ledc_channel_t)canalMotor[i];
+        int16_t hasta = rampas.hasta[i];
+        uint32_t duty = hasta < 0 ? -hasta : hasta;
+        ledc_fade_stop(MOTOR_LEDC_MODO, canal);
+        if (rampas.duracionUs[i] < 1000) {
+            ledc_set_duty(MOTOR_LEDC_MODO, canal, duty);
+            ledc_update_duty(MOTOR_LEDC_MODO, canal);
+        } else {
+            ledc_set_fade_with_time(MOTOR_LEDC_MODO, canal, duty, rampas.duracionUs[i] / 1000);
+            ledc_fade_start(MOTOR_LEDC_MODO, canal, LEDC_FADE_NO_WAIT);
+        }
+    }
+}
+#else
+// Sin ledc_fade_stop un fundido en curso no se puede cortar sin esperar a
+// que acabe, y eso retrasara el paro. La tarea escribe entonces el duty de
+// la rampa en cada pasada, que mientras hay segmentos en curso es a cada
+// ranura; las que acaban de terminar reciben an su ltimo valor.
+MascaraPortones pwmEncendido = 0;
+
+void aplicarRampas(int64_t ahoraUs) {
+    MascaraPortones activas = (rampas.activas | rampas.nuevas | pwmEncendido) & conPuente;
+    while (activas != 0) {
+        int i = __builtin_ctzll(activas);
+        activas &= activas - 1;
+        ledc_channel_t canal = (ledc_channel_t)canalMotor[i];
+        int16_t duty = rampasDuty(&rampas, i, ahoraUs);
+        ledc_set_duty(MOTOR_LEDC_MODO, canal, duty < 0 ? -duty : duty);
+        ledc_update_duty(MOTOR_LEDC_MODO, canal);
+        MascaraPortones bit = (MascaraPortones)1 << i;
+        pwmEncendido = duty != 0 ? pwmEncendido | bit : pwmEncendido & ~bit;
+    }
+}
+#endif
+
+// Una ventana de estabilidad por pin y un solo esp_timer armado al cierre
+// ms prximo, as que sin flancos no hay nada corriendo. Donde el GPIO
+// tiene filtro de glitches, los pulsos de pocos ciclos de reloj ni siquiera
+// llegan a interrumpir.
+void configurarAntirrebote() {
+    uint64_t pinesEntrada = 0;
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        pinesEntrada |= (1ULL << pines[i].abrir) | (1ULL << pines[i].cerrar) | (1ULL << pines[i].paro) |
+                        (1ULL << pines[i].obstaculo);
+    }
+    antirreboteIniciar(&antirrebote, pinesEntrada, leerPines(), ANTIRREBOTE_BOTONES_MS * 1000);
+    for (int i = 0; i < NUM_PUERTAS; i++) {
+        uint32_t botonesMs = pines[i].antirreboteBotonesMs ? pines[i].antirreboteBotonesMs : ANTIRREBOTE_BOTONES_MS;
+        uint32_t sensorMs = pines[i].antirreboteSensorMs ? pines[i].antirreboteSensorMs : ANTIRREBOTE_SENSOR_MS;
+        antirreboteVentana(&antirrebote, pines[i].abrir, botonesMs * 1000);
+        antirreboteVentana(&antirrebote, pines[i].cerrar, botonesMs * 1000);
+        antirreboteVentana(&antirrebote, pines[i].paro, botonesMs * 1000);
+        antirreboteVentana(&antirrebote, pines[i].obstaculo, sensorMs * 1000);
+    }
+    esp_timer_create_args_t ventana = {.callback = ventanaCerrada, .name = "antirrebote"};
+    esp_timer_create(&ventana, &temporizadorAntirrebote);
+
+#if SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+    for (uint64_t resto = pinesEntrada; resto != 0; resto &= resto - 1) {
+        gpio_pin_glitch_filter_config_t config = {
+            .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+            .gpio_num = __builtin_ctzll(resto),
+        };
+        gpio_glitch_filter_handle_t filtro;
+        if (gpio_new_pin_glitch_filter(&config, &filtro) == ESP_OK) {
+            gpio_glitch_filter_enable(filtro);
+        }
+    }
+#endif
+}
+
+void ventanaCerrada(void *arg) {
+    xTaskNotifyGive(tareaPuertas);
+}
+
+// Un solo esp_timer para lo ms prximo que tenga fecha: el primer
+// vencimiento de la rueda, lo prximo de las rampas o el cambio del
+// indicador de falla. Solo hace falta despertar a cada ranura para muestrear
+// encoders y corriente de las puertas que se mueven y, sin fundido del LEDC,
+// para escribir el duty de las rampas en curso.
+void programarPasada(int64_t ahoraUs) {
+    const int64_t fechas[] = {
+        portonesProximo(&portones),
+        rampasProximo(&rampas, &portones, ahoraUs),
+        portones.falla != 0 ? (ahoraUs / MEDIO_PARPADEO_US + 1) * MEDIO_PARPADEO_US : 0,
+    };
+    int64_t proximoUs = 0;
+    for (int k = 0; k < 3; k++) {
+        if (fechas[k] != 0 && (proximoUs == 0 || fechas[k] < proximoUs)) {
+            proximoUs = fechas[k];
+        }
+    }
+    bool muestrear = ((portones.abriendo | portones.cerrando) & portones.conPosicion) != 0;
+#if !SOC_LEDC_SUPPORT_FADE_STOP
+    for (MascaraPortones activas = rampas.activas & conPuente; activas != 0 && !muestrear; activas &= activas - 1) {
+        int i = __builtin_ctzll(activas);
+        muestrear = ahoraUs - rampas.inicioUs[i] < rampas.duracionUs[i];
+    }
+#endif
+    if (muestrear && (proximoUs == 0 || proximoUs > ahoraUs + RUEDA_RESOLUCION_US)) {
+        proximoUs = ahoraUs + RUEDA_RESOLUCION_US;
+    }
+    esp_timer_stop(temporizadorPasada);
+    if (proximoUs != 0) {
+        esp_timer_start_once(temporizadorPasada, proximoUs > ahoraUs ? proximoUs - ahoraUs : 0);
+    }
+}
+
+void pasadaVencida(void *arg) {
+    xTaskNotifyGive(tareaPuertas);
+}
@@ -0,0 +1,194 @@
+#include "portones.h"
+#include <stddef.h>
+
+#define BIT_PUERTA(i) ((MascaraPortones)1 << (i))
+
+static int ranuraDe(int64_t instanteUs) {
+    return (int)((instanteUs / RUEDA_RESOLUCION_US) % RUEDA_RANURAS);
+}
+
+static void sacarDeRueda(Portones *p, int i) {
+    if (p->vencimientoUs[i] == 0) {
+        return;
+    }
+    uint8_t sig = p->siguiente[i];
+    uint8_t prev = p->previo[i];
+    if (prev != PORTONES_NINGUNO) {
+        p->siguiente[prev] = sig;
+    } else {
+        p->ranuras[ranuraDe(p->vencimientoUs[i])] = sig;
+    }
+    if (sig != PORTONES_NINGUNO) {
+        p->previo[sig] = prev;
+    }
+    p->vencimientoUs[i] = 0;
+    p->pendientes--;
+}
+
+static void programar(Portones *p, int i, int64_t instanteUs) {
+    if (instanteUs == p->vencimientoUs[i]) {
+        return;
+    }
+    sacarDeRueda(p, i);
+    if (instanteUs == 0) {
+        return;
+    }
+    // Lo ya vencido va a la ranura en curso
+    if (instanteUs < p->ruedaUs) {
+        instanteUs = p->ruedaUs;
+    }
+    int r = ranuraDe(instanteUs);
+    p->vencimientoUs[i] = instanteUs;
+    p->previo[i] = PORTONES_NINGUNO;
+    p->siguiente[i] = p->ranuras[r];
+    if (p->ranuras[r] != PORTONES_NINGUNO) {
+        p->previo[p->ranuras[r]] = (uint8_t)i;
+    }
+    p->ranuras[r] = (uint8_t)i;
+    p->pendientes++;
+}
+
+// La máquina trabaja sobre una copia de la puerta; se devuelve el estado y
+// las salidas quedan en las máscaras.
+static void despachar(Portones *p, int i, EventoPuerta evento, int64_t ahoraUs) {
+    MascaraPortones bit = BIT_PUERTA(i);
+    PuertaFsm fsm = {
+        .estado = (EstadoPuerta)p->estado[i],
+        .obstaculo = (p->obstaculo & bit) != 0,
+        .plazoUs = p->plazoUs[i],
+        .tiempoMovimientoMs = p->tiempoMovimientoMs,
+        .tiempoEsperaMs = p->tiempoEsperaMs,
+    };
+    EstadoPuerta anterior = fsm.estado;
+    AccionPuerta accion = puertaDespachar(&fsm, evento, ahoraUs);
+    p->estado[i] = (uint8_t)fsm.estado;
+    p->plazoUs[i] = fsm.plazoUs;
+    p->obstaculo = fsm.obstaculo ? p->obstaculo | bit : p->obstaculo & ~bit;
+    p->eventos++;
+
+    SentidoMotor sentido = puertaMotor(accion);
+    if (sentido != MOTOR_SIN_CAMBIO) {
+        p->abriendo = sentido == MOTOR_ABRIENDO ? p->abriendo | bit : p->abriendo & ~bit;
+        p->cerrando = sentido == MOTOR_CERRANDO ? p->cerrando | bit : p->cerrando & ~bit;
+    }
+    // En ERROR la rueda lleva el fin del parpadeo en lugar del plazo
+    if (fsm.estado == ERROR) {
+        if (accion == ACCION_SENALIZAR_FALLA) {
+            p->falla |= bit;
+            programar(p, i, ahoraUs + PORTONES_PARPADEO_US);
+        }
+    } else {
+        p->falla &= ~bit;
+        programar(p, i, fsm.plazoUs);
+    }
+    if (p->observador != NULL) {
+        p->observador(p->usuario, p, i, evento, anterior, accion);
+    }
+}
+
+static EventoPuerta eventoDeRueda(const Portones *p, int i) {
+    if (p->estado[i] == ERROR) {
+        return EVENTO_FIN_PARPADEO;
+    }
+    bool moviendo = p->estado[i] == ABRIENDO || p->estado[i] == CERRANDO;
+    return moviendo && (p->conPosicion & BIT_PUERTA(i)) ? EVENTO_FALLA : EVENTO_PLAZO;
+}
+
+void portonesIniciar(Portones *p, int num, uint32_t tiempoMovimientoMs, uint32_t tiempoEsperaMs,
+                     MascaraPortones obstaculo, int64_t ahoraUs) {
+    *p = (Portones){
+        .num = num,
+        .tiempoMovimientoMs = tiempoMovimientoMs,
+        .tiempoEsperaMs = tiempoEsperaMs,
+        .obstaculo = obstaculo,
+        .ruedaUs = ahoraUs,
+    };
+    p->niveles[ENTRADA_OBSTACULO] = obstaculo;
+    for (int i = 0; i < PORTONES_MAX; i++) {
+        p->estado[i] = ESPERA;
+    }
+    for (int r = 0; r < RUEDA_RANURAS; r++) {
+        p->ranuras[r] = PORTONES_NINGUNO;
+    }
+}
+
+void portonesAvanzar(Portones *p, int64_t ahoraUs) {
+    while (p->ruedaUs <= ahoraUs) {
+        if (p->pendientes == 0) {
+            p->ruedaUs = ahoraUs + 1;
+            return;
+        }
+        // Con varias ranuras por recorrer, las vacías hasta el primer
+        // vencimiento se saltan de una vez
+        if (ahoraUs - p->ruedaUs >= 2 * RUEDA_RESOLUCION_US) {
+            int64_t proximoUs = portonesProximo(p);
+            if (proximoUs > ahoraUs) {
+                p->ruedaUs = ahoraUs + 1;
+                return;
+            }
+            if (proximoUs > p->ruedaUs) {
+                p->ruedaUs = proximoUs - proximoUs % RUEDA_RESOLUCION_US;
+            }
+        }
+        // Cada disparo puede reprogramar en esta misma ranura, así que se
+        // vuelve a la cabeza tras cada uno
+        int64_t finRanuraUs = (p->ruedaUs / RUEDA_RESOLUCION_US + 1) * RUEDA_RESOLUCION_US;
+        int r = ranuraDe(p->ruedaUs);
+        uint8_t i = p->ranuras[r];
+        while (i != PORTONES_NINGUNO) {
+            int64_t vencimientoUs = p->vencimientoUs[i];
+            if (vencimientoUs >= finRanuraUs || vencimientoUs > ahoraUs) {
+                i = p->siguiente[i];
+                continue;
+            }
+            sacarDeRueda(p, i);
+            despachar(p, i, eventoDeRueda(p, i), vencimientoUs);
+            i = p->ranuras[r];
+        }
+        if (finRanuraUs > ahoraUs) {
+            return;
+        }
+        p->ruedaUs = finRanuraUs;
+    }
+}
+
+void portonesEntradas(Portones *p, const MascaraPortones niveles[PORTONES_NUM_ENTRADAS], int64_t ahoraUs) {
+    static const EventoPuerta pulsaciones[] = {EVENTO_ABRIR, EVENTO_CERRAR, EVENTO_PARO};
+    portonesAvanzar(p, ahoraUs);
+    // El sensor primero, para que un botón en la misma lectura ya lo vea
+    MascaraPortones cambios = niveles[ENTRADA_OBSTACULO] ^ p->niveles[ENTRADA_OBSTACULO];
+    p->niveles[ENTRADA_OBSTACULO] = niveles[ENTRADA_OBSTACULO];
+    while (cambios != 0) {
+        int i = __builtin_ctzll(cambios);
+        cambios &= cambios - 1;
+        despachar(p, i, (niveles[ENTRADA_OBSTACULO] >> i) & 1 ? EVENTO_OBSTACULO : EVENTO_LIBRE, ahoraUs);
+    }
+    for (int e = ENTRADA_ABRIR; e <= ENTRADA_PARO; e++) {
+        MascaraPortones pulsadas = niveles[e] & ~p->niveles[e];
+        p->niveles[e] = niveles[e];
+        while (pulsadas != 0) {
+            int i = __builtin_ctzll(pulsadas);
+            pulsadas &= pulsadas - 1;
+            despachar(p, i, pulsaciones[e], ahoraUs);
+        }
+    }
+}
+
+void portonesEvento(Portones *p, int puerta, EventoPuerta evento, int64_t ahoraUs) {
+    portonesAvanzar(p, ahoraUs);
+    despachar(p, puerta, evento, ahoraUs);
+}
+
+int64_t portonesProximo(const Portones *p) {
+    int64_t proximoUs = 0;
+    if (p->pendientes == 0) {
+        return 0;
+    }
+    for (int i = 0; i < p->num; i++) {
+        int64_t vencimientoUs = p->vencimientoUs[i];
+        if (vencimientoUs != 0 && (proximoUs == 0 || vencimientoUs < proximoUs)) {
+            proximoUs = vencimientoUs;
+        }
+    }
+    return proximoUs;
+}
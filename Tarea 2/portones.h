@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "puerta_fsm.h"
+
+// Varias puertas servidas por un único bucle con la misma tabla de
+// puerta_fsm. El estado va en estructura de arreglos indexada por puerta;
+// las entradas llegan como máscaras (bit i = puerta i) leídas de una vez, y
+// los plazos de todas comparten una rueda de temporizadores. Solo se despacha
+// en las puertas cuyo bit cambió o cuyo plazo venció. No depende de ESP-IDF.
+
+#define PORTONES_MAX 64
+#define PORTONES_NINGUNO 0xFF
+// Ranuras de 10 ms: una vuelta completa son 2,56 s
+#define RUEDA_RANURAS 256
+#define RUEDA_RESOLUCION_US 10000
+// Lo que dura el parpadeo de falla antes de EVENTO_FIN_PARPADEO
+#define PORTONES_PARPADEO_US 5000000
+
+typedef uint64_t MascaraPortones;
+
+// Nivel activo = bit a 1. De los botones cuenta la pulsación; del sensor,
+// los dos flancos.
+typedef enum {
+    ENTRADA_ABRIR,
+    ENTRADA_CERRAR,
+    ENTRADA_PARO,
+    ENTRADA_OBSTACULO,
+    PORTONES_NUM_ENTRADAS
+} EntradaPorton;
+
+typedef struct Portones Portones;
+
+// Se llama tras cada evento despachado, haya o no cambio de estado
+typedef void (*PortonesObservador)(void *usuario, const Portones *p, int puerta, EventoPuerta evento,
+                                   EstadoPuerta anterior, AccionPuerta accion);
+
+struct Portones {
+    int num;
+    uint32_t tiempoMovimientoMs;
+    uint32_t tiempoEsperaMs;
+    // Por puerta
+    uint8_t estado[PORTONES_MAX];
+    int64_t plazoUs[PORTONES_MAX];          // plazo de la máquina, 0 sin plazo
+    int64_t vencimientoUs[PORTONES_MAX];    // lo que hay en la rueda, 0 fuera de ella
+    uint8_t siguiente[PORTONES_MAX];        // lista doble de la ranura
+    uint8_t previo[PORTONES_MAX];
+    // Un bit por puerta
+    MascaraPortones obstaculo;
+    MascaraPortones niveles[PORTONES_NUM_ENTRADAS];   // última lectura
+    MascaraPortones abriendo;
+    MascaraPortones cerrando;
+    MascaraPortones falla;
+    // Puertas con medida de posición: su plazo de movimiento es un límite y
+    // vencerlo sin haber llegado es falla
+    MascaraPortones conPosicion;
+    // Rueda: ya se entregó todo lo que vence antes de ruedaUs
+    uint8_t ranuras[RUEDA_RANURAS];
+    int64_t ruedaUs;
+    int pendientes;
+    uint64_t eventos;
+    PortonesObservador observador;
+    void *usuario;
+};
+
+void portonesIniciar(Portones *p, int num, uint32_t tiempoMovimientoMs, uint32_t tiempoEsperaMs,
+                     MascaraPortones obstaculo, int64_t ahoraUs);
+// Entrega los plazos que venzan hasta ahoraUs y luego los cambios respecto
+// a la lectura anterior
+void portonesEntradas(Portones *p, const MascaraPortones niveles[PORTONES_NUM_ENTRADAS], int64_t ahoraUs);
+// Entrega por orden de ranura los plazos y fines de parpadeo vencidos
+void portonesAvanzar(Portones *p, int64_t ahoraUs);
+// Evento suelto para una puerta (falla, rearme)
+void portonesEvento(Portones *p, int puerta, EventoPuerta evento, int64_t ahoraUs);
+// Vencimiento más próximo de la rueda, 0 si no hay ninguno
+int64_t portonesProximo(const Portones *p);
@@ -0,0 +1,106 @@
+// Costo del bucle de varias puertas según cuántas sirve, en el PC:
+//   gcc -O2 -std=c99 portones_bench.c portones.c puerta_fsm.c -o portones_bench && ./portones_bench
+// Cada lectura cada 10 ms entrega las cuatro máscaras de entrada; se compara
+// con recorrer puerta por puerta una máquina independiente por cada una.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "portones.h"
+
+#define LECTURAS 60000          // 10 minutos de reloj virtual
+#define REPETICIONES 20
+#define PERIODO_US 10000
+
+static MascaraPortones lecturas[LECTURAS][PORTONES_NUM_ENTRADAS];
+
+static double segundos() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Cada puerta recibe de media una pulsación cada 20 s y un cambio del
+// sensor cada 50 s; las pulsaciones duran una lectura.
+static void generarLecturas(int num, uint32_t semilla) {
+    MascaraPortones obstaculo = 0;
+    for (int k = 0; k < LECTURAS; k++) {
+        MascaraPortones *l = lecturas[k];
+        l[ENTRADA_ABRIR] = l[ENTRADA_CERRAR] = l[ENTRADA_PARO] = 0;
+        for (int i = 0; i < num; i++) {
+            semilla = semilla * 1664525u + 1013904223u;
+            uint32_t r = (semilla >> 8) % 10000;
+            if (r < 5) {
+                l[r % 3] |= (MascaraPortones)1 << i;
+            } else if (r < 7) {
+                obstaculo ^= (MascaraPortones)1 << i;
+            }
+        }
+        l[ENTRADA_OBSTACULO] = obstaculo;
+    }
+}
+
+static double medirPortones(int num, uint64_t *eventos) {
+    Portones p;
+    portonesIniciar(&p, num, 30000, 2000, 0, 0);
+    int64_t ahoraUs = 0;
+    double inicio = segundos();
+    for (int rep = 0; rep < REPETICIONES; rep++) {
+        for (int k = 0; k < LECTURAS; k++) {
+            ahoraUs += PERIODO_US;
+            portonesEntradas(&p, lecturas[k], ahoraUs);
+        }
+    }
+    *eventos = p.eventos;
+    return segundos() - inicio;
+}
+
+// Lo mismo con una PuertaFsm por puerta y su propia lectura y plazo
+static double medirIndividual(int num) {
+    PuertaFsm fsm[PORTONES_MAX];
+    MascaraPortones previas[PORTONES_NUM_ENTRADAS] = {0};
+    static const EventoPuerta pulsaciones[] = {EVENTO_ABRIR, EVENTO_CERRAR, EVENTO_PARO};
+    for (int i = 0; i < num; i++) {
+        puertaIniciar(&fsm[i], 30000, 2000);
+    }
+    int64_t ahoraUs = 0;
+    double inicio = segundos();
+    for (int rep = 0; rep < REPETICIONES; rep++) {
+        for (int k = 0; k < LECTURAS; k++) {
+            ahoraUs += PERIODO_US;
+            const MascaraPortones *l = lecturas[k];
+            for (int i = 0; i < num; i++) {
+                if (fsm[i].plazoUs != 0 && ahoraUs >= fsm[i].plazoUs) {
+                    puertaDespachar(&fsm[i], EVENTO_PLAZO, ahoraUs);
+                }
+                bool obstaculo = (l[ENTRADA_OBSTACULO] >> i) & 1;
+                if (obstaculo != ((previas[ENTRADA_OBSTACULO] >> i) & 1)) {
+                    puertaDespachar(&fsm[i], obstaculo ? EVENTO_OBSTACULO : EVENTO_LIBRE, ahoraUs);
+                }
+                for (int e = ENTRADA_ABRIR; e <= ENTRADA_PARO; e++) {
+                    if (((l[e] & ~previas[e]) >> i) & 1) {
+                        puertaDespachar(&fsm[i], pulsaciones[e], ahoraUs);
+                    }
+                }
+            }
+            for (int e = 0; e < PORTONES_NUM_ENTRADAS; e++) {
+                previas[e] = l[e];
+            }
+        }
+    }
+    return segundos() - inicio;
+}
+
+int main() {
+    const double total = (double)LECTURAS * REPETICIONES;
+    printf("puertas  ns/lectura  ns/puerta  eventos    individual ns/lectura\n");
+    for (int num = 1; num <= PORTONES_MAX; num *= 2) {
+        generarLecturas(num, 12345);
+        uint64_t eventos;
+        double t = medirPortones(num, &eventos);
+        double ti = medirIndividual(num);
+        printf("%7d  %10.1f  %9.1f  %9llu  %10.1f\n", num, t / total * 1e9, t / total / num * 1e9,
+               (unsigned long long)eventos, ti / total * 1e9);
+    }
+    return 0;
+}
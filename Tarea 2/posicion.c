@@ -0,0 +1,134 @@
+#include "posicion.h"
+
+#define BIT_PUERTA(i) ((MascaraPortones)1 << (i))
+
+void posicionIniciar(Posiciones *q, int num, const ConfigPosicion config[]) {
+    *q = (Posiciones){
+        .num = num,
+        .tolerancia = 20,
+        .margenTope = 200,
+        .atascoUs = 500000,
+        .arranqueUs = 300000,
+        .corrienteUs = 50000,
+        .ventanaUs = 100000,
+    };
+    for (int i = 0; i < num; i++) {
+        q->recorrido[i] = config[i].recorrido;
+        if (config[i].tope) {
+            q->tope |= BIT_PUERTA(i);
+        }
+    }
+}
+
+void posicionAplicar(const Posiciones *q, Portones *p) {
+    p->conPosicion = q->tope;
+    for (int i = 0; i < q->num; i++) {
+        if (q->recorrido[i] > 0) {
+            p->conPosicion |= BIT_PUERTA(i);
+        }
+    }
+}
+
+// Al llegar al tope la cuenta se reajusta al extremo correspondiente
+static EventoPuerta llegarAlTope(Posiciones *q, int i, bool abre, int32_t cuenta) {
+    if (q->recorrido[i] == 0) {
+        return EVENTO_LLEGADA;
+    }
+    int32_t extremo = abre ? q->recorrido[i] : 0;
+    int32_t error = cuenta - q->origen[i] - extremo;
+    if (error > q->margenTope || error < -q->margenTope) {
+        q->atascos[i]++;
+        return EVENTO_FALLA;
+    }
+    q->deriva[i] = error;
+    q->origen[i] = cuenta - extremo;
+    return EVENTO_LLEGADA;
+}
+
+// Velocidad media de la última ventana y llegada si se mantiene
+static void estimarLlegada(Posiciones *q, int i, bool abre, int32_t cuenta, int32_t posicion, int64_t ahoraUs) {
+    int64_t ventanaUs = ahoraUs - q->ventanaInicioUs[i];
+    if (ventanaUs >= q->ventanaUs) {
+        int32_t avance = abre ? cuenta - q->cuentaVentana[i] : q->cuentaVentana[i] - cuenta;
+        q->velocidad[i] = avance > 0 ? (int32_t)((int64_t)avance * 1000000 / ventanaUs) : 0;
+        q->cuentaVentana[i] = cuenta;
+        q->ventanaInicioUs[i] = ahoraUs;
+    }
+    int32_t falta = abre ? q->recorrido[i] - posicion : posicion;
+    if (q->velocidad[i] == 0) {
+        q->llegadaUs[i] = 0;
+    } else {
+        q->llegadaUs[i] = ahoraUs + (falta > 0 ? (int64_t)falta * 1000000 / q->velocidad[i] : 0);
+    }
+}
+
+static EventoPuerta revisarPuerta(Posiciones *q, int i, bool abre, int32_t cuenta, bool sobrecorriente,
+                                  int64_t ahoraUs) {
+    int32_t posicion = cuenta - q->origen[i];
+    if (q->tope & BIT_PUERTA(i)) {
+        if (!sobrecorriente || ahoraUs - q->inicioUs[i] < q->arranqueUs) {
+            q->sobrecorrienteUs[i] = 0;
+        } else if (q->sobrecorrienteUs[i] == 0) {
+            q->sobrecorrienteUs[i] = ahoraUs;
+        } else if (ahoraUs - q->sobrecorrienteUs[i] >= q->corrienteUs) {
+            return llegarAlTope(q, i, abre, cuenta);
+        }
+    }
+    if (q->recorrido[i] == 0) {
+        return PUERTA_NUM_EVENTOS;
+    }
+    estimarLlegada(q, i, abre, cuenta, posicion, ahoraUs);
+    if (abre ? cuenta > q->ultimaCuenta[i] : cuenta < q->ultimaCuenta[i]) {
+        q->ultimaCuenta[i] = cuenta;
+        q->avanceUs[i] = ahoraUs;
+    }
+    bool enExtremo = abre ? posicion >= q->recorrido[i] - q->tolerancia : posicion <= q->tolerancia;
+    if (enExtremo && !(q->tope & BIT_PUERTA(i))) {
+        return EVENTO_LLEGADA;
+    }
+    // Con tope la hoja sigue empujando en el extremo hasta que la corriente
+    // sube; ese rato no cuenta como atasco
+    if (!enExtremo && ahoraUs - q->avanceUs[i] > q->atascoUs) {
+        q->atascos[i]++;
+        return EVENTO_FALLA;
+    }
+    return PUERTA_NUM_EVENTOS;
+}
+
+void posicionRevisar(Posiciones *q, Portones *p, const int32_t cuentas[], MascaraPortones sobrecorriente,
+                     int64_t ahoraUs) {
+    MascaraPortones moviendo = (p->abriendo | p->cerrando) & p->conPosicion;
+    while (moviendo != 0) {
+        int i = __builtin_ctzll(moviendo);
+        moviendo &= moviendo - 1;
+        MascaraPortones bit = BIT_PUERTA(i);
+        bool abre = (p->abriendo & bit) != 0;
+        // Arranque o cambio de sentido desde la revisión anterior
+        if (!((abre ? q->abriendo : q->cerrando) & bit)) {
+            q->inicioUs[i] = ahoraUs;
+            q->avanceUs[i] = ahoraUs;
+            q->ultimaCuenta[i] = cuentas[i];
+            q->sobrecorrienteUs[i] = 0;
+            q->cuentaVentana[i] = cuentas[i];
+            q->ventanaInicioUs[i] = ahoraUs;
+            q->velocidad[i] = 0;
+            q->llegadaUs[i] = 0;
+        }
+        EventoPuerta evento = revisarPuerta(q, i, abre, cuentas[i], (sobrecorriente & bit) != 0, ahoraUs);
+        if (evento == EVENTO_LLEGADA) {
+            q->llegadas[i]++;
+        }
+        if (evento != PUERTA_NUM_EVENTOS) {
+            portonesEvento(p, i, evento, ahoraUs);
+        }
+    }
+    // Las que se pararon ya no tienen llegada
+    MascaraPortones paradas = (q->abriendo | q->cerrando) & ~(p->abriendo | p->cerrando);
+    while (paradas != 0) {
+        int i = __builtin_ctzll(paradas);
+        paradas &= paradas - 1;
+        q->llegadaUs[i] = 0;
+    }
+    q->abriendo = p->abriendo;
+    q->cerrando = p->cerrando;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "portones.h"
+
+// Posición real de cada puerta en movimiento, con encoder en cuadratura,
+// con tope por corriente del motor o con ambos. Entrega a los portones
+// EVENTO_LLEGADA al llegar al final del recorrido y EVENTO_FALLA si la hoja
+// deja de avanzar. Con tope la llegada la marca el tope, que además corrige
+// la deriva de la cuenta; sin él, la cuenta. Con encoder estima además
+// cuándo llegará, para que las rampas frenen antes. No depende de ESP-IDF.
+
+typedef struct {
+    int32_t recorrido;          // cuentas de cerrada a abierta, 0 sin encoder
+    bool tope;                  // hay medida de corriente
+} ConfigPosicion;
+
+typedef struct {
+    int num;
+    int32_t tolerancia;         // cuentas que se dan por llegada
+    int32_t margenTope;         // un tope más lejos del extremo es obstrucción
+    uint32_t atascoUs;          // sin avanzar este tiempo es atasco
+    uint32_t arranqueUs;        // se ignora el pico de corriente del arranque
+    uint32_t corrienteUs;       // la sobrecorriente debe sostenerse
+    uint32_t ventanaUs;         // ventana de la medida de velocidad
+    // Por puerta
+    int32_t recorrido[PORTONES_MAX];
+    int32_t origen[PORTONES_MAX];           // cuenta en la puerta cerrada
+    int32_t ultimaCuenta[PORTONES_MAX];
+    int64_t inicioUs[PORTONES_MAX];
+    int64_t avanceUs[PORTONES_MAX];
+    int64_t sobrecorrienteUs[PORTONES_MAX]; // 0 sin sobrecorriente
+    int32_t deriva[PORTONES_MAX];           // error de cuenta en el último tope
+    int32_t cuentaVentana[PORTONES_MAX];    // cuenta al abrir la ventana
+    int64_t ventanaInicioUs[PORTONES_MAX];
+    int32_t velocidad[PORTONES_MAX];        // cuentas/s hacia el extremo
+    int64_t llegadaUs[PORTONES_MAX];        // llegada estimada, 0 sin estimación
+    uint32_t llegadas[PORTONES_MAX];
+    uint32_t atascos[PORTONES_MAX];
+    MascaraPortones tope;
+    MascaraPortones abriendo;               // sentido en la revisión anterior
+    MascaraPortones cerrando;
+} Posiciones;
+
+// Las cuentas de todas las puertas valen 0 al iniciar: se supone que
+// arrancan cerradas hasta el primer tope
+void posicionIniciar(Posiciones *q, int num, const ConfigPosicion config[]);
+// Las puertas sin encoder ni tope se ignoran; las demás quedan en
+// p->conPosicion
+void posicionAplicar(const Posiciones *q, Portones *p);
+// Revisa las puertas que se mueven con la cuenta de su encoder y la máscara
+// de sobrecorriente leídas ahora. Va en cada pasada, se mueva o no alguna
+// puerta, para detectar los arranques.
+void posicionRevisar(Posiciones *q, Portones *p, const int32_t cuentas[], MascaraPortones sobrecorriente,
+                     int64_t ahoraUs);
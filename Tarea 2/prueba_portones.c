@@ -0,0 +1,114 @@
+// Equivalencia entre el bucle de varias puertas del firmware y la simulación
+// de una puerta, en el PC:
+//   gcc -O2 -std=c99 prueba_portones.c portones.c sim_puerta.c puerta_fsm.c -o prueba_portones
+//   ./prueba_portones [semilla] [pasos]
+// Las mismas entradas al azar van a un portones de 40 puertas y a una
+// Simulacion por puerta (portones con una sola, reloj virtual); tras cada
+// paso deben coincidir estado, motor, plazo y señal de falla de todas, así
+// que compartir máscaras y rueda no cambia lo que hace cada puerta. Una de
+// cada tres tiene medida de posición, con el plazo de movimiento como límite.
+// También comprueba que portonesProximo nunca quede en el pasado.
+#include <stdio.h>
+#include <stdlib.h>
+#include "portones.h"
+#include "sim_puerta.h"
+
+#define PUERTAS 40
+#define TIEMPO_MOVIMIENTO_MS 30000
+#define TIEMPO_ESPERA_MS 2000
+#define CON_POSICION 0x9249249249ull
+
+static Portones portones;
+static Simulacion sims[PUERTAS];
+
+static uint32_t semilla;
+static bool primeraDiferencia = true;
+
+static uint32_t aleatorio() {
+    semilla ^= semilla << 13;
+    semilla ^= semilla >> 17;
+    semilla ^= semilla << 5;
+    return semilla;
+}
+
+static long comparar(int64_t ahoraUs) {
+    long errores = 0;
+    for (int i = 0; i < PUERTAS; i++) {
+        const Portones *s = &sims[i].portones;
+        bool abriendo = (portones.abriendo >> i) & 1, cerrando = (portones.cerrando >> i) & 1;
+        bool falla = (portones.falla >> i) & 1;
+        if (portones.estado[i] != s->estado[0] || abriendo != (s->abriendo & 1) || cerrando != (s->cerrando & 1) ||
+            portones.plazoUs[i] != s->plazoUs[0] || falla != (s->falla & 1)) {
+            if (primeraDiferencia) {
+                primeraDiferencia = false;
+                printf("puerta %d a %.3f s: portones %s motor %d%d plazo %lld, simulador %s motor %d%d plazo %lld\n",
+                       i, ahoraUs / 1e6, puertaNombreEstado(portones.estado[i]), abriendo, cerrando,
+                       (long long)portones.plazoUs[i], puertaNombreEstado(s->estado[0]), (int)(s->abriendo & 1),
+                       (int)(s->cerrando & 1), (long long)s->plazoUs[0]);
+            }
+            errores++;
+        }
+    }
+    return errores;
+}
+
+int main(int argc, char **argv) {
+    semilla = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 3;
+    unsigned long pasos = argc > 2 ? strtoul(argv[2], NULL, 0) : 2000000;
+    if (semilla == 0) semilla = 1;
+    static const EventoPuerta pulsaciones[] = {EVENTO_ABRIR, EVENTO_CERRAR, EVENTO_PARO};
+    static const EventoPuerta sueltos[] = {EVENTO_FALLA, EVENTO_REARME, EVENTO_LLEGADA};
+
+    portonesIniciar(&portones, PUERTAS, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS, 0, 0);
+    portones.conPosicion = CON_POSICION;
+    for (int i = 0; i < PUERTAS; i++) {
+        simIniciar(&sims[i], TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS);
+        sims[i].portones.conPosicion = (CON_POSICION >> i) & 1;
+    }
+    MascaraPortones niveles[PORTONES_NUM_ENTRADAS] = {0};
+    int64_t ahoraUs = 0;
+    long errores = 0, pasosConError = 0;
+    for (unsigned long k = 0; k < pasos; k++) {
+        // Ráfagas que llenan las mismas ranuras y, de vez en cuando, una
+        // pausa larga para que los movimientos de 30 s lleguen a vencer
+        ahoraUs += aleatorio() % 50 == 0 ? aleatorio() % 60000000 : 1 + aleatorio() % 20000;
+        for (int i = 0; i < PUERTAS; i++) {
+            simAvanzar(&sims[i], ahoraUs);
+        }
+        int i = aleatorio() % PUERTAS;
+        uint32_t tirada = aleatorio() % 100;
+        if (tirada < 2) {
+            // Falla, rearme o llegada medida: eventos sueltos, como los de posicion.c
+            EventoPuerta evento = sueltos[aleatorio() % 3];
+            simEntregar(&sims[i], ahoraUs, evento);
+            portonesEvento(&portones, i, evento, ahoraUs);
+        } else {
+            // Cambia un nivel: el botón cuenta al pulsarse, el sensor en los dos flancos
+            int e = tirada % PORTONES_NUM_ENTRADAS;
+            niveles[e] ^= (MascaraPortones)1 << i;
+            bool activo = (niveles[e] >> i) & 1;
+            if (e == ENTRADA_OBSTACULO) {
+                simEntregar(&sims[i], ahoraUs, activo ? EVENTO_OBSTACULO : EVENTO_LIBRE);
+            } else if (activo) {
+                simEntregar(&sims[i], ahoraUs, pulsaciones[e]);
+            }
+            portonesEntradas(&portones, niveles, ahoraUs);
+        }
+        long n = comparar(ahoraUs);
+        // El firmware arma su temporizador en portonesProximo: nada vencido
+        // puede quedar en la rueda
+        int64_t proximoUs = portonesProximo(&portones);
+        if (proximoUs != 0 && proximoUs <= ahoraUs) {
+            if (primeraDiferencia) {
+                primeraDiferencia = false;
+                printf("a %.3f s queda en la rueda un vencimiento de %.3f s\n", ahoraUs / 1e6, proximoUs / 1e6);
+            }
+            n++;
+        }
+        errores += n;
+        pasosConError += n != 0;
+    }
+    printf("%lu pasos, %llu eventos despachados: %ld diferencias en %ld pasos\n", pasos,
+           (unsigned long long)portones.eventos, errores, pasosConError);
+    return errores != 0;
+}
@@ -0,0 +1,190 @@
+// Trazas de la medida de posición en el PC:
+//   gcc -O2 -std=c99 prueba_posicion.c posicion.c portones.c puerta_fsm.c -o prueba_posicion && ./prueba_posicion
+// Una hoja virtual mueve su encoder paso a paso; los flancos de A y B se
+// cuentan con las mismas acciones que configura configurarPosicion en
+// main.c, y cada pasada de 10 ms entrega la cuenta a posicionRevisar. Se
+// comprueba el sentido de la cuadratura (A adelantada abre), que los cables
+// cruzados se detecten como atasco, que el tope corrija la deriva de la
+// cuenta y que un tope lejos del extremo sea falla.
+#include <stdio.h>
+#include "posicion.h"
+
+#define RECORRIDO 2000
+#define PASOS_POR_PASADA 4
+#define PASADA_US 10000
+#define TIEMPO_MOVIMIENTO_MS 30000
+#define TIEMPO_ESPERA_MS 2000
+
+typedef struct {
+    int pos;                // pasos desde el extremo cerrado, el real
+    int fin;                // hasta dónde puede llegar: extremo u obstrucción
+    bool a, b;
+    bool cruzado;           // A y B intercambiados en el conector
+    int32_t cuenta;         // lo que acumula el PCNT
+} Hoja;
+
+static int errores;
+static int64_t ahoraUs;
+
+static void comprobar(bool condicion, const char *que) {
+    if (!condicion) {
+        printf("FALLO %s\n", que);
+        errores++;
+    }
+}
+
+// Igual que las acciones del PCNT en configurarPosicion: canal A con flanco
+// en A y nivel en B, canal B al revés
+static int flancoA(bool subida, bool b) {
+    return subida == b ? -1 : 1;
+}
+
+static int flancoB(bool subida, bool a) {
+    return subida == a ? 1 : -1;
+}
+
+static void niveles(int pos, bool cruzado, bool *a, bool *b) {
+    static const bool fase[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    int f = pos & 3;
+    *a = fase[f][cruzado];
+    *b = fase[f][!cruzado];
+}
+
+// Un paso de cuadratura: cambia uno solo de los dos canales
+static void mover(Hoja *h, int sentido) {
+    bool a, b;
+    h->pos += sentido;
+    niveles(h->pos, h->cruzado, &a, &b);
+    if (a != h->a) {
+        h->cuenta += flancoA(a, b);
+    } else {
+        h->cuenta += flancoB(b, a);
+    }
+    h->a = a;
+    h->b = b;
+}
+
+static void iniciarHoja(Hoja *h, int pos, bool cruzado) {
+    *h = (Hoja){.pos = pos, .fin = RECORRIDO, .cruzado = cruzado};
+    niveles(pos, cruzado, &h->a, &h->b);
+}
+
+static void trazar(void *usuario, const Portones *p, int i, EventoPuerta evento, EstadoPuerta anterior,
+                   AccionPuerta accion) {
+    const Hoja *h = usuario;
+    (void)accion;
+    if (p->estado[i] != anterior) {
+        printf("  %7.3f s  %-14s %-9s -> %-9s pos %5d cuenta %5d\n", ahoraUs / 1e6, puertaNombreEvento(evento),
+               puertaNombreEstado(anterior), puertaNombreEstado((EstadoPuerta)p->estado[i]), h->pos, h->cuenta);
+    }
+}
+
+typedef struct {
+    Portones p;
+    Posiciones q;
+    Hoja h;
+    MascaraPortones niveles[PORTONES_NUM_ENTRADAS];
+} Banco;
+
+static void iniciarBanco(Banco *k, ConfigPosicion config, int pos, bool cruzado) {
+    portonesIniciar(&k->p, 1, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS, 0, 0);
+    posicionIniciar(&k->q, 1, &config);
+    posicionAplicar(&k->q, &k->p);
+    iniciarHoja(&k->h, pos, cruzado);
+    k->p.observador = trazar;
+    k->p.usuario = &k->h;
+    for (int e = 0; e < PORTONES_NUM_ENTRADAS; e++) {
+        k->niveles[e] = 0;
+    }
+    ahoraUs = 0;
+}
+
+// Pulsa el botón y deja correr hasta que la puerta deje de moverse; la
+// cuenta sube mientras abre si la cuadratura va en el sentido correcto
+static bool pulsar(Banco *k, EntradaPorton boton, bool *monotona) {
+    *monotona = true;
+    for (int n = 0; n < 2000; n++) {
+        ahoraUs += PASADA_US;
+        k->niveles[boton] = n == 0;
+        portonesEntradas(&k->p, k->niveles, ahoraUs);
+        int sentido = (k->p.abriendo & 1) ? 1 : (k->p.cerrando & 1) ? -1 : 0;
+        if (sentido == 0 && n > 0) {
+            return true;
+        }
+        bool bloqueada = false;
+        int32_t antes = k->h.cuenta;
+        for (int s = 0; s < PASOS_POR_PASADA; s++) {
+            int destino = k->h.pos + sentido;
+            if (destino < 0 || destino > k->h.fin) {
+                bloqueada = true;
+                break;
+            }
+            mover(&k->h, sentido);
+        }
+        *monotona &= sentido > 0 ? k->h.cuenta >= antes : k->h.cuenta <= antes;
+        int32_t cuentas[1] = {k->h.cuenta};
+        posicionRevisar(&k->q, &k->p, cuentas, bloqueada && sentido != 0, ahoraUs);
+    }
+    return false;
+}
+
+// Con solo encoder la llegada la marca la cuenta en los dos sentidos
+static void probarSentido(void) {
+    printf("encoder, A adelantada al abrir:\n");
+    Banco k;
+    bool monotona;
+    iniciarBanco(&k, (ConfigPosicion){.recorrido = RECORRIDO}, 0, false);
+    comprobar(pulsar(&k, ENTRADA_ABRIR, &monotona) && k.p.estado[0] == ABIERTA, "no llega abierta");
+    comprobar(monotona && k.h.cuenta >= RECORRIDO - k.q.tolerancia, "la cuenta no sube al abrir");
+    pulsar(&k, ENTRADA_CERRAR, &monotona);
+    comprobar(k.p.estado[0] == CERRADA, "no llega cerrada");
+    comprobar(monotona && k.h.cuenta <= k.q.tolerancia, "la cuenta no baja al cerrar");
+    comprobar(k.q.llegadas[0] == 2 && k.q.atascos[0] == 0, "llegadas o atascos de más");
+}
+
+// Con A y B cruzados la cuenta va al revés y la hoja parece no avanzar
+static void probarCruzado(void) {
+    printf("encoder con A y B cruzados:\n");
+    Banco k;
+    bool monotona;
+    iniciarBanco(&k, (ConfigPosicion){.recorrido = RECORRIDO}, 0, true);
+    pulsar(&k, ENTRADA_ABRIR, &monotona);
+    comprobar(k.h.cuenta < 0 && k.p.estado[0] == ERROR && k.q.atascos[0] == 1, "cables cruzados sin falla");
+    comprobar(ahoraUs <= PASADA_US + k.q.atascoUs + 2 * PASADA_US, "el atasco tarda más de atascoUs");
+}
+
+// La hoja arrancó 37 pasos abierta sin saberlo: el primer tope absorbe la
+// deriva y el siguiente ya llega con la cuenta justa
+static void probarTope(void) {
+    printf("encoder y tope, 37 pasos de deriva:\n");
+    Banco k;
+    bool monotona;
+    iniciarBanco(&k, (ConfigPosicion){.recorrido = RECORRIDO, .tope = true}, 37, false);
+    pulsar(&k, ENTRADA_ABRIR, &monotona);
+    comprobar(k.p.estado[0] == ABIERTA && k.q.deriva[0] == -37, "el tope de abierta no mide la deriva");
+    comprobar(k.q.origen[0] == -37, "el tope de abierta no reajusta el origen");
+    pulsar(&k, ENTRADA_CERRAR, &monotona);
+    comprobar(k.p.estado[0] == CERRADA && k.h.pos == 0, "no llega al tope de cerrada");
+    comprobar(k.q.deriva[0] == 0 && k.h.cuenta - k.q.origen[0] == 0, "queda deriva tras reajustar");
+    comprobar(k.q.llegadas[0] == 2 && k.q.atascos[0] == 0, "llegadas o atascos de más");
+}
+
+// Un tope a mitad de recorrido no es el extremo sino una obstrucción
+static void probarObstruccion(void) {
+    printf("encoder y tope, obstruida a mitad:\n");
+    Banco k;
+    bool monotona;
+    iniciarBanco(&k, (ConfigPosicion){.recorrido = RECORRIDO, .tope = true}, 0, false);
+    k.h.fin = RECORRIDO / 2;
+    pulsar(&k, ENTRADA_ABRIR, &monotona);
+    comprobar(k.p.estado[0] == ERROR && k.q.atascos[0] == 1 && k.q.origen[0] == 0, "obstrucción tomada por tope");
+}
+
+int main(void) {
+    probarSentido();
+    probarCruzado();
+    probarTope();
+    probarObstruccion();
+    printf("%s (%d errores)\n", errores ? "FALLA" : "OK", errores);
+    return errores != 0;
+}
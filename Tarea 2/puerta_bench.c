@@ -0,0 +1,38 @@
+// Transiciones por segundo del motor de la puerta, en el PC:
+//   gcc -O2 -std=c99 puerta_fsm.c puerta_bench.c -o puerta_bench && ./puerta_bench
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <time.h>
+#include "puerta_fsm.h"
+
+#define EVENTOS_BENCH 100000000u
+
+static double segundos() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main() {
+    PuertaFsm puerta;
+    puertaIniciar(&puerta, 30000, 2000);
+    uint32_t semilla = 12345;
+    uint32_t cambios = 0;
+    int64_t ahoraUs = 0;
+
+    double inicio = segundos();
+    for (uint32_t i = 0; i < EVENTOS_BENCH; i++) {
+        // Generador congruencial: evento al azar y 1 ms de avance por paso
+        semilla = semilla * 1664525u + 1013904223u;
+        EventoPuerta evento = (EventoPuerta)((semilla >> 24) % PUERTA_NUM_EVENTOS);
+        EstadoPuerta antes = puerta.estado;
+        puertaDespachar(&puerta, evento, ahoraUs);
+        cambios += puerta.estado != antes;
+        ahoraUs += 1000;
+    }
+    double total = segundos() - inicio;
+
+    printf("%u eventos en %.3f s: %.1f M eventos/s, %u cambios de estado (estado final %s)\n", EVENTOS_BENCH, total,
+           EVENTOS_BENCH / total / 1e6, cambios, puertaNombreEstado(puerta.estado));
+    return 0;
+}
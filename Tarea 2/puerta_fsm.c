@@ -0,0 +1,125 @@
+#include "puerta_fsm.h"
+
+typedef enum {
+    PLAZO_SIN_CAMBIO,
+    PLAZO_MOVIMIENTO,
+    PLAZO_ESPERA,
+    PLAZO_NINGUNO
+} EfectoPlazo;
+
+typedef struct {
+    bool definida;
+    uint8_t guarda;
+    uint8_t accion;
+    uint8_t destino;
+    uint8_t accionSino;
+    uint8_t destinoSino;
+} TransicionPuerta;
+
+// Comprobaciones en compilación sobre la tabla: cada estado debe poder
+// alcanzarse desde ESPERA y tener alguna salida.
+#define BIT(estado) (1u << (estado))
+#define TODOS_LOS_ESTADOS (BIT(PUERTA_NUM_ESTADOS) - 1u)
+#define SALIDA(o, e, g, a, d, as, ds) | ((d) != (o) || (ds) != (o) ? BIT(o) : 0u)
+#define SUCESORES(m) (0u PUERTA_TRANSICIONES(SUCESOR_DE_##m))
+
+enum { ESTADOS_CON_SALIDA = 0u PUERTA_TRANSICIONES(SALIDA) };
+
+// Cierre transitivo desde ESPERA, un paso por estado
+#define SUCESOR(m, o, e, g, a, d, as, ds) | (((m) & BIT(o)) ? BIT(d) | BIT(ds) : 0u)
+#define SUCESOR_DE_A0(...) SUCESOR(ALCANZABLES_0, __VA_ARGS__)
+#define SUCESOR_DE_A1(...) SUCESOR(ALCANZABLES_1, __VA_ARGS__)
+#define SUCESOR_DE_A2(...) SUCESOR(ALCANZABLES_2, __VA_ARGS__)
+#define SUCESOR_DE_A3(...) SUCESOR(ALCANZABLES_3, __VA_ARGS__)
+#define SUCESOR_DE_A4(...) SUCESOR(ALCANZABLES_4, __VA_ARGS__)
+#define SUCESOR_DE_A5(...) SUCESOR(ALCANZABLES_5, __VA_ARGS__)
+#define SUCESOR_DE_A6(...) SUCESOR(ALCANZABLES_6, __VA_ARGS__)
+#define SUCESOR_DE_A7(...) SUCESOR(ALCANZABLES_7, __VA_ARGS__)
+
+enum {
+    ALCANZABLES_0 = BIT(ESPERA),
+    ALCANZABLES_1 = ALCANZABLES_0 | SUCESORES(A0),
+    ALCANZABLES_2 = ALCANZABLES_1 | SUCESORES(A1),
+    ALCANZABLES_3 = ALCANZABLES_2 | SUCESORES(A2),
+    ALCANZABLES_4 = ALCANZABLES_3 | SUCESORES(A3),
+    ALCANZABLES_5 = ALCANZABLES_4 | SUCESORES(A4),
+    ALCANZABLES_6 = ALCANZABLES_5 | SUCESORES(A5),
+    ALCANZABLES_7 = ALCANZABLES_6 | SUCESORES(A6),
+    ALCANZABLES = ALCANZABLES_7 | SUCESORES(A7),
+};
+
+_Static_assert(PUERTA_NUM_ESTADOS <= 8, "ampliar el cierre transitivo de ALCANZABLES");
+_Static_assert(ALCANZABLES == TODOS_LOS_ESTADOS, "hay estados inalcanzables desde ESPERA");
+_Static_assert(ESTADOS_CON_SALIDA == TODOS_LOS_ESTADOS, "hay estados sin ninguna transición de salida");
+
+#define FILA(o, e, g, a, d, as, ds) [o][e] = {true, g, a, d, as, ds},
+
+static const TransicionPuerta tabla[PUERTA_NUM_ESTADOS][PUERTA_NUM_EVENTOS] = {
+    PUERTA_TRANSICIONES(FILA)
+};
+
+#define EFECTO(nombre, plazo, motor) [nombre] = plazo,
+#define MOTOR(nombre, plazo, motor) [nombre] = motor,
+static const uint8_t efectoPlazo[PUERTA_NUM_ACCIONES] = { PUERTA_ACCIONES(EFECTO) };
+static const uint8_t motorAccion[PUERTA_NUM_ACCIONES] = { PUERTA_ACCIONES(MOTOR) };
+
+#define NOMBRE(nombre) [nombre] = #nombre,
+#define NOMBRE_ACCION(nombre, plazo, motor) [nombre] = #nombre,
+static const char *const nombresEstados[] = { PUERTA_ESTADOS(NOMBRE) };
+static const char *const nombresEventos[] = { PUERTA_EVENTOS(NOMBRE) };
+static const char *const nombresAcciones[] = { PUERTA_ACCIONES(NOMBRE_ACCION) };
+
+static bool cumpleGuarda(const PuertaFsm *fsm, GuardaPuerta guarda, int64_t ahoraUs) {
+    bool plazoCumplido = fsm->plazoUs != 0 && ahoraUs >= fsm->plazoUs;
+    switch (guarda) {
+        case GUARDA_SIN_OBSTACULO: return !fsm->obstaculo;
+        case GUARDA_CON_OBSTACULO: return fsm->obstaculo;
+        case GUARDA_PLAZO_CUMPLIDO: return plazoCumplido;
+        case GUARDA_PUEDE_CERRAR: return plazoCumplido && !fsm->obstaculo;
+        default: return true;
+    }
+}
+
+void puertaIniciar(PuertaFsm *fsm, uint32_t tiempoMovimientoMs, uint32_t tiempoEsperaMs) {
+    *fsm = (PuertaFsm){
+        .estado = ESPERA,
+        .tiempoMovimientoMs = tiempoMovimientoMs,
+        .tiempoEsperaMs = tiempoEsperaMs,
+    };
+}
+
+AccionPuerta puertaDespachar(PuertaFsm *fsm, EventoPuerta evento, int64_t ahoraUs) {
+    if (evento == EVENTO_OBSTACULO || evento == EVENTO_LIBRE) {
+        fsm->obstaculo = evento == EVENTO_OBSTACULO;
+    }
+    const TransicionPuerta *t = &tabla[fsm->estado][evento];
+    if (!t->definida) {
+        return ACCION_NINGUNA;
+    }
+    bool cumple = cumpleGuarda(fsm, (GuardaPuerta)t->guarda, ahoraUs);
+    AccionPuerta accion = (AccionPuerta)(cumple ? t->accion : t->accionSino);
+    fsm->estado = (EstadoPuerta)(cumple ? t->destino : t->destinoSino);
+    switch (efectoPlazo[accion]) {
+        case PLAZO_MOVIMIENTO: fsm->plazoUs = ahoraUs + (int64_t)fsm->tiempoMovimientoMs * 1000; break;
+        case PLAZO_ESPERA: fsm->plazoUs = ahoraUs + (int64_t)fsm->tiempoEsperaMs * 1000; break;
+        case PLAZO_NINGUNO: fsm->plazoUs = 0; break;
+        default: break;
+    }
+    return accion;
+}
+
+SentidoMotor puertaMotor(AccionPuerta accion) {
+    return accion < PUERTA_NUM_ACCIONES ? (SentidoMotor)motorAccion[accion] : MOTOR_SIN_CAMBIO;
+}
+
+const char *puertaNombreEstado(EstadoPuerta estado) {
+    return estado < PUERTA_NUM_ESTADOS ? nombresEstados[estado] : "?";
+}
+
+const char *puertaNombreEvento(EventoPuerta evento) {
+    return evento < PUERTA_NUM_EVENTOS ? nombresEventos[evento] : "?";
+}
+
+const char *puertaNombreAccion(AccionPuerta accion) {
+    return accion < PUERTA_NUM_ACCIONES ? nombresAcciones[accion] : "?";
+}
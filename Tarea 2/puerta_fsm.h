@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Máquina de estados de la puerta como tabla: estado x evento -> guarda,
+// acción y estado siguiente. Despachar es una consulta a la tabla y no
+// depende del hardware; quien la usa ejecuta la acción devuelta y arma un
+// temporizador para plazoUs. Compila igual para el ESP32 y para el PC.
+
+#define PUERTA_ESTADOS(X) \
+    X(ESPERA)             \
+    X(ABRIENDO)           \
+    X(ABIERTA)            \
+    X(CERRANDO)           \
+    X(CERRADA)            \
+    X(DETENIDA)           \
+    X(ERROR)
+
+// EVENTO_LLEGADA es la llegada medida al final del recorrido (encoder o
+// corriente del motor); sin esa medida el plazo de movimiento hace de llegada.
+#define PUERTA_EVENTOS(X)   \
+    X(EVENTO_ABRIR)         \
+    X(EVENTO_CERRAR)        \
+    X(EVENTO_PARO)          \
+    X(EVENTO_OBSTACULO)     \
+    X(EVENTO_LIBRE)         \
+    X(EVENTO_PLAZO)         \
+    X(EVENTO_LLEGADA)       \
+    X(EVENTO_FALLA)         \
+    X(EVENTO_FIN_PARPADEO)  \
+    X(EVENTO_REARME)
+
+// Cada acción dice también qué pasa con el plazo pendiente y con el motor.
+// portones.c, que corre en el firmware y en los programas del PC, saca el
+// motor de esta columna con puertaMotor.
+#define PUERTA_ACCIONES(X)                                     \
+    X(ACCION_NINGUNA, PLAZO_SIN_CAMBIO, MOTOR_SIN_CAMBIO)      \
+    X(ACCION_ABRIR, PLAZO_MOVIMIENTO, MOTOR_ABRIENDO)          \
+    X(ACCION_CERRAR, PLAZO_MOVIMIENTO, MOTOR_CERRANDO)         \
+    X(ACCION_ESPERAR, PLAZO_ESPERA, MOTOR_PARADO)              \
+    X(ACCION_DETENER, PLAZO_NINGUNO, MOTOR_PARADO)             \
+    X(ACCION_SENALIZAR_FALLA, PLAZO_NINGUNO, MOTOR_PARADO)
+
+#define PUERTA_GUARDAS(X)   \
+    X(GUARDA_SIEMPRE)       \
+    X(GUARDA_SIN_OBSTACULO) \
+    X(GUARDA_CON_OBSTACULO) \
+    X(GUARDA_PLAZO_CUMPLIDO)\
+    X(GUARDA_PUEDE_CERRAR)
+
+// origen, evento, guarda, acción y destino si la guarda se cumple, acción y
+// destino si no. Los pares sin fila ignoran el evento. Con el obstáculo
+// presente nunca se entra en CERRANDO, y el paro vale en todos los estados
+// salvo ERROR.
+#define PUERTA_TRANSICIONES(X)                                                                                        \
+    X(ESPERA, EVENTO_ABRIR, GUARDA_SIEMPRE, ACCION_ABRIR, ABRIENDO, ACCION_NINGUNA, ESPERA)                           \
+    X(ESPERA, EVENTO_CERRAR, GUARDA_SIN_OBSTACULO, ACCION_CERRAR, CERRANDO, ACCION_NINGUNA, ESPERA)                   \
+    X(ESPERA, EVENTO_PARO, GUARDA_CON_OBSTACULO, ACCION_DETENER, DETENIDA, ACCION_DETENER, ESPERA)                    \
+    X(ESPERA, EVENTO_FALLA, GUARDA_SIEMPRE, ACCION_SENALIZAR_FALLA, ERROR, ACCION_NINGUNA, ESPERA)                    \
+    X(ABRIENDO, EVENTO_CERRAR, GUARDA_SIN_OBSTACULO, ACCION_CERRAR, CERRANDO, ACCION_NINGUNA, ABRIENDO)               \
+    X(ABRIENDO, EVENTO_PARO, GUARDA_CON_OBSTACULO, ACCION_DETENER, DETENIDA, ACCION_DETENER, ESPERA)                  \
+    X(ABRIENDO, EVENTO_PLAZO, GUARDA_PLAZO_CUMPLIDO, ACCION_ESPERAR, ABIERTA, ACCION_NINGUNA, ABRIENDO)               \
+    X(ABRIENDO, EVENTO_LLEGADA, GUARDA_SIEMPRE, ACCION_ESPERAR, ABIERTA, ACCION_NINGUNA, ABRIENDO)                    \
+    X(ABRIENDO, EVENTO_FALLA, GUARDA_SIEMPRE, ACCION_SENALIZAR_FALLA, ERROR, ACCION_NINGUNA, ABRIENDO)                \
+    X(ABIERTA, EVENTO_CERRAR, GUARDA_SIN_OBSTACULO, ACCION_CERRAR, CERRANDO, ACCION_NINGUNA, ABIERTA)                 \
+    X(ABIERTA, EVENTO_PARO, GUARDA_CON_OBSTACULO, ACCION_DETENER, DETENIDA, ACCION_DETENER, ESPERA)                   \
+    X(ABIERTA, EVENTO_PLAZO, GUARDA_PUEDE_CERRAR, ACCION_CERRAR, CERRANDO, ACCION_ESPERAR, ABIERTA)                   \
+    X(ABIERTA, EVENTO_FALLA, GUARDA_SIEMPRE, ACCION_SENALIZAR_FALLA, ERROR, ACCION_NINGUNA, ABIERTA)                  \
+    X(CERRANDO, EVENTO_ABRIR, GUARDA_SIEMPRE, ACCION_ABRIR, ABRIENDO, ACCION_NINGUNA, CERRANDO)                       \
+    X(CERRANDO, EVENTO_OBSTACULO, GUARDA_SIEMPRE, ACCION_ABRIR, ABRIENDO, ACCION_NINGUNA, CERRANDO)                   \
+    X(CERRANDO, EVENTO_PARO, GUARDA_CON_OBSTACULO, ACCION_DETENER, DETENIDA, ACCION_DETENER, ESPERA)                  \
+    X(CERRANDO, EVENTO_PLAZO, GUARDA_PLAZO_CUMPLIDO, ACCION_DETENER, CERRADA, ACCION_NINGUNA, CERRANDO)               \
+    X(CERRANDO, EVENTO_LLEGADA, GUARDA_SIEMPRE, ACCION_DETENER, CERRADA, ACCION_NINGUNA, CERRANDO)                    \
+    X(CERRANDO, EVENTO_FALLA, GUARDA_SIEMPRE, ACCION_SENALIZAR_FALLA, ERROR, ACCION_NINGUNA, CERRANDO)                \
+    X(CERRADA, EVENTO_ABRIR, GUARDA_SIEMPRE, ACCION_ABRIR, ABRIENDO, ACCION_NINGUNA, CERRADA)                         \
+    X(CERRADA, EVENTO_PARO, GUARDA_CON_OBSTACULO, ACCION_DETENER, DETENIDA, ACCION_NINGUNA, CERRADA)                  \
+    X(CERRADA, EVENTO_FALLA, GUARDA_SIEMPRE, ACCION_SENALIZAR_FALLA, ERROR, ACCION_NINGUNA, CERRADA)                  \
+    X(DETENIDA, EVENTO_ABRIR, GUARDA_SIEMPRE, ACCION_ABRIR, ABRIENDO, ACCION_NINGUNA, DETENIDA)                       \
+    X(DETENIDA, EVENTO_CERRAR, GUARDA_SIN_OBSTACULO, ACCION_CERRAR, CERRANDO, ACCION_NINGUNA, DETENIDA)               \
+    X(DETENIDA, EVENTO_LIBRE, GUARDA_SIEMPRE, ACCION_NINGUNA, ESPERA, ACCION_NINGUNA, ESPERA)                         \
+    X(DETENIDA, EVENTO_FALLA, GUARDA_SIEMPRE, ACCION_SENALIZAR_FALLA, ERROR, ACCION_NINGUNA, DETENIDA)                \
+    X(ERROR, EVENTO_FIN_PARPADEO, GUARDA_SIEMPRE, ACCION_NINGUNA, ESPERA, ACCION_NINGUNA, ERROR)                      \
+    X(ERROR, EVENTO_REARME, GUARDA_SIEMPRE, ACCION_NINGUNA, ESPERA, ACCION_NINGUNA, ERROR)
+
+#define PUERTA_ENUM(nombre) nombre,
+#define PUERTA_ENUM_ACCION(nombre, plazo, motor) nombre,
+
+typedef enum {
+    MOTOR_PARADO,
+    MOTOR_ABRIENDO,
+    MOTOR_CERRANDO,
+    MOTOR_SIN_CAMBIO
+} SentidoMotor;
+
+typedef enum { PUERTA_ESTADOS(PUERTA_ENUM) PUERTA_NUM_ESTADOS } EstadoPuerta;
+typedef enum { PUERTA_EVENTOS(PUERTA_ENUM) PUERTA_NUM_EVENTOS } EventoPuerta;
+typedef enum { PUERTA_ACCIONES(PUERTA_ENUM_ACCION) PUERTA_NUM_ACCIONES } AccionPuerta;
+typedef enum { PUERTA_GUARDAS(PUERTA_ENUM) PUERTA_NUM_GUARDAS } GuardaPuerta;
+
+typedef struct {
+    EstadoPuerta estado;
+    bool obstaculo;
+    int64_t plazoUs;                // 0 sin plazo pendiente
+    uint32_t tiempoMovimientoMs;
+    uint32_t tiempoEsperaMs;
+} PuertaFsm;
+
+void puertaIniciar(PuertaFsm *fsm, uint32_t tiempoMovimientoMs, uint32_t tiempoEsperaMs);
+// Aplica el evento y devuelve la acción que debe ejecutar quien llama.
+// EVENTO_OBSTACULO y EVENTO_LIBRE actualizan además fsm->obstaculo.
+AccionPuerta puertaDespachar(PuertaFsm *fsm, EventoPuerta evento, int64_t ahoraUs);
+// Sentido en que debe quedar el motor tras la acción; MOTOR_SIN_CAMBIO lo
+// deja como estaba
+SentidoMotor puertaMotor(AccionPuerta accion);
+const char *puertaNombreEstado(EstadoPuerta estado);
+const char *puertaNombreEvento(EventoPuerta evento);
+const char *puertaNombreAccion(AccionPuerta accion);
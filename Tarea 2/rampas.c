@@ -0,0 +1,140 @@
+#include <stddef.h>
+#include "rampas.h"
+
+#define BIT_PUERTA(i) ((MascaraPortones)1 << (i))
+
+static uint32_t escalar(uint32_t tiempoUs, int32_t delta, int16_t dutyMax) {
+    if (delta < 0) {
+        delta = -delta;
+    }
+    return (uint32_t)((uint64_t)tiempoUs * (uint32_t)delta / (uint32_t)dutyMax);
+}
+
+static void empezar(Rampas *r, int i, int16_t desde, int16_t hasta, uint32_t duracionUs, int64_t ahoraUs) {
+    MascaraPortones bit = BIT_PUERTA(i);
+    r->desde[i] = desde;
+    r->hasta[i] = hasta;
+    r->inicioUs[i] = ahoraUs;
+    r->duracionUs[i] = duracionUs;
+    r->activas |= bit;
+    r->nuevas |= bit;
+    r->aproximando &= ~bit;
+    int16_t sentido = hasta != 0 ? hasta : desde;
+    r->abriendo = sentido > 0 ? r->abriendo | bit : r->abriendo & ~bit;
+    r->cerrando = sentido < 0 ? r->cerrando | bit : r->cerrando & ~bit;
+}
+
+void rampasIniciar(Rampas *r, int num, const PerfilRampa *perfil, int16_t dutyMax) {
+    *r = (Rampas){
+        .num = num,
+        .perfil = *perfil,
+        .dutyMax = dutyMax,
+    };
+}
+
+int16_t rampasDuty(const Rampas *r, int puerta, int64_t ahoraUs) {
+    int64_t transcurridoUs = ahoraUs - r->inicioUs[puerta];
+    if (transcurridoUs >= r->duracionUs[puerta]) {
+        return r->hasta[puerta];
+    }
+    if (transcurridoUs <= 0) {
+        return r->desde[puerta];
+    }
+    int32_t delta = r->hasta[puerta] - r->desde[puerta];
+    return (int16_t)(r->desde[puerta] + delta * transcurridoUs / r->duracionUs[puerta]);
+}
+
+static int16_t aproximacion(const Rampas *r, int16_t objetivo) {
+    return (int16_t)(objetivo * r->perfil.aproximacionPct / 100);
+}
+
+// Llegada estimada al final del recorrido de una puerta en movimiento
+static int64_t llegada(const Portones *p, const int64_t llegadaUs[], int i) {
+    if (p->conPosicion & BIT_PUERTA(i)) {
+        return llegadaUs != NULL ? llegadaUs[i] : 0;
+    }
+    return p->plazoUs[i];
+}
+
+int64_t rampasProximo(const Rampas *r, const Portones *p, int64_t ahoraUs) {
+    int64_t proximoUs = 0;
+    MascaraPortones sinPosicion = (p->abriendo | p->cerrando) & ~p->conPosicion & ~r->aproximando;
+    MascaraPortones revisar = r->activas | sinPosicion;
+    while (revisar != 0) {
+        int i = __builtin_ctzll(revisar);
+        revisar &= revisar - 1;
+        int64_t fechasUs[2] = {r->inicioUs[i] + r->duracionUs[i], 0};
+        if (sinPosicion & BIT_PUERTA(i)) {
+            // Cuenta desde el duty al que lleva el segmento en curso
+            int16_t marcha = aproximacion(r, (p->abriendo & BIT_PUERTA(i)) ? r->dutyMax : -r->dutyMax);
+            fechasUs[1] = p->plazoUs[i] - escalar(r->perfil.paradaUs, r->hasta[i] - marcha, r->dutyMax);
+        }
+        for (int k = 0; k < 2; k++) {
+            if (fechasUs[k] > ahoraUs && (proximoUs == 0 || fechasUs[k] < proximoUs)) {
+                proximoUs = fechasUs[k];
+            }
+        }
+    }
+    return proximoUs;
+}
+
+void rampasRevisar(Rampas *r, const Portones *p, const int64_t llegadaUs[], int64_t ahoraUs) {
+    r->nuevas = 0;
+    MascaraPortones revisar = r->activas | p->abriendo | p->cerrando;
+    while (revisar != 0) {
+        int i = __builtin_ctzll(revisar);
+        revisar &= revisar - 1;
+        MascaraPortones bit = BIT_PUERTA(i);
+        int16_t objetivo = (p->abriendo & bit) ? r->dutyMax : (p->cerrando & bit) ? -r->dutyMax : 0;
+        int16_t actual = rampasDuty(r, i, ahoraUs);
+        bool acabado = ahoraUs - r->inicioUs[i] >= r->duracionUs[i];
+        bool invertir = (actual > 0 && objetivo < 0) || (actual < 0 && objetivo > 0);
+
+        if (objetivo == 0 || invertir) {
+            if (actual == 0) {
+                // Parado: se queda así o ya puede arrancar en el otro sentido
+                r->rapidas &= ~bit;
+                if (objetivo == 0) {
+                    r->activas &= ~bit;
+                    r->abriendo &= ~bit;
+                    r->cerrando &= ~bit;
+                } else {
+                    empezar(r, i, 0, objetivo, escalar(r->perfil.arranqueUs, objetivo, r->dutyMax), ahoraUs);
+                }
+                continue;
+            }
+            // En el extremo no se sigue empujando: ya viene a la marcha de
+            // aproximación y se corta en seco
+            EstadoPuerta estado = (EstadoPuerta)p->estado[i];
+            if (!invertir && (estado == ABIERTA || estado == CERRADA)) {
+                r->rapidas &= ~bit;
+                empezar(r, i, actual, 0, 0, ahoraUs);
+                continue;
+            }
+            // Un frenado rápido en curso sigue
+            if (r->hasta[i] == 0 && !acabado) {
+                continue;
+            }
+            r->rapidas |= bit;
+            empezar(r, i, actual, 0, escalar(r->perfil.paradaRapidaUs, actual, r->dutyMax), ahoraUs);
+            continue;
+        }
+        // En marcha: la aproximación empieza cuando el frenado hasta su
+        // marcha ya no cabe en lo que falta para llegar
+        if (r->aproximando & bit) {
+            continue;
+        }
+        int16_t marcha = aproximacion(r, objetivo);
+        int64_t llegadaPuertaUs = llegada(p, llegadaUs, i);
+        if (llegadaPuertaUs != 0 &&
+            llegadaPuertaUs - ahoraUs <= escalar(r->perfil.paradaUs, actual - marcha, r->dutyMax)) {
+            r->rapidas &= ~bit;
+            empezar(r, i, actual, marcha, llegadaPuertaUs > ahoraUs ? (uint32_t)(llegadaPuertaUs - ahoraUs) : 0,
+                    ahoraUs);
+            r->aproximando |= bit;
+        } else if (r->hasta[i] != objetivo) {
+            r->rapidas &= ~bit;
+            empezar(r, i, actual, objetivo, escalar(r->perfil.arranqueUs, objetivo - actual, r->dutyMax), ahoraUs);
+        }
+    }
+}
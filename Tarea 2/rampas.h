@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "portones.h"
+
+// Rampas del ciclo útil del motor de cada puerta. El sentido lo pide la
+// máquina (ABRIENDO o CERRANDO en los portones); aquí se convierte en
+// segmentos lineales que el firmware ejecuta con el fundido del LEDC y que
+// en el PC se evalúan en cualquier instante. Antes de la llegada estimada
+// al final del recorrido baja a la marcha de aproximación, de modo que
+// acabe de frenar justo al llegar, y al llegar corta en seco; el paro, la
+// falla y la inversión de sentido frenan con el perfil rápido, y el sentido
+// solo cambia con el motor parado. No depende de ESP-IDF.
+
+// Tiempos de cero a plena marcha o de plena marcha a cero; desde marchas
+// intermedias se escalan
+typedef struct {
+    uint32_t arranqueUs;
+    uint32_t paradaUs;
+    uint32_t paradaRapidaUs;
+    uint8_t aproximacionPct;    // marcha al llegar, en % de dutyMax
+} PerfilRampa;
+
+// Ciclo útil con signo: positivo abre, negativo cierra
+typedef struct {
+    int num;
+    PerfilRampa perfil;
+    int16_t dutyMax;
+    // Segmento en curso por puerta: de desde a hasta en duracionUs
+    int16_t desde[PORTONES_MAX];
+    int16_t hasta[PORTONES_MAX];
+    int64_t inicioUs[PORTONES_MAX];
+    uint32_t duracionUs[PORTONES_MAX];
+    MascaraPortones activas;        // motor no parado o segmento sin acabar
+    MascaraPortones rapidas;        // el frenado en curso es rápido
+    MascaraPortones aproximando;    // ya va hacia la marcha de aproximación
+    MascaraPortones nuevas;         // segmentos empezados en la última revisión
+    // Sentido físico del puente, el del segmento en curso
+    MascaraPortones abriendo;
+    MascaraPortones cerrando;
+} Rampas;
+
+void rampasIniciar(Rampas *r, int num, const PerfilRampa *perfil, int16_t dutyMax);
+// Empieza los segmentos que pida el sentido actual de los portones y deja
+// sus puertas en r->nuevas. Se llama en cada pasada mientras r->activas no
+// sea 0 o haya puertas en movimiento. Sin posición, la llegada es el plazo
+// de movimiento; con ella, llegadaUs[i] (0 o NULL sin estimación, y entonces
+// solo se corta al llegar).
+void rampasRevisar(Rampas *r, const Portones *p, const int64_t llegadaUs[], int64_t ahoraUs);
+int16_t rampasDuty(const Rampas *r, int puerta, int64_t ahoraUs);
+// Lo más próximo que pida revisar: el fin de un segmento en curso o, en las
+// puertas sin posición, el inicio de la aproximación. 0 si no hay nada.
+int64_t rampasProximo(const Rampas *r, const Portones *p, int64_t ahoraUs);
@@ -0,0 +1,104 @@
+// Tiempos de las rampas del motor medidos sobre el modelo, en el PC:
+//   gcc -O2 -std=c99 rampas_traza.c rampas.c portones.c puerta_fsm.c -o rampas_traza
+//   ./rampas_traza [arranque_ms parada_ms parada_rapida_ms] [-v]
+// Una puerta hace un ciclo con inversión por obstáculo, un paro y un cierre
+// completo, en reloj virtual con pasadas cada milisegundo. Cada segmento se
+// mide por el ciclo útil muestreado, no por la duración programada; -v saca
+// además la curva como CSV (ms, estado, duty), con las medidas como
+// comentarios '#'. Falla si alguna llegada al extremo no viene ya a la
+// marcha de aproximación o no corta en la misma pasada.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rampas.h"
+
+#define TIEMPO_MOVIMIENTO_MS 30000
+#define TIEMPO_ESPERA_MS 2000
+#define DUTY_MAX 1023
+#define PASADA_US 1000
+
+static const struct {
+    int64_t ms;
+    EntradaPorton entrada;
+    bool nivel;
+} guion[] = {
+    {1000, ENTRADA_ABRIR, true},      {1100, ENTRADA_ABRIR, false},
+    {40000, ENTRADA_OBSTACULO, true}, {41000, ENTRADA_OBSTACULO, false},
+    {50000, ENTRADA_PARO, true},      {50100, ENTRADA_PARO, false},
+    {60000, ENTRADA_CERRAR, true},    {60100, ENTRADA_CERRAR, false},
+};
+#define PASOS_GUION (sizeof(guion) / sizeof(guion[0]))
+
+int main(int argc, char **argv) {
+    PerfilRampa perfil = {.arranqueUs = 1500000, .paradaUs = 800000, .paradaRapidaUs = 150000, .aproximacionPct = 25};
+    bool curva = argc > 1 && strcmp(argv[argc - 1], "-v") == 0;
+    if (argc - curva == 4) {
+        perfil.arranqueUs = (uint32_t)strtoul(argv[1], NULL, 0) * 1000;
+        perfil.paradaUs = (uint32_t)strtoul(argv[2], NULL, 0) * 1000;
+        perfil.paradaRapidaUs = (uint32_t)strtoul(argv[3], NULL, 0) * 1000;
+    }
+    Portones p;
+    Rampas r;
+    portonesIniciar(&p, 1, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS, 0, 0);
+    rampasIniciar(&r, 1, &perfil, DUTY_MAX);
+    MascaraPortones niveles[PORTONES_NUM_ENTRADAS] = {0};
+    size_t paso = 0;
+    int64_t segmentoUs = -1, inversionUs = -1;
+    int16_t desde = 0, hasta = 0, sentidoFrenado = 0;
+    bool rapida = false;
+    int errores = 0;
+
+    for (int64_t ahoraUs = 0; ahoraUs <= 100000000; ahoraUs += PASADA_US) {
+        while (paso < PASOS_GUION && guion[paso].ms * 1000 <= ahoraUs) {
+            niveles[guion[paso].entrada] = guion[paso].nivel;
+            paso++;
+        }
+        // El segmento anterior se da por acabado con el duty previo a la
+        // revisión, que puede empezar el siguiente en esta misma pasada
+        int16_t duty = rampasDuty(&r, 0, ahoraUs);
+        if (segmentoUs >= 0 && duty == hasta) {
+            printf("# %8.3f s  %-9s %5d -> %5d en %6.0f ms%s\n", segmentoUs / 1e6,
+                   puertaNombreEstado((EstadoPuerta)p.estado[0]), desde, hasta, (ahoraUs - segmentoUs) / 1e3,
+                   rapida ? " (rápida)" : "");
+            if (inversionUs >= 0 && desde == 0 && (hasta > 0) != (sentidoFrenado > 0)) {
+                printf("# %8.3f s  inversión completa en %.0f ms\n", inversionUs / 1e6,
+                       (ahoraUs - inversionUs) / 1e3);
+                inversionUs = -1;
+            }
+            segmentoUs = -1;
+        }
+        EstadoPuerta antes = (EstadoPuerta)p.estado[0];
+        portonesEntradas(&p, niveles, ahoraUs);
+        rampasRevisar(&r, &p, NULL, ahoraUs);
+        EstadoPuerta estado = (EstadoPuerta)p.estado[0];
+        if (estado != antes && (estado == ABIERTA || estado == CERRADA)) {
+            int16_t marcha = (int16_t)(DUTY_MAX * perfil.aproximacionPct / 100);
+            int16_t tras = rampasDuty(&r, 0, ahoraUs);
+            printf("# %8.3f s  llegada a %s con duty %d, después %d\n", ahoraUs / 1e6, puertaNombreEstado(estado),
+                   duty, tras);
+            if (duty > marcha || -duty > marcha || tras != 0) {
+                printf("FALLO la llegada empuja contra el extremo\n");
+                errores++;
+            }
+        }
+        if (r.nuevas & 1) {
+            if (segmentoUs >= 0) {
+                printf("# %8.3f s  %5d -> %5d interrumpido en %d\n", segmentoUs / 1e6, desde, hasta,
+                       rampasDuty(&r, 0, ahoraUs));
+            }
+            segmentoUs = ahoraUs;
+            desde = r.desde[0];
+            hasta = r.hasta[0];
+            rapida = hasta == 0 && (r.rapidas & 1);
+            if (rapida && inversionUs < 0 && ((p.abriendo | p.cerrando) & 1)) {
+                inversionUs = ahoraUs;
+                sentidoFrenado = desde;
+            }
+        }
+        if (curva && (r.activas & 1)) {
+            printf("%lld,%s,%d\n", (long long)(ahoraUs / 1000), puertaNombreEstado((EstadoPuerta)p.estado[0]),
+                   rampasDuty(&r, 0, ahoraUs));
+        }
+    }
+    return errores != 0;
+}
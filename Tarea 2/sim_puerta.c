@@ -0,0 +1,44 @@
+#include "sim_puerta.h"
+#include <stddef.h>
+
+static void observar(void *usuario, const Portones *p, int puerta, EventoPuerta evento, EstadoPuerta anterior,
+                     AccionPuerta accion) {
+    Simulacion *s = usuario;
+    (void)puerta;
+    if (p->estado[0] == CERRADA && anterior != CERRADA) {
+        s->ciclos++;
+    }
+    if (s->observador != NULL) {
+        s->observador(s->usuario, s, evento, anterior, accion);
+    }
+}
+
+void simIniciar(Simulacion *s, uint32_t tiempoMovimientoMs, uint32_t tiempoEsperaMs) {
+    *s = (Simulacion){0};
+    portonesIniciar(&s->portones, 1, tiempoMovimientoMs, tiempoEsperaMs, 0, 0);
+    s->portones.observador = observar;
+    s->portones.usuario = s;
+}
+
+void simAvanzar(Simulacion *s, int64_t instanteUs) {
+    // Como el temporizador del firmware: el reloj salta a cada vencimiento
+    // para que el observador lo vea en su instante
+    for (;;) {
+        int64_t siguiente = portonesProximo(&s->portones);
+        if (siguiente == 0 || siguiente > instanteUs) {
+            break;
+        }
+        if (siguiente > s->ahoraUs) {
+            s->ahoraUs = siguiente;
+        }
+        portonesAvanzar(&s->portones, s->ahoraUs);
+    }
+    if (instanteUs > s->ahoraUs) {
+        s->ahoraUs = instanteUs;
+    }
+}
+
+void simEntregar(Simulacion *s, int64_t instanteUs, EventoPuerta evento) {
+    simAvanzar(s, instanteUs);
+    portonesEvento(&s->portones, 0, evento, s->ahoraUs);
+}
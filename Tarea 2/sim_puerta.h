@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "portones.h"
+
+// Simulación de eventos discretos de una puerta con reloj virtual: el tiempo
+// salta directamente al siguiente evento (de la traza o de la rueda), sin
+// esperas reales. El controlador es portones.c con una sola puerta, el mismo
+// que corre en el firmware, así que plazos, parpadeo de falla y límite de
+// movimiento con posición se comportan igual que en la placa.
+
+typedef struct Simulacion Simulacion;
+
+// Se llama tras cada evento entregado, haya o no cambio de estado
+typedef void (*SimObservador)(void *usuario, const Simulacion *s, EventoPuerta evento, EstadoPuerta anterior,
+                              AccionPuerta accion);
+
+struct Simulacion {
+    Portones portones;              // una sola puerta, la 0
+    int64_t ahoraUs;
+    uint64_t ciclos;                // llegadas a CERRADA
+    SimObservador observador;
+    void *usuario;
+};
+
+void simIniciar(Simulacion *s, uint32_t tiempoMovimientoMs, uint32_t tiempoEsperaMs);
+// Lleva el reloj hasta instanteUs entregando por orden los plazos y fines de
+// parpadeo que venzan antes o en ese instante
+void simAvanzar(Simulacion *s, int64_t instanteUs);
+// Avanza hasta instanteUs y entrega allí un evento externo
+void simEntregar(Simulacion *s, int64_t instanteUs, EventoPuerta evento);
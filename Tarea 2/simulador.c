@@ -0,0 +1,144 @@
+// Simulador de eventos discretos de la puerta con reloj virtual, en el PC:
+//   gcc -O2 -std=c99 simulador.c sim_puerta.c portones.c puerta_fsm.c -o simulador
+//   ./simulador traza.txt            reproduce una traza y muestra cada cambio
+//   ./simulador -p traza.txt         igual, con medida de posición: vencer el
+//                                    plazo de movimiento sin llegada es falla
+//   ./simulador -a semilla eventos   traza aleatoria, solo estadísticas
+//   ./simulador -c ciclos            ciclos completos de apertura y cierre
+// Formato de la traza: una línea "ms evento" por entrada, con evento entre
+// abrir, cerrar, paro, obstaculo, libre, falla, rearme y llegada; '#' comenta.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim_puerta.h"
+
+#define TIEMPO_MOVIMIENTO_MS 30000
+#define TIEMPO_ESPERA_MS 2000
+
+static const struct {
+    const char *nombre;
+    EventoPuerta evento;
+} nombresEntradas[] = {
+    {"abrir", EVENTO_ABRIR}, {"cerrar", EVENTO_CERRAR}, {"paro", EVENTO_PARO}, {"obstaculo", EVENTO_OBSTACULO},
+    {"libre", EVENTO_LIBRE}, {"falla", EVENTO_FALLA},   {"rearme", EVENTO_REARME},      {"llegada", EVENTO_LLEGADA},
+};
+
+static double segundos() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void mostrarCambio(void *usuario, const Simulacion *s, EventoPuerta evento, EstadoPuerta anterior,
+                          AccionPuerta accion) {
+    (void)usuario;
+    (void)accion;
+    if ((EstadoPuerta)s->portones.estado[0] != anterior) {
+        printf("%10.3f s  %-20s %s -> %s\n", s->ahoraUs / 1e6, puertaNombreEvento(evento), puertaNombreEstado(anterior),
+               puertaNombreEstado((EstadoPuerta)s->portones.estado[0]));
+    }
+}
+
+static int reproducirTraza(const char *ruta, bool conPosicion) {
+    FILE *f = fopen(ruta, "r");
+    if (f == NULL) {
+        perror(ruta);
+        return 1;
+    }
+    Simulacion s;
+    simIniciar(&s, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS);
+    s.observador = mostrarCambio;
+    s.portones.conPosicion = conPosicion;
+
+    char linea[128], nombre[32];
+    long long ms;
+    int numero = 0;
+    while (fgets(linea, sizeof(linea), f) != NULL) {
+        numero++;
+        if (linea[0] == '#' || sscanf(linea, "%lld %31s", &ms, nombre) != 2) {
+            continue;
+        }
+        size_t i = 0;
+        while (i < sizeof(nombresEntradas) / sizeof(nombresEntradas[0]) && strcmp(nombre, nombresEntradas[i].nombre) != 0) {
+            i++;
+        }
+        if (i == sizeof(nombresEntradas) / sizeof(nombresEntradas[0]) || ms * 1000 < s.ahoraUs) {
+            fprintf(stderr, "%s:%d: entrada desconocida o fuera de orden\n", ruta, numero);
+            fclose(f);
+            return 1;
+        }
+        simEntregar(&s, ms * 1000, nombresEntradas[i].evento);
+    }
+    fclose(f);
+    // Deja correr los plazos pendientes hasta que la puerta quede en reposo
+    simAvanzar(&s, s.ahoraUs + 10 * (int64_t)TIEMPO_MOVIMIENTO_MS * 1000);
+    printf("%llu eventos, %llu ciclos, estado final %s\n", (unsigned long long)s.portones.eventos,
+           (unsigned long long)s.ciclos, puertaNombreEstado((EstadoPuerta)s.portones.estado[0]));
+    return 0;
+}
+
+// Entradas al azar separadas de 0 a 20 s, con más aperturas que el resto
+// para que se completen ciclos
+static int trazaAleatoria(uint32_t semilla, unsigned long long total) {
+    static const EventoPuerta reparto[] = {
+        EVENTO_ABRIR, EVENTO_ABRIR, EVENTO_ABRIR, EVENTO_ABRIR, EVENTO_ABRIR, EVENTO_ABRIR, EVENTO_CERRAR,
+        EVENTO_CERRAR, EVENTO_OBSTACULO, EVENTO_LIBRE, EVENTO_LIBRE, EVENTO_PARO, EVENTO_REARME, EVENTO_FALLA,
+        EVENTO_ABRIR, EVENTO_CERRAR,
+    };
+    Simulacion s;
+    simIniciar(&s, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS);
+    int64_t instanteUs = 0;
+
+    double inicio = segundos();
+    for (unsigned long long i = 0; i < total; i++) {
+        semilla = semilla * 1664525u + 1013904223u;
+        instanteUs += (semilla >> 8) % 20000000u;
+        semilla = semilla * 1664525u + 1013904223u;
+        simEntregar(&s, instanteUs, reparto[semilla >> 28]);
+    }
+    double real = segundos() - inicio;
+
+    printf("%llu entradas, %llu eventos, %llu ciclos en %.1f h virtuales\n", total,
+           (unsigned long long)s.portones.eventos, (unsigned long long)s.ciclos, s.ahoraUs / 3.6e9);
+    printf("%.3f s reales: %.2f M eventos/s, %.2f M ciclos/s, %.0fx tiempo real\n", real,
+           s.portones.eventos / real / 1e6, s.ciclos / real / 1e6, s.ahoraUs / 1e6 / real);
+    return 0;
+}
+
+// Una pulsación de abrir por ciclo, cuando la puerta ya volvió a cerrar
+static int ciclosCompletos(unsigned long long total) {
+    const int64_t periodoUs = (2 * (int64_t)TIEMPO_MOVIMIENTO_MS + TIEMPO_ESPERA_MS) * 1000 + 1000;
+    Simulacion s;
+    simIniciar(&s, TIEMPO_MOVIMIENTO_MS, TIEMPO_ESPERA_MS);
+
+    double inicio = segundos();
+    for (unsigned long long i = 0; i < total; i++) {
+        simEntregar(&s, (int64_t)i * periodoUs, EVENTO_ABRIR);
+    }
+    simAvanzar(&s, (int64_t)total * periodoUs);
+    double real = segundos() - inicio;
+
+    printf("%llu ciclos (%llu eventos) en %.3f s reales: %.2f M ciclos/s, %.1f años virtuales\n",
+           (unsigned long long)s.ciclos, (unsigned long long)s.portones.eventos, real, s.ciclos / real / 1e6,
+           s.ahoraUs / 3.156e13);
+    return s.ciclos == total ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "-c") == 0) {
+        return ciclosCompletos(strtoull(argv[2], NULL, 0));
+    }
+    if (argc == 4 && strcmp(argv[1], "-a") == 0) {
+        return trazaAleatoria((uint32_t)strtoul(argv[2], NULL, 0), strtoull(argv[3], NULL, 0));
+    }
+    if (argc == 3 && strcmp(argv[1], "-p") == 0) {
+        return reproducirTraza(argv[2], true);
+    }
+    if (argc == 2) {
+        return reproducirTraza(argv[1], false);
+    }
+    fprintf(stderr, "uso: %s [-p] traza.txt | %s -a semilla eventos | %s -c ciclos\n", argv[0], argv[0], argv[0]);
+    return 2;
+}